@@ -0,0 +1,86 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * The audio kernels the device natives are built from, without JNI around them. The host build takes the
+ * SSE2 paths on x86 and the NEON paths on ARM, so run it on both to compare them.
+ */
+#include "benchmark.h"
+#include "resampler.h"
+#include "sample_convert.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+/* A 10 ms period of 48 kHz stereo */
+constexpr std::size_t period_samples = 960;
+
+std::vector<float> floatPeriod() {
+    std::vector<float> result(period_samples);
+    for (std::size_t i = 0; i < result.size(); ++i)
+        result[i] = static_cast<float>(static_cast<int>(i % 200) - 100) / 100.0f;
+    return result;
+}
+
+}
+
+/* One period per call */
+BENCHMARK(audio_convert, "audio/convert") {
+    const auto floats = floatPeriod();
+    std::vector<short> shorts(period_samples);
+    std::vector<float> converted(period_samples);
+    std::vector<short> channels(period_samples * 2);
+    DitherState dither;
+
+    run.measure("float_to_int16", [&] { float_to_int16(floats.data(), shorts.data(), period_samples, nullptr); });
+    run.measure("float_to_int16_dither", [&] { float_to_int16(floats.data(), shorts.data(), period_samples, &dither); });
+    run.measure("int16_to_float", [&] { int16_to_float(shorts.data(), converted.data(), period_samples); });
+    run.measure("mono_to_stereo", [&] { mono_to_stereo(shorts.data(), channels.data(), period_samples); });
+    run.measure("stereo_to_mono", [&] { stereo_to_mono(channels.data(), shorts.data(), period_samples); });
+}
+
+/*
+ * Nanoseconds per output frame of each quality preset, mono in 10 ms blocks. The rows are averages over
+ * a block, so they are recorded directly instead of through measure.
+ */
+BENCHMARK(audio_resample, "audio/resample") {
+    struct Conversion {
+        const char* row;
+        int in_rate;
+        int out_rate;
+    };
+    static const Conversion conversions[] = {
+        {"44k1_to_48k", 44100, 48000},
+        {"48k_to_16k", 48000, 16000},
+    };
+    static const char* const presets[ResamplerQuality_Count] = {"fast", "medium", "high"};
+
+    const auto floats = floatPeriod();
+    std::vector<short> in(period_samples);
+    float_to_int16(floats.data(), in.data(), period_samples, nullptr);
+    for (const auto& conversion : conversions) {
+        for (int quality = 0; quality < ResamplerQuality_Count; ++quality) {
+            PolyphaseResampler resampler;
+            if (!resampler.configure(conversion.in_rate, conversion.out_rate, 1, quality)) {
+                run.fail(std::string("cannot configure ") + conversion.row);
+                continue;
+            }
+            const auto in_frames = static_cast<std::size_t>(conversion.in_rate / 100);
+            std::vector<short> out(resampler.max_output_frames(in_frames));
+            // The first call grows the internal buffers
+            resampler.process(in.data(), in_frames, out.data(), out.size());
+
+            auto& row = run.row(std::string(presets[quality]) + "_" + conversion.row);
+            for (std::size_t i = 0; i < run.iterations(); ++i) {
+                const auto start = monotonic_ns();
+                const auto frames = resampler.process(in.data(), in_frames, out.data(), out.size());
+                const auto elapsed = monotonic_ns() - start;
+                if (frames > 0)
+                    row.record(elapsed / frames);
+            }
+        }
+    }
+}
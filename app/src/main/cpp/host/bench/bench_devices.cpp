@@ -0,0 +1,273 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Custom device natives and the per-frame path. device/frames times one 10 ms period of capture and
+ * playback through the ByHandle natives for the buffer layouts Java can register, including conversion
+ * and resampling.
+ */
+#include "benchmark.h"
+#include "host_app.h"
+#include "audio_backend.h"
+#include "resampler.h"
+#include "sample_convert.h"
+#include "ts3client_wrapper.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+/* Room for a 10 ms period of 48 kHz stereo float, with margin */
+constexpr std::size_t buffer_bytes = 16384;
+
+/* A custom device registered through the natives, with direct buffers like the ones Java allocates */
+class BenchDevice {
+public:
+    BenchDevice(JNIEnv* env, const char* id, int frequency = 48000, int channels = 1)
+        : m_env(env), m_capture(buffer_bytes), m_playback(buffer_bytes),
+          m_id(javaString(env, id)), m_name(javaString(env, "Bench device")),
+          m_capture_buffer(env, fake_jni::new_direct_buffer(env, "java/nio/ByteBuffer", m_capture.data(), buffer_bytes)),
+          m_playback_buffer(env, fake_jni::new_direct_buffer(env, "java/nio/ByteBuffer", m_playback.data(), buffer_bytes)) {
+        // A 440 Hz tone as int16, the float layouts read the same bytes as noise, which costs the same
+        auto* samples = reinterpret_cast<short*>(m_capture.data());
+        for (std::size_t i = 0; i < buffer_bytes / sizeof(short); ++i)
+            samples[i] = static_cast<short>(8000.0 * std::sin(2.0 * M_PI * 440.0 * static_cast<double>(i) / 48000.0));
+        m_handle = NATIVE(registerCustomDeviceHandle)(env, nullptr, m_id, m_name, frequency, channels, m_capture_buffer,
+                                                      frequency, channels, m_playback_buffer);
+        if (m_handle < 0)
+            std::abort();
+    }
+    ~BenchDevice() { NATIVE(unregisterCustomDevice)(m_env, nullptr, m_id); }
+    BenchDevice(const BenchDevice&) = delete;
+    BenchDevice& operator=(const BenchDevice&) = delete;
+
+    jint handle() const { return m_handle; }
+    jstring id() const { return m_id; }
+    jstring name() const { return m_name; }
+    jobject capture_buffer() const { return m_capture_buffer; }
+    jobject playback_buffer() const { return m_playback_buffer; }
+
+private:
+    JNIEnv* m_env;
+    std::vector<uint8_t> m_capture;
+    std::vector<uint8_t> m_playback;
+    Global<jstring> m_id;
+    Global<jstring> m_name;
+    Global<jobject> m_capture_buffer;
+    Global<jobject> m_playback_buffer;
+    jint m_handle;
+};
+
+}
+
+JNI_BENCHMARK(registerCustomDevice) {
+    auto* env = run.env();
+    BenchDevice buffers(env, "bench-buffers");
+    const auto id = javaString(env, "bench-register");
+    run.measure("", 1, [&] {
+        NATIVE(registerCustomDevice)(env, nullptr, id, buffers.name(), 48000, 1, buffers.capture_buffer(), 48000, 1, buffers.playback_buffer());
+    }, [&] { NATIVE(unregisterCustomDevice)(env, nullptr, id); });
+}
+
+JNI_BENCHMARK(registerCustomDeviceHandle) {
+    auto* env = run.env();
+    BenchDevice buffers(env, "bench-buffers");
+    const auto id = javaString(env, "bench-register");
+    run.measure("", 1, [&] {
+        NATIVE(registerCustomDeviceHandle)(env, nullptr, id, buffers.name(), 48000, 1, buffers.capture_buffer(), 48000, 1, buffers.playback_buffer());
+    }, [&] { NATIVE(unregisterCustomDevice)(env, nullptr, id); });
+}
+
+JNI_BENCHMARK(unregisterCustomDevice) {
+    auto* env = run.env();
+    BenchDevice buffers(env, "bench-buffers");
+    const auto id = javaString(env, "bench-register");
+    auto reregister = [&] {
+        NATIVE(registerCustomDevice)(env, nullptr, id, buffers.name(), 48000, 1, buffers.capture_buffer(), 48000, 1, buffers.playback_buffer());
+    };
+    reregister();
+    run.measure("", 1, [&] { NATIVE(unregisterCustomDevice)(env, nullptr, id); }, reregister);
+    NATIVE(unregisterCustomDevice)(env, nullptr, id);
+}
+
+JNI_BENCHMARK(acquireCustomPlaybackData) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    run.measure([&] { NATIVE(acquireCustomPlaybackData)(env, nullptr, device.id(), 480); });
+}
+
+JNI_BENCHMARK(processCustomCaptureData) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    run.measure([&] { NATIVE(processCustomCaptureData)(env, nullptr, device.id(), 480); });
+}
+
+JNI_BENCHMARK(acquireCustomPlaybackDataByHandle) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    run.measure([&] { NATIVE(acquireCustomPlaybackDataByHandle)(env, nullptr, device.handle(), 480); });
+}
+
+JNI_BENCHMARK(processCustomCaptureDataByHandle) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    run.measure([&] { NATIVE(processCustomCaptureDataByHandle)(env, nullptr, device.handle(), 480); });
+}
+
+JNI_BENCHMARK(openCaptureDevice) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    BenchDevice device(env, "bench-device");
+    const auto mode = javaString(env, "custom");
+    run.measure("", 1, [&] { NATIVE(openCaptureDevice)(env, nullptr, client.connection(), mode, device.id()); },
+                [&] { NATIVE(closeCaptureDevice)(env, nullptr, client.connection()); });
+}
+
+JNI_BENCHMARK(openPlaybackDevice) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    BenchDevice device(env, "bench-device");
+    const auto mode = javaString(env, "custom");
+    run.measure("", 1, [&] { NATIVE(openPlaybackDevice)(env, nullptr, client.connection(), mode, device.id()); },
+                [&] { NATIVE(closePlaybackDevice)(env, nullptr, client.connection()); });
+}
+
+JNI_BENCHMARK(closeCaptureDevice) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    BenchDevice device(env, "bench-device");
+    const auto mode = javaString(env, "custom");
+    run.measure("", 1, [&] { NATIVE(closeCaptureDevice)(env, nullptr, client.connection()); },
+                [&] { NATIVE(openCaptureDevice)(env, nullptr, client.connection(), mode, device.id()); });
+}
+
+JNI_BENCHMARK(closePlaybackDevice) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    BenchDevice device(env, "bench-device");
+    const auto mode = javaString(env, "custom");
+    run.measure("", 1, [&] { NATIVE(closePlaybackDevice)(env, nullptr, client.connection()); },
+                [&] { NATIVE(openPlaybackDevice)(env, nullptr, client.connection(), mode, device.id()); });
+}
+
+JNI_BENCHMARK(activateCaptureDevice) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure([&] { NATIVE(activateCaptureDevice)(env, nullptr, client.connection()); });
+}
+
+/* Starts a pump thread per call */
+JNI_BENCHMARK(startAudioPump) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    run.measure("", 20, [&] { NATIVE(startAudioPump)(env, nullptr, device.handle(), AudioPumpBackend_Null, nullptr, nullptr, 10); },
+                [&] { NATIVE(stopAudioPump)(env, nullptr, device.handle()); });
+}
+
+JNI_BENCHMARK(stopAudioPump) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    auto start = [&] { NATIVE(startAudioPump)(env, nullptr, device.handle(), AudioPumpBackend_Null, nullptr, nullptr, 10); };
+    start();
+    run.measure("", 20, [&] { NATIVE(stopAudioPump)(env, nullptr, device.handle()); }, start);
+    NATIVE(stopAudioPump)(env, nullptr, device.handle());
+}
+
+JNI_BENCHMARK(setCustomDeviceBufferFormat) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    jint encoding = SampleEncoding_Int16;
+    run.measure([&] {
+        encoding = encoding == SampleEncoding_Int16 ? SampleEncoding_Float : SampleEncoding_Int16;
+        NATIVE(setCustomDeviceBufferFormat)(env, nullptr, device.handle(), encoding, 2, encoding, 2);
+    });
+}
+
+JNI_BENCHMARK(setCustomDeviceBufferRate) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    jint frequency = 48000;
+    run.measure([&] {
+        frequency = frequency == 48000 ? 44100 : 48000;
+        NATIVE(setCustomDeviceBufferRate)(env, nullptr, device.handle(), frequency, frequency, ResamplerQuality_Medium);
+    });
+}
+
+/* Java writes a 10 ms period into the capture ring the pump drains */
+JNI_BENCHMARK(writeCustomCaptureDataByHandle) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    NATIVE(startAudioPump)(env, nullptr, device.handle(), AudioPumpBackend_Java, nullptr, nullptr, 10);
+    run.measure([&] { NATIVE(writeCustomCaptureDataByHandle)(env, nullptr, device.handle(), 480); });
+    NATIVE(stopAudioPump)(env, nullptr, device.handle());
+}
+
+JNI_BENCHMARK(readCustomPlaybackDataByHandle) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    NATIVE(startAudioPump)(env, nullptr, device.handle(), AudioPumpBackend_Java, nullptr, nullptr, 10);
+    run.measure([&] { NATIVE(readCustomPlaybackDataByHandle)(env, nullptr, device.handle(), 480); });
+    NATIVE(stopAudioPump)(env, nullptr, device.handle());
+}
+
+JNI_BENCHMARK(getPlaybackBufferCounters) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    run.measure([&] { NATIVE(getPlaybackBufferCounters)(env, nullptr, device.handle()); });
+}
+
+JNI_BENCHMARK(getCaptureRingCounters) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    run.measure([&] { NATIVE(getCaptureRingCounters)(env, nullptr, device.handle()); });
+}
+
+JNI_BENCHMARK(getAudioLatencySnapshot) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    run.measure([&] { NATIVE(getAudioLatencySnapshot)(env, nullptr, device.handle(), JNI_FALSE); });
+}
+
+JNI_BENCHMARK(getAudioPumpCounters) {
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    run.measure([&] { NATIVE(getAudioPumpCounters)(env, nullptr, device.handle()); });
+}
+
+/* One 10 ms period per call, in the clientlib format (48 kHz mono int16) after conversion */
+BENCHMARK(device_frames, "device/frames") {
+    struct Layout {
+        const char* row;
+        jint encoding;
+        jint channels;
+        jint frequency;
+    };
+    static const Layout layouts[] = {
+        {"int16_mono_48k", SampleEncoding_Int16, 1, 48000},
+        {"float_mono_48k", SampleEncoding_Float, 1, 48000},
+        {"float_stereo_48k", SampleEncoding_Float, 2, 48000},
+        {"int16_mono_44k1", SampleEncoding_Int16, 1, 44100},
+        {"float_stereo_44k1", SampleEncoding_Float, 2, 44100},
+    };
+    auto* env = run.env();
+    BenchDevice device(env, "bench-device");
+    for (const auto& layout : layouts) {
+        if (NATIVE(setCustomDeviceBufferFormat)(env, nullptr, device.handle(), layout.encoding, layout.channels, layout.encoding, layout.channels) != 0 ||
+            NATIVE(setCustomDeviceBufferRate)(env, nullptr, device.handle(), layout.frequency, layout.frequency, ResamplerQuality_Medium) != 0) {
+            run.fail(std::string("cannot configure ") + layout.row);
+            continue;
+        }
+        const jint frames = layout.frequency / 100;
+        run.measure(std::string("capture_") + layout.row, [&] {
+            if (NATIVE(processCustomCaptureDataByHandle)(env, nullptr, device.handle(), frames) != 0)
+                run.fail(std::string("capture failed for ") + layout.row);
+        });
+        run.measure(std::string("playback_") + layout.row, [&] {
+            if (NATIVE(acquireCustomPlaybackDataByHandle)(env, nullptr, device.handle(), frames) != 0)
+                run.fail(std::string("playback failed for ") + layout.row);
+        });
+    }
+}
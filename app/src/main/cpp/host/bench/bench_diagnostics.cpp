@@ -0,0 +1,94 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Native log and profiler natives. The log lines come from the clientlib log callback like on a device.
+ */
+#include "benchmark.h"
+#include "host_app.h"
+#include "profiler.h"
+#include "stub_clientlib.h"
+#include "ts3client_wrapper.h"
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+std::string logFilePath() {
+    return "/tmp/wrapper_bench_" + std::to_string(getpid()) + ".log";
+}
+
+void logLines(int count) {
+    const auto callbacks = stub_clientlib::callbacks();
+    for (int i = 0; i < count; ++i)
+        callbacks.onUserLoggingMessageEvent("Bench line", LogLevel_INFO, "Bench", 0, "2020-01-01 00:00:00.000000", "Bench line");
+}
+
+}
+
+JNI_BENCHMARK(setLogLevel) {
+    auto* env = run.env();
+    jint level = LogLevel_INFO;
+    run.measure([&] {
+        level = level == LogLevel_INFO ? LogLevel_DEBUG : LogLevel_INFO;
+        NATIVE(setLogLevel)(env, nullptr, level);
+    });
+    NATIVE(setLogLevel)(env, nullptr, LogLevel_INFO);
+}
+
+/* 16 records per drain */
+JNI_BENCHMARK(drainLog) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    logLines(16);
+    run.measure("", 1, [&] { NATIVE(drainLog)(env, nullptr, 16); }, [] { logLines(16); });
+    NATIVE(drainLog)(env, nullptr, 1 << 16);
+}
+
+JNI_BENCHMARK(openLogFile) {
+    auto* env = run.env();
+    const auto path = javaString(env, logFilePath().c_str());
+    run.measure("", 10, [&] { NATIVE(openLogFile)(env, nullptr, path, 1024); },
+                [&] { NATIVE(closeLogFile)(env, nullptr); });
+    std::remove(logFilePath().c_str());
+}
+
+JNI_BENCHMARK(closeLogFile) {
+    auto* env = run.env();
+    const auto path = javaString(env, logFilePath().c_str());
+    auto open = [&] { NATIVE(openLogFile)(env, nullptr, path, 1024); };
+    open();
+    run.measure("", 10, [&] { NATIVE(closeLogFile)(env, nullptr); }, open);
+    NATIVE(closeLogFile)(env, nullptr);
+    std::remove(logFilePath().c_str());
+}
+
+/* A file of 1024 records, a quarter of them written */
+JNI_BENCHMARK(readLogFile) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto path = javaString(env, logFilePath().c_str());
+    NATIVE(openLogFile)(env, nullptr, path, 1024);
+    logLines(256);
+    run.measure("", 10, [&] {
+        if (!NATIVE(readLogFile)(env, nullptr, path))
+            run.fail("cannot read the log file");
+    }, [] {});
+    NATIVE(closeLogFile)(env, nullptr);
+    NATIVE(drainLog)(env, nullptr, 1 << 16);
+    std::remove(logFilePath().c_str());
+}
+
+JNI_BENCHMARK(getProfileReport) {
+    auto* env = run.env();
+    run.measure("table", [&] { NATIVE(getProfileReport)(env, nullptr, ProfileFormat_Table); });
+    run.measure("csv", [&] { NATIVE(getProfileReport)(env, nullptr, ProfileFormat_Csv); });
+}
+
+JNI_BENCHMARK(resetProfile) {
+    auto* env = run.env();
+    run.measure([&] { NATIVE(resetProfile)(env, nullptr); });
+}
@@ -0,0 +1,271 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Event queue configuration and counter natives, and the event path itself: events/callback times the
+ * clientlib callbacks on the calling thread, events/delivery a callback up to the Post of its event object
+ * on the dispatcher thread. events/post compares posting an event object with the cached JniEvent to the
+ * lookup of class and constructor on every event the handlers did before.
+ */
+#include "benchmark.h"
+#include "host_app.h"
+#include "event_dispatch.h"
+#include "event_queue.h"
+#include "jni_event.h"
+#include "stub_clientlib.h"
+#include "ts3client_wrapper.h"
+#include "teamspeak/public_errors.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+namespace {
+
+/* Waits for the dispatcher to post count events of type, false after a second */
+bool waitPosted(EventType type, uint64_t count) {
+    const auto deadline = monotonic_ns() + 1000000000;
+    while (host_app::posted(type) < count) {
+        if (monotonic_ns() > deadline)
+            return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+}
+
+JNI_BENCHMARK(getThreadAttachCounters) {
+    auto* env = run.env();
+    run.measure([&] { NATIVE(getThreadAttachCounters)(env, nullptr); });
+}
+
+JNI_BENCHMARK(getStartupTimes) {
+    auto* env = run.env();
+    run.measure([&] { NATIVE(getStartupTimes)(env, nullptr); });
+}
+
+JNI_BENCHMARK(configureEventQueue) {
+    auto* env = run.env();
+    run.measure([&] { NATIVE(configureEventQueue)(env, nullptr, 1024, EventQueueOverflow_DropOldest); });
+    NATIVE(configureEventQueue)(env, nullptr, static_cast<jint>(EventQueue::default_capacity), EventQueueOverflow_Block);
+}
+
+JNI_BENCHMARK(setEventDispatchThreads) {
+    auto* env = run.env();
+    run.measure([&] { NATIVE(setEventDispatchThreads)(env, nullptr, 4); });
+    NATIVE(setEventDispatchThreads)(env, nullptr, 1);
+}
+
+/* Enabling types resolves their event classes, so alternate between two masks */
+JNI_BENCHMARK(setEventMask) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    jint mask = 0;
+    run.measure([&] {
+        mask = mask == 0 ? (1 << EventType_TalkStatusChange) : 0;
+        NATIVE(setEventMask)(env, nullptr, client.connection(), mask);
+    });
+    NATIVE(setEventMask)(env, nullptr, client.connection(), -1);
+}
+
+JNI_BENCHMARK(setEventBatchDelivery) {
+    auto* env = run.env();
+    Global<jobject> batch(env, host_app::new_event_batch(env, 4096));
+    run.measure("", 1, [&] { NATIVE(setEventBatchDelivery)(env, nullptr, batch); },
+                [&] { NATIVE(setEventBatchDelivery)(env, nullptr, nullptr); });
+}
+
+JNI_BENCHMARK(setEventCoalescingWindow) {
+    auto* env = run.env();
+    run.measure([&] { NATIVE(setEventCoalescingWindow)(env, nullptr, EventType_TalkStatusChange, 20); });
+    NATIVE(setEventCoalescingWindow)(env, nullptr, EventType_TalkStatusChange, 0);
+}
+
+JNI_BENCHMARK(getEventQueueCounters) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure([&] { NATIVE(getEventQueueCounters)(env, nullptr); });
+}
+
+JNI_BENCHMARK(getEventShardCounters) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure([&] { NATIVE(getEventShardCounters)(env, nullptr, 0); });
+}
+
+JNI_BENCHMARK(setEventStringCacheCapacity) {
+    auto* env = run.env();
+    jint bytes = 65536;
+    run.measure([&] {
+        bytes = bytes == 65536 ? 32768 : 65536;
+        NATIVE(setEventStringCacheCapacity)(env, nullptr, bytes);
+    });
+}
+
+JNI_BENCHMARK(getEventStringCacheCounters) {
+    auto* env = run.env();
+    run.measure([&] { NATIVE(getEventStringCacheCounters)(env, nullptr); });
+}
+
+#ifdef LOAD_GENERATOR
+/* Starts a generator thread per call */
+JNI_BENCHMARK(startLoadGenerator) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto types = javaInts(env, {EventType_TalkStatusChange});
+    const auto rates = javaInts(env, {100});
+    run.measure("", 20, [&] { NATIVE(startLoadGenerator)(env, nullptr, client.connection(), types, rates, 1, 1, 1000); },
+                [&] { NATIVE(stopLoadGenerator)(env, nullptr); });
+}
+
+JNI_BENCHMARK(stopLoadGenerator) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto types = javaInts(env, {EventType_TalkStatusChange});
+    const auto rates = javaInts(env, {100});
+    auto start = [&] { NATIVE(startLoadGenerator)(env, nullptr, client.connection(), types, rates, 1, 1, 1000); };
+    start();
+    run.measure("", 20, [&] { NATIVE(stopLoadGenerator)(env, nullptr); }, start);
+    NATIVE(stopLoadGenerator)(env, nullptr);
+}
+
+JNI_BENCHMARK(getLoadGeneratorCounters) {
+    auto* env = run.env();
+    run.measure([&] { NATIVE(getLoadGeneratorCounters)(env, nullptr, EventType_TalkStatusChange); });
+}
+#endif
+
+JNI_BENCHMARK(getEventLatencySnapshot) {
+    auto* env = run.env();
+    run.measure([&] { NATIVE(getEventLatencySnapshot)(env, nullptr, EventType_TalkStatusChange, JNI_FALSE); });
+}
+
+/* The clientlib thread side: masking, packing the record and queueing it */
+BENCHMARK(events_callback, "events/callback") {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto callbacks = stub_clientlib::callbacks();
+    const auto connection = static_cast<uint64>(client.connection());
+    const auto talk_status = host_app::posted(EventType_TalkStatusChange);
+    const auto moves = host_app::posted(EventType_ClientMove);
+    const auto errors = host_app::posted(EventType_ServerError);
+    int status = 0;
+    run.measure("talk_status", [&] {
+        status ^= 1;
+        callbacks.onTalkStatusChangeEvent(connection, status, 0, 2);
+    });
+    // Moves between two channels keep the server tree the same size
+    uint64 channel = 2;
+    run.measure("client_move", [&] {
+        const auto from = channel;
+        channel = channel == 1 ? 2 : 1;
+        callbacks.onClientMoveEvent(connection, 2, from, channel, RETAIN_VISIBILITY, "");
+    });
+    run.measure("server_error", [&] {
+        callbacks.onServerErrorEvent(connection, "ok", ERROR_ok, "bench", "");
+    });
+    if (!waitPosted(EventType_TalkStatusChange, talk_status + run.iterations()) ||
+        !waitPosted(EventType_ClientMove, moves + run.iterations()) ||
+        !waitPosted(EventType_ServerError, errors + run.iterations()))
+        run.fail("events were not delivered");
+}
+
+/* From the callback on the clientlib thread to the Post on the dispatcher thread, one event at a time */
+BENCHMARK(events_delivery, "events/delivery") {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto callbacks = stub_clientlib::callbacks();
+    const auto connection = static_cast<uint64>(client.connection());
+    auto posted = host_app::posted(EventType_TalkStatusChange);
+    int status = 0;
+    run.measure("talk_status", [&] {
+        status ^= 1;
+        callbacks.onTalkStatusChangeEvent(connection, status, 0, 2);
+        if (!waitPosted(EventType_TalkStatusChange, ++posted))
+            run.fail("event was not delivered");
+    });
+}
+
+/*
+ * A burst of one talk status event per connection, from the callbacks to the Post of the last one, for 1 to
+ * 16 connections on one dispatcher thread and on a thread per connection up to max_shards. The callbacks
+ * run on one thread here, the clientlib raises them from a thread per connection.
+ */
+BENCHMARK(events_shards, "events/shards") {
+    auto* env = run.env();
+    const jint max_threads = static_cast<jint>(EventDispatch::max_shards);
+    for (const jint threads : {jint{1}, max_threads}) {
+        for (const int connections : {1, 2, 4, 8, 16}) {
+            // One connection only ever uses one thread
+            if (threads > 1 && connections == 1)
+                continue;
+            NATIVE(setEventDispatchThreads)(env, nullptr, std::min<jint>(threads, connections));
+            host_app::Client client(env, connections);
+            const auto callbacks = stub_clientlib::callbacks();
+            auto posted = host_app::posted(EventType_TalkStatusChange);
+            int status = 0;
+            const auto row = "threads_" + std::to_string(std::min<jint>(threads, connections)) + "_connections_" + std::to_string(connections);
+            run.measure(row, static_cast<std::size_t>(connections), [&] {
+                status ^= 1;
+                for (int i = 0; i < connections; ++i)
+                    callbacks.onTalkStatusChangeEvent(static_cast<uint64>(client.connection(i)), status, 0, 2);
+                posted += static_cast<uint64_t>(connections);
+                if (!waitPosted(EventType_TalkStatusChange, posted))
+                    run.fail("events were not delivered");
+            }, [] {});
+        }
+    }
+    NATIVE(setEventDispatchThreads)(env, nullptr, 1);
+}
+
+/*
+ * On the dispatcher thread, after the record is unpacked. lookup_* is the handler of the original wrapper:
+ * GetObjectClass of a cached event object, GetMethodID of the constructor and NewStringUTF for every string,
+ * without its attach and detach. cached_* is JniEvent::post. The fake VM looks methods up in a map, so the
+ * host numbers understate what GetMethodID costs on ART; run the same rows with PROFILE_BUILD on a device.
+ */
+BENCHMARK(events_post, "events/post") {
+    using TalkStatusEvent = JniEvent<decltype(ClientUIFunctions::onTalkStatusChangeEvent)>;
+    using ServerErrorEvent = JniEvent<decltype(ClientUIFunctions::onServerErrorEvent)>;
+    static TalkStatusEvent talk_status(EventType_TalkStatusChange, "com/teamspeak/ts3sdkclient/ts3sdk/events/TalkStatusChange");
+    static ServerErrorEvent server_error(EventType_ServerError, "com/teamspeak/ts3sdkclient/ts3sdk/events/ServerError");
+
+    auto* env = run.env();
+    // Destroying the client lib releases the strings interned by the cached rows
+    host_app::Client client(env, 0);
+    Global<jclass> talk_status_class(env, find_app_class(env, talk_status.path()));
+    Global<jclass> server_error_class(env, find_app_class(env, server_error.path()));
+    if (!talk_status_class || !server_error_class) {
+        run.fail("event classes not found");
+        return;
+    }
+    // The original wrapper kept an event object per type to get its class from
+    Global<jobject> talk_status_object(env, env->NewObject(talk_status_class, env->GetMethodID(talk_status_class, "<init>", "(JIII)V"),
+                                                           jlong{1}, 0, 0, 2));
+    Global<jobject> server_error_object(env, env->NewObject(server_error_class,
+            env->GetMethodID(server_error_class, "<init>", "(JLjava/lang/String;ILjava/lang/String;Ljava/lang/String;)V"),
+            jlong{1}, nullptr, 0, nullptr, nullptr));
+    const jmethodID talk_status_post = env->GetMethodID(talk_status_class, "Post", "()V");
+    const jmethodID server_error_post = env->GetMethodID(server_error_class, "Post", "()V");
+
+    run.measure("lookup_talk_status", [&] {
+        jclass cls = env->GetObjectClass(talk_status_object);
+        jmethodID constructor = env->GetMethodID(cls, "<init>", "(JIII)V");
+        jobject event = env->NewObject(cls, constructor, jlong{1}, 1, 0, 2);
+        env->CallVoidMethod(event, talk_status_post);
+    });
+    run.measure("cached_talk_status", [&] { talk_status.post(env, 1, 1, 0, 2); });
+
+    run.measure("lookup_server_error", [&] {
+        jclass cls = env->GetObjectClass(server_error_object);
+        jmethodID constructor = env->GetMethodID(cls, "<init>", "(JLjava/lang/String;ILjava/lang/String;Ljava/lang/String;)V");
+        jobject message = env->NewLocalRef(env->NewStringUTF("insufficient client permissions"));
+        jobject return_code = env->NewLocalRef(env->NewStringUTF("bench"));
+        jobject extra = env->NewLocalRef(env->NewStringUTF(""));
+        jobject event = env->NewObject(cls, constructor, jlong{1}, message, 2568u, return_code, extra);
+        env->CallVoidMethod(event, server_error_post);
+    });
+    run.measure("cached_server_error", [&] { server_error.post(env, 1, "insufficient client permissions", 2568u, "bench", ""); });
+}
@@ -0,0 +1,96 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Client lib, connection handler and connection lifecycle natives.
+ */
+#include "benchmark.h"
+#include "host_app.h"
+#include "ts3client_wrapper.h"
+
+namespace {
+
+struct ConnectArguments {
+    explicit ConnectArguments(JNIEnv* env)
+        : identity(javaString(env, "stub-identity")), ip(javaString(env, "127.0.0.1")),
+          nickname(javaString(env, "bench")), password(javaString(env, "")) {}
+
+    jint connect(JNIEnv* env, jlong connection) const {
+        return NATIVE(startConnection)(env, nullptr, connection, identity, ip, 9987, nickname, nullptr, password, password);
+    }
+
+    Global<jstring> identity;
+    Global<jstring> ip;
+    Global<jstring> nickname;
+    Global<jstring> password;
+};
+
+}
+
+JNI_BENCHMARK(startInit) {
+    auto* env = run.env();
+    Global<jobject> context(env, host_app::new_context(env, "/data/app/host/lib"));
+    run.measure("", 10, [&] { NATIVE(startInit)(env, nullptr, context); },
+                [&] { NATIVE(destroyClientLib)(env, nullptr); });
+}
+
+JNI_BENCHMARK(destroyClientLib) {
+    auto* env = run.env();
+    Global<jobject> context(env, host_app::new_context(env, "/data/app/host/lib"));
+    NATIVE(startInit)(env, nullptr, context);
+    run.measure("", 10, [&] { NATIVE(destroyClientLib)(env, nullptr); },
+                [&] { NATIVE(startInit)(env, nullptr, context); });
+    NATIVE(destroyClientLib)(env, nullptr);
+}
+
+JNI_BENCHMARK(spawnNewServerConnectionHandler) {
+    auto* env = run.env();
+    host_app::Client client(env, 0);
+    jlong connection = 0;
+    run.measure("", 1, [&] { connection = NATIVE(spawnNewServerConnectionHandler)(env, nullptr); },
+                [&] { NATIVE(destroyServerConnectionHandler)(env, nullptr, connection); });
+}
+
+JNI_BENCHMARK(destroyServerConnectionHandler) {
+    auto* env = run.env();
+    host_app::Client client(env, 0);
+    jlong connection = NATIVE(spawnNewServerConnectionHandler)(env, nullptr);
+    run.measure("", 1, [&] { NATIVE(destroyServerConnectionHandler)(env, nullptr, connection); },
+                [&] { connection = NATIVE(spawnNewServerConnectionHandler)(env, nullptr); });
+    NATIVE(destroyServerConnectionHandler)(env, nullptr, connection);
+}
+
+/* Includes raising the connect events of the stub server into the event queue */
+JNI_BENCHMARK(startConnection) {
+    auto* env = run.env();
+    host_app::Client client(env, 0);
+    const ConnectArguments arguments(env);
+    const auto connection = NATIVE(spawnNewServerConnectionHandler)(env, nullptr);
+    run.measure("", 10, [&] { arguments.connect(env, connection); },
+                [&] { NATIVE(stopConnection)(env, nullptr, connection, nullptr); });
+    NATIVE(destroyServerConnectionHandler)(env, nullptr, connection);
+}
+
+JNI_BENCHMARK(stopConnection) {
+    auto* env = run.env();
+    host_app::Client client(env, 0);
+    const ConnectArguments arguments(env);
+    const auto message = javaString(env, "leaving");
+    const auto connection = NATIVE(spawnNewServerConnectionHandler)(env, nullptr);
+    arguments.connect(env, connection);
+    run.measure("", 10, [&] { NATIVE(stopConnection)(env, nullptr, connection, message); },
+                [&] { arguments.connect(env, connection); });
+    NATIVE(stopConnection)(env, nullptr, connection, message);
+    NATIVE(destroyServerConnectionHandler)(env, nullptr, connection);
+}
+
+JNI_BENCHMARK(createIdentity) {
+    auto* env = run.env();
+    run.measure([&] { NATIVE(createIdentity)(env, nullptr); });
+}
+
+JNI_BENCHMARK(getClientLibVersion) {
+    auto* env = run.env();
+    run.measure([&] { NATIVE(getClientLibVersion)(env, nullptr); });
+}
@@ -0,0 +1,196 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Client, channel and connection queries and the connection sampler, against an established connection to
+ * the stub server.
+ */
+#include "benchmark.h"
+#include "host_app.h"
+#include "stub_clientlib.h"
+#include "ts3client_wrapper.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/* The stub server clients 1..server_clients */
+std::vector<jint> serverClients() {
+    std::vector<jint> clients;
+    for (jint client = 1; client <= stub_clientlib::server_clients; ++client)
+        clients.push_back(client);
+    return clients;
+}
+
+}
+
+JNI_BENCHMARK(setClientSelfVariableAsInt) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    jint talking = 0;
+    run.measure([&] {
+        talking ^= 1;
+        NATIVE(setClientSelfVariableAsInt)(env, nullptr, client.connection(), CLIENT_INPUT_DEACTIVATED, talking);
+    });
+}
+
+JNI_BENCHMARK(flushClientSelfUpdates) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto returnCode = javaString(env, "bench");
+    run.measure("", 1, [&] { NATIVE(flushClientSelfUpdates)(env, nullptr, client.connection(), returnCode); },
+                [&] { NATIVE(setClientSelfVariableAsInt)(env, nullptr, client.connection(), CLIENT_INPUT_DEACTIVATED, 0); });
+}
+
+JNI_BENCHMARK(setPreProcessorConfigValue) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto ident = javaString(env, "voiceactivation_level");
+    const auto value = javaString(env, "-40");
+    run.measure([&] { NATIVE(setPreProcessorConfigValue)(env, nullptr, client.connection(), ident, value); });
+}
+
+JNI_BENCHMARK(getPreProcessorConfigValue) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto ident = javaString(env, "voiceactivation_level");
+    run.measure([&] { NATIVE(getPreProcessorConfigValue)(env, nullptr, client.connection(), ident); });
+}
+
+JNI_BENCHMARK(getPlaybackConfigValueAsFloat) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto ident = javaString(env, "volume_modifier");
+    run.measure([&] { NATIVE(getPlaybackConfigValueAsFloat)(env, nullptr, client.connection(), ident); });
+}
+
+JNI_BENCHMARK(setPlaybackConfigValue) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto ident = javaString(env, "volume_modifier");
+    const auto value = javaString(env, "-3");
+    run.measure([&] { NATIVE(setPlaybackConfigValue)(env, nullptr, client.connection(), ident, value); });
+}
+
+JNI_BENCHMARK(getClientVariableAsString) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure([&] { NATIVE(getClientVariableAsString)(env, nullptr, client.connection(), 2, CLIENT_NICKNAME); });
+}
+
+JNI_BENCHMARK(getClientList) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure([&] { NATIVE(getClientList)(env, nullptr, client.connection()); });
+}
+
+/* One batch call for every client of the server, as a client list refresh does */
+JNI_BENCHMARK(getClientVariablesAsInt) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto clients = javaInts(env, serverClients());
+    const auto flags = javaInts(env, {CLIENT_FLAG_TALKING, CLIENT_INPUT_MUTED, CLIENT_OUTPUT_MUTED});
+    run.measure([&] { NATIVE(getClientVariablesAsInt)(env, nullptr, client.connection(), clients, flags); });
+}
+
+JNI_BENCHMARK(getClientVariablesAsString) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto clients = javaInts(env, serverClients());
+    const auto flags = javaInts(env, {CLIENT_NICKNAME, CLIENT_UNIQUE_IDENTIFIER});
+    run.measure([&] { NATIVE(getClientVariablesAsString)(env, nullptr, client.connection(), clients, flags); });
+}
+
+JNI_BENCHMARK(getServerTree) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure([&] { NATIVE(getServerTree)(env, nullptr, client.connection(), 0); });
+}
+
+JNI_BENCHMARK(getChannelVariableAsString) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure([&] { NATIVE(getChannelVariableAsString)(env, nullptr, client.connection(), 1, CHANNEL_NAME); });
+}
+
+JNI_BENCHMARK(getClientID) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure([&] { NATIVE(getClientID)(env, nullptr, client.connection()); });
+}
+
+JNI_BENCHMARK(getConnectionStatus) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure([&] { NATIVE(getConnectionStatus)(env, nullptr, client.connection()); });
+}
+
+JNI_BENCHMARK(getConnectionVariableAsDouble) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure([&] {
+        NATIVE(getConnectionVariableAsDouble)(env, nullptr, client.connection(), stub_clientlib::own_client, CONNECTION_PACKETLOSS_TOTAL);
+    });
+}
+
+JNI_BENCHMARK(getConnectionVariables) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    std::vector<double> values(CONNECTION_ENDMARKER);
+    Global<jobject> buffer(env, fake_jni::new_direct_buffer(env, "java/nio/DoubleBuffer", values.data(),
+                                                            static_cast<jlong>(values.size())));
+    run.measure([&] { NATIVE(getConnectionVariables)(env, nullptr, client.connection(), stub_clientlib::own_client, buffer); });
+}
+
+/* Starts the sampler thread per call */
+JNI_BENCHMARK(startConnectionSampler) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure("", 20, [&] { NATIVE(startConnectionSampler)(env, nullptr, 100, 64); },
+                [&] { NATIVE(stopConnectionSampler)(env, nullptr); });
+}
+
+JNI_BENCHMARK(stopConnectionSampler) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    auto start = [&] { NATIVE(startConnectionSampler)(env, nullptr, 100, 64); };
+    start();
+    run.measure("", 20, [&] { NATIVE(stopConnectionSampler)(env, nullptr); }, start);
+    NATIVE(stopConnectionSampler)(env, nullptr);
+}
+
+JNI_BENCHMARK(watchConnection) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    run.measure("", 1, [&] { NATIVE(watchConnection)(env, nullptr, client.connection(), stub_clientlib::own_client); },
+                [&] { NATIVE(watchConnection)(env, nullptr, client.connection(), -1); });
+}
+
+/* The history of a watched connection after a few sampler periods */
+JNI_BENCHMARK(getConnectionHistory) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    NATIVE(watchConnection)(env, nullptr, client.connection(), stub_clientlib::own_client);
+    NATIVE(startConnectionSampler)(env, nullptr, 10, 64);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    run.measure([&] { NATIVE(getConnectionHistory)(env, nullptr, client.connection(), 0.0); });
+    NATIVE(stopConnectionSampler)(env, nullptr);
+    NATIVE(watchConnection)(env, nullptr, client.connection(), -1);
+}
+
+JNI_BENCHMARK(getConnectionPercentiles) {
+    auto* env = run.env();
+    host_app::Client client(env);
+    const auto permilles = javaInts(env, {500, 900, 990});
+    NATIVE(watchConnection)(env, nullptr, client.connection(), stub_clientlib::own_client);
+    NATIVE(startConnectionSampler)(env, nullptr, 10, 64);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    run.measure([&] {
+        NATIVE(getConnectionPercentiles)(env, nullptr, client.connection(), CONNECTION_PACKETLOSS_TOTAL, permilles);
+    });
+    NATIVE(stopConnectionSampler)(env, nullptr);
+    NATIVE(watchConnection)(env, nullptr, client.connection(), -1);
+}
@@ -0,0 +1,148 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Host benchmark runner. A benchmark times single calls into LatencyHistograms, one per row, and the runner
+ * prints the rows in the columns of the profiler csv report (ts3client_getProfileReport), so both can be
+ * compared with the same tools. JNI_BENCHMARK(name) benchmarks the native ts3client_<name>; the runner
+ * fails if a native registered by JNI_OnLoad has none.
+ */
+#pragma once
+
+#include <jni.h>
+#include "audio_latency.h"
+#include "fake_jni.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class BenchmarkRun {
+public:
+    BenchmarkRun(JNIEnv* env, std::string name, bool quick) : m_env(env), m_name(std::move(name)), m_quick(quick) {}
+
+    JNIEnv* env() const { return m_env; }
+    bool quick() const { return m_quick; }
+    /* Timed calls per row, scaled down by cost for expensive calls */
+    std::size_t iterations(std::size_t cost = 1) const {
+        const std::size_t base = m_quick ? 200 : 20000;
+        return std::max<std::size_t>(base / cost, 10);
+    }
+
+    /*
+     * Times iterations(cost) calls of call into the row name/row, or name for an empty row. reset runs
+     * untimed after every call, then the local references of the call are released as on the return to
+     * Java. A Java exception left pending fails the run.
+     */
+    template <typename Call, typename Reset>
+    void measure(const std::string& row, std::size_t cost, Call&& call, Reset&& reset) {
+        auto& histogram = this->row(row);
+        const auto count = iterations(cost);
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto start = monotonic_ns();
+            call();
+            histogram.record(monotonic_ns() - start);
+            reset();
+            returned_to_java();
+        }
+    }
+
+    template <typename Call>
+    void measure(const std::string& row, Call&& call) {
+        measure(row, 1, std::forward<Call>(call), [] {});
+    }
+
+    template <typename Call>
+    void measure(Call&& call) {
+        measure(std::string(), 1, std::forward<Call>(call), [] {});
+    }
+
+    /* For timings taken by the benchmark itself, e.g. on another thread */
+    LatencyHistogram& row(const std::string& row);
+
+    /* Checks for a pending exception and releases the local references */
+    void returned_to_java();
+    /* Marks the run failed, the runner exits non zero */
+    void fail(const std::string& message);
+    bool failed() const { return m_failed; }
+
+    /* Rows in csv format, without header */
+    std::string csv() const;
+
+private:
+    JNIEnv* m_env;
+    std::string m_name;
+    bool m_quick;
+    bool m_failed = false;
+    std::vector<std::pair<std::string, std::unique_ptr<LatencyHistogram>>> m_rows;
+};
+
+/* A global reference for the whole benchmark, the local references are released after every measured call */
+template <typename T>
+class Global {
+public:
+    Global(JNIEnv* env, T local) : m_env(env), m_ref(local ? static_cast<T>(env->NewGlobalRef(local)) : nullptr) {
+        env->DeleteLocalRef(local);
+    }
+    ~Global() {
+        if (m_ref)
+            m_env->DeleteGlobalRef(m_ref);
+    }
+    Global(const Global&) = delete;
+    Global& operator=(const Global&) = delete;
+
+    operator T() const { return m_ref; }
+
+private:
+    JNIEnv* m_env;
+    T m_ref;
+};
+
+inline Global<jstring> javaString(JNIEnv* env, const char* utf8) {
+    return Global<jstring>(env, fake_jni::new_string(env, utf8));
+}
+
+inline Global<jintArray> javaInts(JNIEnv* env, const std::vector<jint>& values) {
+    const auto count = static_cast<jsize>(values.size());
+    jintArray array = env->NewIntArray(count);
+    env->SetIntArrayRegion(array, 0, count, values.data());
+    return Global<jintArray>(env, array);
+}
+
+class Benchmark {
+public:
+    using Body = void (*)(BenchmarkRun& run);
+
+    /* Registers the benchmark, native is the registered function of a JNI_BENCHMARK */
+    Benchmark(const char* name, Body body, const void* native = nullptr);
+
+    const char* name() const { return m_name; }
+    Body body() const { return m_body; }
+    const void* native() const { return m_native; }
+
+    static const std::vector<const Benchmark*>& all();
+
+private:
+    const char* m_name;
+    Body m_body;
+    const void* m_native;
+};
+
+/* The Java_ function of the native ts3client_<name> */
+#define NATIVE(name) Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1##name
+
+#define BENCHMARK(function, name) \
+    static void function(BenchmarkRun& run); \
+    static const Benchmark function##_registration(name, function); \
+    static void function(BenchmarkRun& run)
+
+#define JNI_BENCHMARK(name) \
+    static void jni_benchmark_##name(BenchmarkRun& run); \
+    static const Benchmark jni_benchmark_##name##_registration("jni/ts3client_" #name, jni_benchmark_##name, \
+            reinterpret_cast<const void*>(NATIVE(name))); \
+    static void jni_benchmark_##name(BenchmarkRun& run)
@@ -0,0 +1,164 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Usage: wrapper_bench [--quick] [--filter=<substring>] [--output=<file>] [--list]
+ */
+#include "benchmark.h"
+#include "host_app.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static std::vector<const Benchmark*>& registry() {
+    static std::vector<const Benchmark*> benchmarks;
+    return benchmarks;
+}
+
+Benchmark::Benchmark(const char* name, Body body, const void* native) : m_name(name), m_body(body), m_native(native) {
+    registry().push_back(this);
+}
+
+const std::vector<const Benchmark*>& Benchmark::all() {
+    return registry();
+}
+
+LatencyHistogram& BenchmarkRun::row(const std::string& row) {
+    const auto name = row.empty() ? m_name : m_name + "/" + row;
+    for (auto& entry : m_rows) {
+        if (entry.first == name)
+            return *entry.second;
+    }
+    m_rows.emplace_back(name, std::unique_ptr<LatencyHistogram>(new LatencyHistogram()));
+    return *m_rows.back().second;
+}
+
+void BenchmarkRun::returned_to_java() {
+    if (m_env->ExceptionCheck()) {
+        m_env->ExceptionDescribe();
+        m_env->ExceptionClear();
+        fail("Java exception pending on return");
+    }
+    fake_jni::return_to_java(m_env);
+}
+
+void BenchmarkRun::fail(const std::string& message) {
+    if (!m_failed)
+        std::fprintf(stderr, "%s: %s\n", m_name.c_str(), message.c_str());
+    m_failed = true;
+}
+
+std::string BenchmarkRun::csv() const {
+    std::string result;
+    char line[512];
+    for (const auto& entry : m_rows) {
+        int64_t snapshot[LatencyHistogram::snapshot_size];
+        entry.second->snapshot(snapshot);
+        // snapshot: count, sum, max, p50, p90, p99, buckets
+        std::snprintf(line, sizeof(line), "%s,%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64,
+                      entry.first.c_str(), snapshot[0], snapshot[1], snapshot[3], snapshot[5], snapshot[2]);
+        result += line;
+        for (int b = 0; b < LatencyHistogram::buckets; ++b)
+            result += "," + std::to_string(snapshot[6 + b]);
+        result += "\n";
+    }
+    return result;
+}
+
+/* Every native of JNI_OnLoad needs a JNI_BENCHMARK of the same function, and no JNI_BENCHMARK may be stale */
+static bool checkNativeCoverage() {
+    bool complete = true;
+    const auto natives = fake_jni::natives(host_app::native_class());
+    for (const auto& native : natives) {
+        const auto name = std::string("jni/") + native.name;
+        const auto it = std::find_if(Benchmark::all().begin(), Benchmark::all().end(), [&](const Benchmark* benchmark) {
+            return name == benchmark->name();
+        });
+        if (it == Benchmark::all().end()) {
+            std::fprintf(stderr, "No benchmark for the native %s\n", native.name);
+            complete = false;
+        } else if ((*it)->native() != native.fnPtr) {
+            std::fprintf(stderr, "%s does not benchmark the registered function\n", name.c_str());
+            complete = false;
+        }
+    }
+    for (const auto* benchmark : Benchmark::all()) {
+        if (!benchmark->native())
+            continue;
+        const bool registered = std::any_of(natives.begin(), natives.end(), [benchmark](const JNINativeMethod& native) {
+            return native.fnPtr == benchmark->native();
+        });
+        if (!registered) {
+            std::fprintf(stderr, "%s benchmarks a function that is not registered\n", benchmark->name());
+            complete = false;
+        }
+    }
+    return complete;
+}
+
+static std::string profileCsvHeader() {
+    std::string header = "function,calls,total_ns,p50_ns,p99_ns,max_ns";
+    for (int b = 0; b < LatencyHistogram::buckets; ++b)
+        header += ",bucket" + std::to_string(b);
+    return header + "\n";
+}
+
+int main(int argc, char** argv) {
+    bool quick = false;
+    bool list = false;
+    std::string filter;
+    const char* output = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else if (std::strcmp(argv[i], "--list") == 0) {
+            list = true;
+        } else if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+            filter = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--output=", 9) == 0) {
+            output = argv[i] + 9;
+        } else {
+            std::fprintf(stderr, "Usage: %s [--quick] [--filter=<substring>] [--output=<file>] [--list]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    JNIEnv* env = host_app::load();
+    auto benchmarks = Benchmark::all();
+    std::sort(benchmarks.begin(), benchmarks.end(), [](const Benchmark* a, const Benchmark* b) {
+        return std::strcmp(a->name(), b->name()) < 0;
+    });
+    if (list) {
+        for (const auto* benchmark : benchmarks)
+            std::printf("%s\n", benchmark->name());
+        return 0;
+    }
+    bool passed = checkNativeCoverage();
+
+    FILE* out = output ? std::fopen(output, "w") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "Cannot open %s\n", output);
+        return 1;
+    }
+    std::fputs(profileCsvHeader().c_str(), out);
+    for (const auto* benchmark : benchmarks) {
+        if (!filter.empty() && std::strstr(benchmark->name(), filter.c_str()) == nullptr)
+            continue;
+        const auto objects = fake_jni::live_objects();
+        BenchmarkRun run(env, benchmark->name(), quick);
+        benchmark->body()(run);
+        run.returned_to_java();
+        if (fake_jni::live_objects() > objects)
+            run.fail("leaked " + std::to_string(fake_jni::live_objects() - objects) + " Java objects");
+        std::fputs(run.csv().c_str(), out);
+        std::fflush(out);
+        passed = passed && !run.failed();
+    }
+    if (out != stdout)
+        std::fclose(out);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,792 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "fake_jni.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+struct _jmethodID {
+    jclass owner;
+    std::string name;
+    std::string signature;
+    std::string parameters;  // one descriptor character per parameter, 'L' for objects and arrays
+    fake_jni::Method method;
+};
+
+struct _jfieldID {
+    jclass owner;
+    std::string name;
+    std::string signature;
+    std::size_t index;
+    bool reference;
+};
+
+namespace fake_jni {
+namespace {
+
+/* ART aborts long before that, a thread that never returns to Java leaks them one by one */
+constexpr std::size_t max_local_references = 65536;
+
+[[noreturn]] void fatal(const char* message, const char* detail = "") {
+    std::fprintf(stderr, "fake JNI: %s %s\n", message, detail);
+    std::abort();
+}
+
+struct ClassObject : _jclass {
+    std::string name;
+    std::mutex mutex;
+    std::deque<_jmethodID> methods;
+    std::deque<_jfieldID> fields;
+    std::list<std::string> native_strings;
+    std::vector<JNINativeMethod> natives;
+};
+
+struct Instance : _jobject {
+    ~Instance() override;
+    std::vector<jvalue> values;
+    std::vector<bool> references;
+};
+
+struct StringObject : _jstring {
+    std::u16string chars;
+};
+
+template <typename Base, typename T>
+struct PrimitiveArray : Base {
+    std::vector<T> elements;
+};
+
+using ByteArray = PrimitiveArray<_jbyteArray, jbyte>;
+using IntArray = PrimitiveArray<_jintArray, jint>;
+using LongArray = PrimitiveArray<_jlongArray, jlong>;
+using DoubleArray = PrimitiveArray<_jdoubleArray, jdouble>;
+
+struct ObjectArray : _jobjectArray {
+    ~ObjectArray() override;
+    std::vector<jobject> elements;
+};
+
+struct DirectBuffer : _jobject {
+    void* address;
+    jlong capacity;
+};
+
+struct Env : _JNIEnv {
+    std::vector<std::vector<jobject>> frames{1};
+    std::size_t local_count = 0;
+    bool exception = false;
+    std::string exception_message;
+};
+
+thread_local Env* tEnv = nullptr;
+_JavaVM gVm;
+
+std::atomic<std::size_t> gLiveObjects{0};
+
+std::mutex gClassMutex;
+std::unordered_map<std::string, std::unique_ptr<ClassObject>> gClasses;
+ClassObject* gClassClass;
+jobject gClassLoader;
+
+Env* env_of(JNIEnv* env) { return static_cast<Env*>(env); }
+
+jobject retain(jobject obj) {
+    if (obj)
+        obj->fake_references.fetch_add(1, std::memory_order_relaxed);
+    return obj;
+}
+
+void release(jobject obj) {
+    if (!obj || obj->fake_references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+    if (dynamic_cast<ClassObject*>(obj))
+        fatal("released the last reference of a class");
+    gLiveObjects.fetch_sub(1, std::memory_order_relaxed);
+    delete obj;
+}
+
+Instance::~Instance() {
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (references[i])
+            release(values[i].l);
+    }
+}
+
+ObjectArray::~ObjectArray() {
+    for (auto element : elements)
+        release(element);
+}
+
+/* Takes over the reference of obj as a local reference of env */
+template <typename T>
+T add_local(JNIEnv* env, T obj) {
+    if (!obj)
+        return obj;
+    auto* state = env_of(env);
+    if (++state->local_count > max_local_references)
+        fatal("local reference table overflow");
+    state->frames.back().push_back(obj);
+    return obj;
+}
+
+template <typename T>
+T* create(JNIEnv* env, T* obj, jclass cls) {
+    obj->fake_class = cls;
+    obj->fake_references.store(1, std::memory_order_relaxed);
+    gLiveObjects.fetch_add(1, std::memory_order_relaxed);
+    return add_local(env, obj);
+}
+
+void release_frame(Env* state, std::vector<jobject>& frame) {
+    state->local_count -= frame.size();
+    for (auto obj : frame)
+        release(obj);
+    frame.clear();
+}
+
+void throw_pending(JNIEnv* env, const char* type, const std::string& message) {
+    auto* state = env_of(env);
+    if (state->exception)
+        return;
+    state->exception = true;
+    state->exception_message = std::string(type) + ": " + message;
+}
+
+ClassObject* class_of(jclass cls) {
+    auto* result = dynamic_cast<ClassObject*>(static_cast<_jobject*>(cls));
+    if (!result)
+        fatal("not a class");
+    return result;
+}
+
+std::string parameter_types(const std::string& signature) {
+    std::string result;
+    if (signature.empty() || signature[0] != '(')
+        fatal("malformed method signature", signature.c_str());
+    for (std::size_t i = 1; i < signature.size() && signature[i] != ')'; ++i) {
+        char type = signature[i];
+        while (signature[i] == '[') {
+            type = 'L';
+            ++i;
+        }
+        if (signature[i] == 'L')
+            i = signature.find(';', i);
+        if (i == std::string::npos)
+            fatal("malformed method signature", signature.c_str());
+        result += type;
+    }
+    return result;
+}
+
+std::vector<jvalue> read_arguments(const _jmethodID* method, va_list args) {
+    std::vector<jvalue> values(method->parameters.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        switch (method->parameters[i]) {
+            case 'Z': values[i].z = static_cast<jboolean>(va_arg(args, int)); break;
+            case 'B': values[i].b = static_cast<jbyte>(va_arg(args, int)); break;
+            case 'C': values[i].c = static_cast<jchar>(va_arg(args, int)); break;
+            case 'S': values[i].s = static_cast<jshort>(va_arg(args, int)); break;
+            case 'I': values[i].i = va_arg(args, jint); break;
+            case 'J': values[i].j = va_arg(args, jlong); break;
+            case 'F': values[i].f = static_cast<jfloat>(va_arg(args, double)); break;
+            case 'D': values[i].d = va_arg(args, double); break;
+            default: values[i].l = va_arg(args, jobject); break;
+        }
+    }
+    return values;
+}
+
+jvalue invoke(JNIEnv* env, jobject obj, jmethodID method, const jvalue* args) {
+    if (!obj || !method)
+        fatal("method call on null");
+    if (obj->fake_class != method->owner)
+        fatal("method called on an object of another class", method->name.c_str());
+    return method->method(env, obj, args);
+}
+
+/* Modified UTF-8 as JNI takes it, standard four byte sequences are accepted as well */
+std::u16string decode_utf8(const char* bytes) {
+    std::u16string result;
+    const auto* in = reinterpret_cast<const unsigned char*>(bytes);
+    while (*in) {
+        uint32_t code = *in++;
+        int continuation = 0;
+        if (code >= 0xF0) {
+            code &= 0x07;
+            continuation = 3;
+        } else if (code >= 0xE0) {
+            code &= 0x0F;
+            continuation = 2;
+        } else if (code >= 0xC0) {
+            code &= 0x1F;
+            continuation = 1;
+        } else if (code >= 0x80) {
+            code = 0xFFFD;
+        }
+        for (; continuation > 0; --continuation) {
+            if ((*in & 0xC0) != 0x80) {
+                code = 0xFFFD;
+                break;
+            }
+            code = (code << 6) | (*in++ & 0x3F);
+        }
+        if (code >= 0x10000) {
+            code -= 0x10000;
+            result += static_cast<char16_t>(0xD800 + (code >> 10));
+            result += static_cast<char16_t>(0xDC00 + (code & 0x3FF));
+        } else {
+            result += static_cast<char16_t>(code);
+        }
+    }
+    return result;
+}
+
+std::size_t modified_utf8_length(char16_t c) {
+    return c != 0 && c < 0x80 ? 1 : c < 0x800 ? 2 : 3;
+}
+
+void encode_modified_utf8(char16_t c, std::string& out) {
+    if (c != 0 && c < 0x80) {
+        out += static_cast<char>(c);
+    } else if (c < 0x800) {
+        out += static_cast<char>(0xC0 | (c >> 6));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    } else {
+        out += static_cast<char>(0xE0 | (c >> 12));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    }
+}
+
+StringObject* string_of(jstring string) {
+    auto* result = dynamic_cast<StringObject*>(static_cast<_jobject*>(string));
+    if (!result)
+        fatal("not a string");
+    return result;
+}
+
+template <typename Array>
+Array* array_of(_jobject* array) {
+    auto* result = dynamic_cast<Array*>(array);
+    if (!result)
+        fatal("not an array of the expected type");
+    return result;
+}
+
+template <typename Array, typename T>
+void get_region(JNIEnv* env, _jobject* array, jsize start, jsize length, T* buffer) {
+    auto& elements = array_of<Array>(array)->elements;
+    if (start < 0 || length < 0 || static_cast<std::size_t>(start) + length > elements.size())
+        return throw_pending(env, "java/lang/ArrayIndexOutOfBoundsException", "region");
+    std::copy(elements.begin() + start, elements.begin() + start + length, buffer);
+}
+
+template <typename Array, typename T>
+void set_region(JNIEnv* env, _jobject* array, jsize start, jsize length, const T* buffer) {
+    auto& elements = array_of<Array>(array)->elements;
+    if (start < 0 || length < 0 || static_cast<std::size_t>(start) + length > elements.size())
+        return throw_pending(env, "java/lang/ArrayIndexOutOfBoundsException", "region");
+    std::copy(buffer, buffer + length, elements.begin() + start);
+}
+
+template <typename Array>
+Array* new_array(JNIEnv* env, jsize length, const char* class_name) {
+    if (length < 0)
+        fatal("negative array size");
+    auto* array = new Array();
+    array->elements.resize(static_cast<std::size_t>(length));
+    return create(env, array, define_class(class_name));
+}
+
+/* java.lang.Class.getClassLoader and ClassLoader.loadClass, which looks up the defined classes */
+void define_bootstrap_classes() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        auto* class_class = static_cast<ClassObject*>(define_class("java/lang/Class"));
+        jclass loader_class = define_class("java/lang/ClassLoader");
+        define_class("java/lang/Object");
+        define_class("java/lang/String");
+
+        auto* loader = new Instance();
+        loader->fake_class = loader_class;
+        loader->fake_references.store(1, std::memory_order_relaxed);
+        gClassLoader = loader;
+
+        define_method(class_class, "getClassLoader", "()Ljava/lang/ClassLoader;", [](JNIEnv* env, jobject, const jvalue*) {
+            jvalue result;
+            result.l = env->NewLocalRef(gClassLoader);
+            return result;
+        });
+        define_method(loader_class, "loadClass", "(Ljava/lang/String;)Ljava/lang/Class;", [](JNIEnv* env, jobject, const jvalue* args) {
+            auto name = utf8(static_cast<jstring>(args[0].l));
+            std::replace(name.begin(), name.end(), '.', '/');
+            jvalue result;
+            result.l = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(gClassMutex);
+                const auto it = gClasses.find(name);
+                if (it != gClasses.end())
+                    result.l = it->second.get();
+            }
+            if (result.l)
+                result.l = env->NewLocalRef(result.l);
+            else
+                throw_pending(env, "java/lang/ClassNotFoundException", name);
+            return result;
+        });
+    });
+}
+
+}
+
+JavaVM* java_vm() {
+    return &gVm;
+}
+
+JNIEnv* attach() {
+    JNIEnv* env = nullptr;
+    gVm.AttachCurrentThread(&env, nullptr);
+    return env;
+}
+
+jclass define_class(const char* name) {
+    std::lock_guard<std::mutex> lock(gClassMutex);
+    if (!gClassClass) {
+        auto& class_class = gClasses["java/lang/Class"];
+        class_class.reset(new ClassObject());
+        class_class->name = "java/lang/Class";
+        class_class->fake_class = class_class.get();
+        class_class->fake_references.store(1, std::memory_order_relaxed);
+        gClassClass = class_class.get();
+    }
+    auto& entry = gClasses[name];
+    if (!entry) {
+        entry.reset(new ClassObject());
+        entry->name = name;
+        entry->fake_class = gClassClass;
+        entry->fake_references.store(1, std::memory_order_relaxed);
+    }
+    return entry.get();
+}
+
+void define_method(jclass cls, const char* name, const char* signature, Method method) {
+    auto* owner = class_of(cls);
+    std::lock_guard<std::mutex> lock(owner->mutex);
+    owner->methods.push_back({cls, name, signature, parameter_types(signature), std::move(method)});
+}
+
+jfieldID define_field(jclass cls, const char* name, const char* signature) {
+    auto* owner = class_of(cls);
+    std::lock_guard<std::mutex> lock(owner->mutex);
+    const bool reference = signature[0] == 'L' || signature[0] == '[';
+    owner->fields.push_back({cls, name, signature, owner->fields.size(), reference});
+    return &owner->fields.back();
+}
+
+jobject new_instance(JNIEnv* env, jclass cls) {
+    return create(env, new Instance(), cls);
+}
+
+void set_field(jobject obj, jfieldID field, jvalue value) {
+    auto* instance = dynamic_cast<Instance*>(obj);
+    if (!instance || obj->fake_class != field->owner)
+        fatal("field of another class", field->name.c_str());
+    if (instance->values.size() <= field->index) {
+        instance->values.resize(field->index + 1, jvalue{});
+        instance->references.resize(field->index + 1, false);
+    }
+    if (field->reference) {
+        retain(value.l);
+        if (instance->references[field->index])
+            release(instance->values[field->index].l);
+    }
+    instance->values[field->index] = value;
+    instance->references[field->index] = field->reference;
+}
+
+jvalue get_field(jobject obj, jfieldID field) {
+    auto* instance = dynamic_cast<Instance*>(obj);
+    if (!instance || obj->fake_class != field->owner)
+        fatal("field of another class", field->name.c_str());
+    return field->index < instance->values.size() ? instance->values[field->index] : jvalue{};
+}
+
+jobject new_direct_buffer(JNIEnv* env, const char* class_name, void* address, jlong capacity) {
+    auto* buffer = new DirectBuffer();
+    buffer->address = address;
+    buffer->capacity = capacity;
+    return create(env, buffer, define_class(class_name));
+}
+
+jstring new_string(JNIEnv* env, const std::string& utf8) {
+    return env->NewStringUTF(utf8.c_str());
+}
+
+std::string utf8(jstring string) {
+    const auto& chars = string_of(string)->chars;
+    std::string result;
+    for (std::size_t i = 0; i < chars.size(); ++i) {
+        uint32_t code = chars[i];
+        if (code >= 0xD800 && code < 0xDC00 && i + 1 < chars.size() && chars[i + 1] >= 0xDC00 && chars[i + 1] < 0xE000)
+            code = 0x10000 + ((code - 0xD800) << 10) + (chars[++i] - 0xDC00);
+        if (code < 0x80) {
+            result += static_cast<char>(code);
+        } else if (code < 0x800) {
+            result += static_cast<char>(0xC0 | (code >> 6));
+            result += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            result += static_cast<char>(0xE0 | (code >> 12));
+            result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            result += static_cast<char>(0xF0 | (code >> 18));
+            result += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+    return result;
+}
+
+std::vector<JNINativeMethod> natives(jclass cls) {
+    auto* owner = class_of(cls);
+    std::lock_guard<std::mutex> lock(owner->mutex);
+    return owner->natives;
+}
+
+void return_to_java(JNIEnv* env) {
+    auto* state = env_of(env);
+    if (state->frames.size() != 1)
+        fatal("native method returned with a local frame still pushed");
+    release_frame(state, state->frames.back());
+}
+
+std::size_t live_objects() {
+    return gLiveObjects.load(std::memory_order_relaxed);
+}
+
+std::size_t local_references(JNIEnv* env) {
+    return env_of(env)->local_count;
+}
+
+}
+
+using namespace fake_jni;
+
+jclass _JNIEnv::FindClass(const char* name) {
+    jclass result = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(gClassMutex);
+        const auto it = gClasses.find(name);
+        if (it != gClasses.end())
+            result = it->second.get();
+    }
+    if (!result) {
+        throw_pending(this, "java/lang/NoClassDefFoundError", name);
+        return nullptr;
+    }
+    return add_local(this, static_cast<jclass>(retain(result)));
+}
+
+jclass _JNIEnv::GetObjectClass(jobject obj) {
+    if (!obj)
+        fatal("GetObjectClass of null");
+    return add_local(this, static_cast<jclass>(retain(obj->fake_class)));
+}
+
+jint _JNIEnv::ThrowNew(jclass cls, const char* message) {
+    throw_pending(this, class_of(cls)->name.c_str(), message ? message : "");
+    return JNI_OK;
+}
+
+jboolean _JNIEnv::ExceptionCheck() {
+    return env_of(this)->exception ? JNI_TRUE : JNI_FALSE;
+}
+
+void _JNIEnv::ExceptionDescribe() {
+    auto* state = env_of(this);
+    if (state->exception)
+        std::fprintf(stderr, "fake JNI: pending %s\n", state->exception_message.c_str());
+}
+
+void _JNIEnv::ExceptionClear() {
+    auto* state = env_of(this);
+    state->exception = false;
+    state->exception_message.clear();
+}
+
+jint _JNIEnv::PushLocalFrame(jint capacity) {
+    auto* state = env_of(this);
+    state->frames.emplace_back();
+    state->frames.back().reserve(static_cast<std::size_t>(std::max(capacity, 0)));
+    return JNI_OK;
+}
+
+jobject _JNIEnv::PopLocalFrame(jobject result) {
+    auto* state = env_of(this);
+    if (state->frames.size() < 2)
+        fatal("PopLocalFrame without PushLocalFrame");
+    retain(result);
+    release_frame(state, state->frames.back());
+    state->frames.pop_back();
+    return add_local(this, result);
+}
+
+jobject _JNIEnv::NewGlobalRef(jobject obj) {
+    return retain(obj);
+}
+
+void _JNIEnv::DeleteGlobalRef(jobject obj) {
+    release(obj);
+}
+
+jobject _JNIEnv::NewLocalRef(jobject obj) {
+    return add_local(this, retain(obj));
+}
+
+void _JNIEnv::DeleteLocalRef(jobject obj) {
+    if (!obj)
+        return;
+    auto* state = env_of(this);
+    for (auto frame = state->frames.rbegin(); frame != state->frames.rend(); ++frame) {
+        const auto it = std::find(frame->rbegin(), frame->rend(), obj);
+        if (it != frame->rend()) {
+            frame->erase(std::next(it).base());
+            --state->local_count;
+            release(obj);
+            return;
+        }
+    }
+    fatal("DeleteLocalRef of a reference that is not a local reference of this thread");
+}
+
+jobject _JNIEnv::NewObject(jclass cls, jmethodID constructor, ...) {
+    va_list args;
+    va_start(args, constructor);
+    const auto values = read_arguments(constructor, args);
+    va_end(args);
+    return NewObjectA(cls, constructor, values.data());
+}
+
+jobject _JNIEnv::NewObjectA(jclass cls, jmethodID constructor, const jvalue* args) {
+    if (!constructor || constructor->owner != cls || constructor->name != "<init>")
+        fatal("NewObject without a constructor of the class");
+    jobject obj = new_instance(this, cls);
+    constructor->method(this, obj, args);
+    if (ExceptionCheck()) {
+        DeleteLocalRef(obj);
+        return nullptr;
+    }
+    return obj;
+}
+
+jmethodID _JNIEnv::GetMethodID(jclass cls, const char* name, const char* signature) {
+    auto* owner = class_of(cls);
+    {
+        std::lock_guard<std::mutex> lock(owner->mutex);
+        for (auto& method : owner->methods) {
+            if (method.name == name && method.signature == signature)
+                return &method;
+        }
+    }
+    throw_pending(this, "java/lang/NoSuchMethodError", owner->name + "." + name + signature);
+    return nullptr;
+}
+
+jobject _JNIEnv::CallObjectMethod(jobject obj, jmethodID method, ...) {
+    va_list args;
+    va_start(args, method);
+    const auto values = read_arguments(method, args);
+    va_end(args);
+    return invoke(this, obj, method, values.data()).l;
+}
+
+void _JNIEnv::CallVoidMethod(jobject obj, jmethodID method, ...) {
+    va_list args;
+    va_start(args, method);
+    const auto values = read_arguments(method, args);
+    va_end(args);
+    invoke(this, obj, method, values.data());
+}
+
+jfieldID _JNIEnv::GetFieldID(jclass cls, const char* name, const char* signature) {
+    auto* owner = class_of(cls);
+    {
+        std::lock_guard<std::mutex> lock(owner->mutex);
+        for (auto& field : owner->fields) {
+            if (field.name == name && field.signature == signature)
+                return &field;
+        }
+    }
+    throw_pending(this, "java/lang/NoSuchFieldError", owner->name + "." + name);
+    return nullptr;
+}
+
+jobject _JNIEnv::GetObjectField(jobject obj, jfieldID field) {
+    if (!field->reference)
+        fatal("GetObjectField of a primitive field", field->name.c_str());
+    return NewLocalRef(get_field(obj, field).l);
+}
+
+jstring _JNIEnv::NewStringUTF(const char* bytes) {
+    if (!bytes)
+        return nullptr;
+    auto* string = new StringObject();
+    string->chars = decode_utf8(bytes);
+    return create(this, string, define_class("java/lang/String"));
+}
+
+jsize _JNIEnv::GetStringLength(jstring string) {
+    return static_cast<jsize>(string_of(string)->chars.size());
+}
+
+jsize _JNIEnv::GetStringUTFLength(jstring string) {
+    std::size_t length = 0;
+    for (const auto c : string_of(string)->chars)
+        length += modified_utf8_length(c);
+    return static_cast<jsize>(length);
+}
+
+void _JNIEnv::GetStringUTFRegion(jstring string, jsize start, jsize length, char* buffer) {
+    const auto& chars = string_of(string)->chars;
+    if (start < 0 || length < 0 || static_cast<std::size_t>(start) + length > chars.size())
+        return throw_pending(this, "java/lang/StringIndexOutOfBoundsException", "region");
+    std::string encoded;
+    for (jsize i = start; i < start + length; ++i)
+        encode_modified_utf8(chars[i], encoded);
+    std::copy(encoded.begin(), encoded.end(), buffer);
+}
+
+jsize _JNIEnv::GetArrayLength(jarray array) {
+    if (auto* objects = dynamic_cast<ObjectArray*>(array))
+        return static_cast<jsize>(objects->elements.size());
+    if (auto* bytes = dynamic_cast<ByteArray*>(array))
+        return static_cast<jsize>(bytes->elements.size());
+    if (auto* ints = dynamic_cast<IntArray*>(array))
+        return static_cast<jsize>(ints->elements.size());
+    if (auto* longs = dynamic_cast<LongArray*>(array))
+        return static_cast<jsize>(longs->elements.size());
+    if (auto* doubles = dynamic_cast<DoubleArray*>(array))
+        return static_cast<jsize>(doubles->elements.size());
+    fatal("GetArrayLength of a non-array");
+}
+
+jobjectArray _JNIEnv::NewObjectArray(jsize length, jclass element_class, jobject initial) {
+    if (!element_class)
+        fatal("NewObjectArray without element class");
+    auto* array = new_array<ObjectArray>(this, length, "[Ljava/lang/Object;");
+    for (auto& element : array->elements)
+        element = retain(initial);
+    return array;
+}
+
+jobject _JNIEnv::GetObjectArrayElement(jobjectArray array, jsize index) {
+    auto& elements = array_of<ObjectArray>(array)->elements;
+    if (index < 0 || static_cast<std::size_t>(index) >= elements.size()) {
+        throw_pending(this, "java/lang/ArrayIndexOutOfBoundsException", std::to_string(index));
+        return nullptr;
+    }
+    return NewLocalRef(elements[index]);
+}
+
+void _JNIEnv::SetObjectArrayElement(jobjectArray array, jsize index, jobject value) {
+    auto& elements = array_of<ObjectArray>(array)->elements;
+    if (index < 0 || static_cast<std::size_t>(index) >= elements.size())
+        return throw_pending(this, "java/lang/ArrayIndexOutOfBoundsException", std::to_string(index));
+    retain(value);
+    release(elements[index]);
+    elements[index] = value;
+}
+
+jbyteArray _JNIEnv::NewByteArray(jsize length) { return new_array<ByteArray>(this, length, "[B"); }
+jintArray _JNIEnv::NewIntArray(jsize length) { return new_array<IntArray>(this, length, "[I"); }
+jlongArray _JNIEnv::NewLongArray(jsize length) { return new_array<LongArray>(this, length, "[J"); }
+jdoubleArray _JNIEnv::NewDoubleArray(jsize length) { return new_array<DoubleArray>(this, length, "[D"); }
+
+void _JNIEnv::GetByteArrayRegion(jbyteArray array, jsize start, jsize length, jbyte* buffer) { get_region<ByteArray>(this, array, start, length, buffer); }
+void _JNIEnv::GetIntArrayRegion(jintArray array, jsize start, jsize length, jint* buffer) { get_region<IntArray>(this, array, start, length, buffer); }
+void _JNIEnv::GetLongArrayRegion(jlongArray array, jsize start, jsize length, jlong* buffer) { get_region<LongArray>(this, array, start, length, buffer); }
+void _JNIEnv::GetDoubleArrayRegion(jdoubleArray array, jsize start, jsize length, jdouble* buffer) { get_region<DoubleArray>(this, array, start, length, buffer); }
+void _JNIEnv::SetByteArrayRegion(jbyteArray array, jsize start, jsize length, const jbyte* buffer) { set_region<ByteArray>(this, array, start, length, buffer); }
+void _JNIEnv::SetIntArrayRegion(jintArray array, jsize start, jsize length, const jint* buffer) { set_region<IntArray>(this, array, start, length, buffer); }
+void _JNIEnv::SetLongArrayRegion(jlongArray array, jsize start, jsize length, const jlong* buffer) { set_region<LongArray>(this, array, start, length, buffer); }
+void _JNIEnv::SetDoubleArrayRegion(jdoubleArray array, jsize start, jsize length, const jdouble* buffer) { set_region<DoubleArray>(this, array, start, length, buffer); }
+
+jint _JNIEnv::RegisterNatives(jclass cls, const JNINativeMethod* methods, jint count) {
+    auto* owner = class_of(cls);
+    std::lock_guard<std::mutex> lock(owner->mutex);
+    for (jint i = 0; i < count; ++i) {
+        if (!methods[i].name || !methods[i].signature || !methods[i].fnPtr) {
+            throw_pending(this, "java/lang/NoSuchMethodError", owner->name);
+            return JNI_ERR;
+        }
+        parameter_types(methods[i].signature);
+        owner->native_strings.emplace_back(methods[i].name);
+        const char* name = owner->native_strings.back().c_str();
+        owner->native_strings.emplace_back(methods[i].signature);
+        owner->natives.push_back({name, owner->native_strings.back().c_str(), methods[i].fnPtr});
+    }
+    return JNI_OK;
+}
+
+jint _JNIEnv::GetJavaVM(JavaVM** vm) {
+    *vm = &gVm;
+    return JNI_OK;
+}
+
+jobject _JNIEnv::NewDirectByteBuffer(void* address, jlong capacity) {
+    return new_direct_buffer(this, "java/nio/ByteBuffer", address, capacity);
+}
+
+void* _JNIEnv::GetDirectBufferAddress(jobject buffer) {
+    auto* direct = dynamic_cast<DirectBuffer*>(buffer);
+    return direct ? direct->address : nullptr;
+}
+
+jlong _JNIEnv::GetDirectBufferCapacity(jobject buffer) {
+    auto* direct = dynamic_cast<DirectBuffer*>(buffer);
+    return direct ? direct->capacity : -1;
+}
+
+jint _JavaVM::DestroyJavaVM() {
+    return JNI_ERR;
+}
+
+jint _JavaVM::AttachCurrentThread(JNIEnv** env, void*) {
+    if (!tEnv) {
+        define_bootstrap_classes();
+        tEnv = new Env();
+    }
+    *env = tEnv;
+    return JNI_OK;
+}
+
+jint _JavaVM::DetachCurrentThread() {
+    if (!tEnv)
+        return JNI_ERR;
+    for (auto& frame : tEnv->frames)
+        release_frame(tEnv, frame);
+    delete tEnv;
+    tEnv = nullptr;
+    return JNI_OK;
+}
+
+jint _JavaVM::GetEnv(void** env, jint version) {
+    if (version != JNI_VERSION_1_6)
+        return JNI_EVERSION;
+    if (!tEnv)
+        return JNI_EDETACHED;
+    *env = static_cast<JNIEnv*>(tEnv);
+    return JNI_OK;
+}
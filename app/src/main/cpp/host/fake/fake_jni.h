@@ -0,0 +1,58 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * In-process stand-in for the Java VM of the host build, behind the JNIEnv of host/include/jni.h. Objects
+ * are reference counted C++ objects and live as long as a local or global reference to them exists, so
+ * leaked references show up in live_objects(). Local references are released by PopLocalFrame, by
+ * DeleteLocalRef and by return_to_java, which does what returning from a native method does. Classes,
+ * their methods and fields are defined by the host code, methods run a C++ function.
+ */
+#pragma once
+
+#include <jni.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace fake_jni {
+
+/* Runs a method, self is the new object for constructors. Returned objects must be new local references. */
+using Method = std::function<jvalue(JNIEnv* env, jobject self, const jvalue* args)>;
+
+JavaVM* java_vm();
+/* JNIEnv of the calling thread, attaches it if needed */
+JNIEnv* attach();
+
+/* Defines the class name ("java/lang/String" notation) once, later calls return the same class */
+jclass define_class(const char* name);
+void define_method(jclass cls, const char* name, const char* signature, Method method);
+jfieldID define_field(jclass cls, const char* name, const char* signature);
+
+/* A new local reference to an instance of cls, its fields zero, no constructor run */
+jobject new_instance(JNIEnv* env, jclass cls);
+/* Object fields take a reference to value and release the previous one */
+void set_field(jobject obj, jfieldID field, jvalue value);
+jvalue get_field(jobject obj, jfieldID field);
+
+/* A direct buffer of class class_name, capacity is in elements of the buffer type as in JNI */
+jobject new_direct_buffer(JNIEnv* env, const char* class_name, void* address, jlong capacity);
+
+jstring new_string(JNIEnv* env, const std::string& utf8);
+std::string utf8(jstring string);
+
+/* The natives registered for cls, in registration order */
+std::vector<JNINativeMethod> natives(jclass cls);
+
+/* Releases the local references of the calling thread, as returning from a native method to Java does */
+void return_to_java(JNIEnv* env);
+
+/* Objects alive, excluding classes */
+std::size_t live_objects();
+/* Local references held by the calling thread */
+std::size_t local_references(JNIEnv* env);
+
+}
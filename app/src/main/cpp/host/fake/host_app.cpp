@@ -0,0 +1,254 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "host_app.h"
+#include "fake_jni.h"
+#include "ts3client_wrapper.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define APP_CLASS(name) "com/teamspeak/ts3sdkclient/ts3sdk/" name
+
+namespace host_app {
+namespace {
+
+struct EventClass {
+    jclass cls = nullptr;
+    std::vector<jfieldID> arguments;
+    std::atomic<uint64_t> posted{0};
+};
+
+EventClass gEvents[EventType_Count];
+jclass gNativeClass;
+jclass gContextClass;
+jfieldID gContextInfo;
+jclass gInfoClass;
+jfieldID gInfoLibraryDir;
+jclass gBatchClass;
+jfieldID gBatchBuffer;
+
+std::mutex gObserverMutex;
+PostObserver gPostObserver;
+BatchObserver gBatchObserver;
+
+std::atomic<uint64_t> gBatches{0};
+std::atomic<uint64_t> gBatchEvents{0};
+
+/* EventBatch buffers live as long as the process, like the ones of a batch the app keeps around */
+std::mutex gBatchMemoryMutex;
+std::vector<std::unique_ptr<uint8_t[]>> gBatchMemory;
+
+[[noreturn]] void fail(const char* message) {
+    std::fprintf(stderr, "host app: %s\n", message);
+    std::abort();
+}
+
+/* One field per constructor parameter, "(JILjava/lang/String;)V" gives J, I and a String */
+void define_event(EventType type, const char* name, const char* signature) {
+    auto& event = gEvents[type];
+    event.cls = fake_jni::define_class((std::string(APP_CLASS("events/")) + name).c_str());
+    for (const char* p = signature + 1; *p != ')'; ++p) {
+        std::string descriptor(1, *p);
+        if (*p == 'L') {
+            const char* end = p;
+            while (*end != ';')
+                ++end;
+            descriptor.assign(p, end + 1);
+            p = end;
+        }
+        const auto field = "arg" + std::to_string(event.arguments.size());
+        event.arguments.push_back(fake_jni::define_field(event.cls, field.c_str(), descriptor.c_str()));
+    }
+    fake_jni::define_method(event.cls, "<init>", signature, [type](JNIEnv*, jobject self, const jvalue* args) {
+        const auto& fields = gEvents[type].arguments;
+        for (std::size_t i = 0; i < fields.size(); ++i)
+            fake_jni::set_field(self, fields[i], args[i]);
+        return jvalue{};
+    });
+    fake_jni::define_method(event.cls, "Post", "()V", [type](JNIEnv* env, jobject self, const jvalue*) {
+        gEvents[type].posted.fetch_add(1, std::memory_order_relaxed);
+        PostObserver observer;
+        {
+            std::lock_guard<std::mutex> lock(gObserverMutex);
+            observer = gPostObserver;
+        }
+        if (observer)
+            observer(env, type, self);
+        return jvalue{};
+    });
+}
+
+template <typename Callback>
+void define_event(EventType type, const char* name) {
+    define_event(type, name, JniEvent<Callback>::signature.data());
+}
+
+void define_classes() {
+    gNativeClass = fake_jni::define_class(APP_CLASS("Native"));
+
+    define_event<decltype(ClientUIFunctions::onConnectStatusChangeEvent)>(EventType_ConnectStatusChange, "ConnectStatusChange");
+    define_event<decltype(ClientUIFunctions::onNewChannelEvent)>(EventType_NewChannel, "NewChannel");
+    define_event<decltype(ClientUIFunctions::onNewChannelCreatedEvent)>(EventType_NewChannelCreated, "NewChannelCreated");
+    define_event<decltype(ClientUIFunctions::onDelChannelEvent)>(EventType_DelChannel, "DelChannel");
+    define_event<decltype(ClientUIFunctions::onClientMoveEvent)>(EventType_ClientMove, "ClientMove");
+    define_event<decltype(ClientUIFunctions::onClientMoveSubscriptionEvent)>(EventType_ClientMoveSubscription, "ClientMoveSubscription");
+    define_event<decltype(ClientUIFunctions::onClientMoveTimeoutEvent)>(EventType_ClientMoveTimeout, "ClientMoveTimeout");
+    define_event<decltype(ClientUIFunctions::onClientMoveMovedEvent)>(EventType_ClientMoveMoved, "ClientMoveMoved");
+    define_event<decltype(ClientUIFunctions::onTalkStatusChangeEvent)>(EventType_TalkStatusChange, "TalkStatusChange");
+    define_event<decltype(ClientUIFunctions::onServerErrorEvent)>(EventType_ServerError, "ServerError");
+    define_event<decltype(ClientUIFunctions::onUserLoggingMessageEvent)>(EventType_UserLoggingMessage, "UserLoggingMessage");
+
+    gInfoClass = fake_jni::define_class("android/content/pm/ApplicationInfo");
+    gInfoLibraryDir = fake_jni::define_field(gInfoClass, "nativeLibraryDir", "Ljava/lang/String;");
+    gContextClass = fake_jni::define_class("android/content/Context");
+    gContextInfo = fake_jni::define_field(gContextClass, "applicationInfo", "Landroid/content/pm/ApplicationInfo;");
+    fake_jni::define_method(gContextClass, "getApplicationInfo", "()Landroid/content/pm/ApplicationInfo;", [](JNIEnv* env, jobject self, const jvalue*) {
+        jvalue result;
+        result.l = env->NewLocalRef(fake_jni::get_field(self, gContextInfo).l);
+        return result;
+    });
+
+    gBatchClass = fake_jni::define_class(APP_CLASS("EventBatch"));
+    gBatchBuffer = fake_jni::define_field(gBatchClass, "buffer", "Ljava/nio/ByteBuffer;");
+    fake_jni::define_method(gBatchClass, "<init>", "(I)V", [](JNIEnv* env, jobject self, const jvalue* args) {
+        const auto capacity = args[0].i;
+        auto* memory = new uint8_t[static_cast<std::size_t>(capacity)];
+        {
+            std::lock_guard<std::mutex> lock(gBatchMemoryMutex);
+            gBatchMemory.emplace_back(memory);
+        }
+        jvalue buffer;
+        buffer.l = fake_jni::new_direct_buffer(env, "java/nio/ByteBuffer", memory, capacity);
+        fake_jni::set_field(self, gBatchBuffer, buffer);
+        env->DeleteLocalRef(buffer.l);
+        return jvalue{};
+    });
+    fake_jni::define_method(gBatchClass, "deliver", "(II)V", [](JNIEnv* env, jobject self, const jvalue* args) {
+        gBatches.fetch_add(1, std::memory_order_relaxed);
+        gBatchEvents.fetch_add(static_cast<uint64_t>(args[1].i), std::memory_order_relaxed);
+        BatchObserver observer;
+        {
+            std::lock_guard<std::mutex> lock(gObserverMutex);
+            observer = gBatchObserver;
+        }
+        if (observer) {
+            jobject buffer = fake_jni::get_field(self, gBatchBuffer).l;
+            observer(static_cast<const uint8_t*>(env->GetDirectBufferAddress(buffer)), static_cast<std::size_t>(args[0].i), args[1].i);
+        }
+        return jvalue{};
+    });
+}
+
+}
+
+JNIEnv* load() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        define_classes();
+        JNIEnv* env = fake_jni::attach();
+        if (JNI_OnLoad(fake_jni::java_vm(), nullptr) != JNI_VERSION_1_6)
+            fail("JNI_OnLoad failed");
+        if (env->ExceptionCheck())
+            fail("JNI_OnLoad left an exception pending");
+        fake_jni::return_to_java(env);
+    });
+    return fake_jni::attach();
+}
+
+jclass native_class() {
+    return gNativeClass;
+}
+
+jobject new_context(JNIEnv* env, const char* native_library_dir) {
+    jobject info = fake_jni::new_instance(env, gInfoClass);
+    jvalue value;
+    value.l = fake_jni::new_string(env, native_library_dir);
+    fake_jni::set_field(info, gInfoLibraryDir, value);
+    env->DeleteLocalRef(value.l);
+
+    jobject context = fake_jni::new_instance(env, gContextClass);
+    value.l = info;
+    fake_jni::set_field(context, gContextInfo, value);
+    env->DeleteLocalRef(info);
+    return context;
+}
+
+void set_post_observer(PostObserver observer) {
+    std::lock_guard<std::mutex> lock(gObserverMutex);
+    gPostObserver = std::move(observer);
+}
+
+jvalue event_argument(jobject event, EventType type, int index) {
+    return fake_jni::get_field(event, gEvents[type].arguments.at(static_cast<std::size_t>(index)));
+}
+
+uint64_t posted(EventType type) {
+    return gEvents[type].posted.load(std::memory_order_relaxed);
+}
+
+uint64_t posted_total() {
+    uint64_t total = 0;
+    for (const auto& event : gEvents)
+        total += event.posted.load(std::memory_order_relaxed);
+    return total;
+}
+
+jobject new_event_batch(JNIEnv* env, jint capacity) {
+    jmethodID constructor = env->GetMethodID(gBatchClass, "<init>", "(I)V");
+    return env->NewObject(gBatchClass, constructor, capacity);
+}
+
+void set_batch_observer(BatchObserver observer) {
+    std::lock_guard<std::mutex> lock(gObserverMutex);
+    gBatchObserver = std::move(observer);
+}
+
+uint64_t delivered_batches() {
+    return gBatches.load(std::memory_order_relaxed);
+}
+
+uint64_t delivered_batch_events() {
+    return gBatchEvents.load(std::memory_order_relaxed);
+}
+
+Client::Client(JNIEnv* env, int connections) : m_env(env) {
+    jobject context = new_context(env, "/data/app/host/lib");
+    const auto error = Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startInit(env, nullptr, context);
+    env->DeleteLocalRef(context);
+    if (error != 0)
+        fail("ts3client_startInit failed");
+    jstring identity = fake_jni::new_string(env, "stub-identity");
+    jstring ip = fake_jni::new_string(env, "127.0.0.1");
+    jstring nickname = fake_jni::new_string(env, "host");
+    jstring password = fake_jni::new_string(env, "");
+    for (int i = 0; i < connections; ++i) {
+        const auto connection = Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1spawnNewServerConnectionHandler(env, nullptr);
+        if (Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startConnection(env, nullptr, connection, identity, ip, 9987, nickname,
+                                                                                    nullptr, password, password) != 0)
+            fail("ts3client_startConnection failed");
+        m_connections.push_back(connection);
+    }
+    env->DeleteLocalRef(password);
+    env->DeleteLocalRef(nickname);
+    env->DeleteLocalRef(ip);
+    env->DeleteLocalRef(identity);
+}
+
+Client::~Client() {
+    for (const auto connection : m_connections) {
+        Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1stopConnection(m_env, nullptr, connection, nullptr);
+        Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1destroyServerConnectionHandler(m_env, nullptr, connection);
+    }
+    Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1destroyClientLib(m_env, nullptr);
+}
+
+}
@@ -0,0 +1,65 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * The Java side of the app as the wrapper sees it, defined in the fake VM: the Native class, the event
+ * classes of ts3sdk/events, EventBatch and an android.content.Context. load() registers the natives through
+ * JNI_OnLoad like System.loadLibrary does. Event objects count their Post calls, EventBatch its deliveries.
+ */
+#pragma once
+
+#include <jni.h>
+#include "jni_event.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace host_app {
+
+/* Defines the classes and runs JNI_OnLoad on the first call, returns the JNIEnv of the calling thread */
+JNIEnv* load();
+/* Global reference to the Native class */
+jclass native_class();
+
+/* A new local reference to a Context whose ApplicationInfo.nativeLibraryDir is native_library_dir */
+jobject new_context(JNIEnv* env, const char* native_library_dir);
+
+/* Called by Post with the event object, on the thread that delivers the event */
+using PostObserver = std::function<void(JNIEnv* env, EventType type, jobject event)>;
+void set_post_observer(PostObserver observer);
+/* Constructor argument index of an event object */
+jvalue event_argument(jobject event, EventType type, int index);
+uint64_t posted(EventType type);
+uint64_t posted_total();
+
+/* A new local reference to an EventBatch with a direct buffer of capacity bytes */
+jobject new_event_batch(JNIEnv* env, jint capacity);
+/* Called by EventBatch.deliver with the batch buffer and its used size */
+using BatchObserver = std::function<void(const uint8_t* data, std::size_t size, int count)>;
+void set_batch_observer(BatchObserver observer);
+uint64_t delivered_batches();
+uint64_t delivered_batch_events();
+
+/*
+ * The clientlib initialized through ts3client_startInit like the Native class does, with connections to
+ * the stub server. Stops the connections and destroys the clientlib again on destruction.
+ */
+class Client {
+public:
+    explicit Client(JNIEnv* env, int connections = 1);
+    ~Client();
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    jlong connection(int index = 0) const { return m_connections.at(static_cast<std::size_t>(index)); }
+    int connections() const { return static_cast<int>(m_connections.size()); }
+
+private:
+    JNIEnv* m_env;
+    std::vector<jlong> m_connections;
+};
+
+}
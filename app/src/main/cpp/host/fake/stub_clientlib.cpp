@@ -0,0 +1,436 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "stub_clientlib.h"
+#include "teamspeak/public_errors.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace {
+
+struct Connection {
+    int status = STATUS_DISCONNECTED;
+    bool self_update_pending = false;
+    uint64_t info_requests = 0;
+    std::map<std::string, std::string> preprocessor{{"name", "Speex"}, {"denoise", "true"}, {"vad", "true"},
+                                                    {"voiceactivation_level", "-50"}, {"agc", "true"}};
+    std::map<std::string, std::string> playback{{"volume_modifier", "0"}, {"volume_factor_wave", "1.0"}};
+};
+
+struct Device {
+    int capture_frequency;
+    int capture_channels;
+    int playback_frequency;
+    int playback_channels;
+    short ramp = 0;
+};
+
+std::mutex gMutex;
+ClientUIFunctions gCallbacks;
+bool gInitialized = false;
+uint64 gNextConnection = 1;
+std::map<uint64, Connection> gConnections;
+std::map<std::string, Device> gDevices;
+
+std::atomic<uint64_t> gCapturedFrames{0};
+std::atomic<uint64_t> gPlayedFrames{0};
+
+char* copy_string(const std::string& value) {
+    auto* result = static_cast<char*>(std::malloc(value.size() + 1));
+    std::memcpy(result, value.c_str(), value.size() + 1);
+    return result;
+}
+
+Connection* find_connection(uint64 serverConnectionHandlerID) {
+    const auto it = gConnections.find(serverConnectionHandlerID);
+    return it == gConnections.end() ? nullptr : &it->second;
+}
+
+bool is_client(anyID clientID) {
+    return clientID >= 1 && clientID <= stub_clientlib::server_clients;
+}
+
+/* Clients spread over the channels, the own one in the first */
+uint64 channel_of(anyID clientID) {
+    return 1 + (clientID - 1) % stub_clientlib::server_channels;
+}
+
+bool is_double_variable(std::size_t flag) {
+    return flag == CONNECTION_PING_DEVIATION || (flag >= CONNECTION_PACKETLOSS_SPEECH && flag <= CONNECTION_CLIENT2SERVER_PACKETLOSS_TOTAL);
+}
+
+bool is_address_variable(std::size_t flag) {
+    return flag == CONNECTION_CLIENT_IP || flag == CONNECTION_SERVER_IP;
+}
+
+/* Connection variables are known for the own client, for others after ts3client_requestConnectionInfo */
+unsigned int connection_variable(uint64 serverConnectionHandlerID, anyID clientID, std::size_t flag, uint64_t& requests) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    const auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection || !is_client(clientID) || flag >= CONNECTION_ENDMARKER || is_address_variable(flag))
+        return ERROR_parameter_invalid;
+    if (clientID != stub_clientlib::own_client && connection->info_requests == 0)
+        return ERROR_parameter_invalid;
+    requests = connection->info_requests;
+    return ERROR_ok;
+}
+
+void raise_status(const ClientUIFunctions& callbacks, uint64 serverConnectionHandlerID, int status) {
+    if (callbacks.onConnectStatusChangeEvent)
+        callbacks.onConnectStatusChangeEvent(serverConnectionHandlerID, status, ERROR_ok);
+}
+
+}
+
+namespace stub_clientlib {
+
+ClientUIFunctions callbacks() {
+    std::lock_guard<std::mutex> lock(gMutex);
+    return gCallbacks;
+}
+
+uint64_t captured_frames() {
+    return gCapturedFrames.load(std::memory_order_relaxed);
+}
+
+uint64_t played_frames() {
+    return gPlayedFrames.load(std::memory_order_relaxed);
+}
+
+}
+
+/* Declared by ts3client_wrapper.h, the Android clientlib keeps the VM for its audio backends */
+extern "C" void ts3client_android_initJni(void* /*java_vm*/, void* /*context*/) {}
+
+unsigned int ts3client_initClientLib(const struct ClientUIFunctions* functionPointers, const void* /*functionRarePointers*/, int /*usedLogTypes*/,
+                                     const char* /*logFileFolder*/, const char* /*resourcesFolder*/) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (gInitialized)
+        return ERROR_undefined;
+    gCallbacks = *functionPointers;
+    gInitialized = true;
+    return ERROR_ok;
+}
+
+unsigned int ts3client_destroyClientLib() {
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (!gInitialized)
+        return ERROR_undefined;
+    std::memset(&gCallbacks, 0, sizeof(gCallbacks));
+    gConnections.clear();
+    gDevices.clear();
+    gInitialized = false;
+    return ERROR_ok;
+}
+
+unsigned int ts3client_getClientLibVersion(char** result) {
+    *result = copy_string("3.3.0 [Host stub]");
+    return ERROR_ok;
+}
+
+unsigned int ts3client_freeMemory(void* pointer) {
+    std::free(pointer);
+    return ERROR_ok;
+}
+
+unsigned int ts3client_setLogVerbosity(enum LogLevel /*logVerbosity*/) {
+    return ERROR_ok;
+}
+
+unsigned int ts3client_getErrorMessage(unsigned int errorCode, char** error) {
+    char message[32];
+    std::snprintf(message, sizeof(message), "stub error 0x%04x", errorCode);
+    *error = copy_string(message);
+    return ERROR_ok;
+}
+
+unsigned int ts3client_spawnNewServerConnectionHandler(int /*port*/, uint64* result) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (!gInitialized)
+        return ERROR_undefined;
+    *result = gNextConnection++;
+    gConnections[*result];
+    return ERROR_ok;
+}
+
+unsigned int ts3client_destroyServerConnectionHandler(uint64 serverConnectionHandlerID) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    return gConnections.erase(serverConnectionHandlerID) ? ERROR_ok : ERROR_parameter_invalid;
+}
+
+unsigned int ts3client_createIdentity(char** result) {
+    static std::atomic<unsigned int> identities{0};
+    *result = copy_string("stub-identity-" + std::to_string(identities.fetch_add(1, std::memory_order_relaxed)));
+    return ERROR_ok;
+}
+
+unsigned int ts3client_startConnection(uint64 serverConnectionHandlerID, const char* identity, const char* ip, unsigned int /*port*/, const char* nickname,
+                                       const char** defaultChannelArray, const char* /*defaultChannelPassword*/, const char* /*serverPassword*/) {
+    ClientUIFunctions callbacks;
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        auto* connection = find_connection(serverConnectionHandlerID);
+        if (!connection || !identity || !ip || !nickname || !defaultChannelArray)
+            return ERROR_parameter_invalid;
+        if (connection->status != STATUS_DISCONNECTED)
+            return ERROR_undefined;
+        connection->status = STATUS_CONNECTION_ESTABLISHED;
+        callbacks = gCallbacks;
+    }
+
+    // The clientlib raises these on its own threads, outside of any lock the caller could hold
+    raise_status(callbacks, serverConnectionHandlerID, STATUS_CONNECTING);
+    raise_status(callbacks, serverConnectionHandlerID, STATUS_CONNECTED);
+    raise_status(callbacks, serverConnectionHandlerID, STATUS_CONNECTION_ESTABLISHING);
+    for (uint64 channel = 1; channel <= stub_clientlib::server_channels; ++channel) {
+        if (callbacks.onNewChannelEvent)
+            callbacks.onNewChannelEvent(serverConnectionHandlerID, channel, channel <= stub_clientlib::server_channels / 2 ? 0 : channel - stub_clientlib::server_channels / 2);
+    }
+    for (anyID client = 1; client <= stub_clientlib::server_clients; ++client) {
+        if (callbacks.onClientMoveEvent)
+            callbacks.onClientMoveEvent(serverConnectionHandlerID, client, 0, channel_of(client), ENTER_VISIBILITY, "");
+    }
+    raise_status(callbacks, serverConnectionHandlerID, STATUS_CONNECTION_ESTABLISHED);
+    return ERROR_ok;
+}
+
+unsigned int ts3client_stopConnection(uint64 serverConnectionHandlerID, const char* /*quitMessage*/) {
+    ClientUIFunctions callbacks;
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        auto* connection = find_connection(serverConnectionHandlerID);
+        if (!connection)
+            return ERROR_parameter_invalid;
+        if (connection->status == STATUS_DISCONNECTED)
+            return ERROR_ok;
+        connection->status = STATUS_DISCONNECTED;
+        connection->info_requests = 0;
+        callbacks = gCallbacks;
+    }
+    raise_status(callbacks, serverConnectionHandlerID, STATUS_DISCONNECTED);
+    return ERROR_ok;
+}
+
+unsigned int ts3client_getConnectionStatus(uint64 serverConnectionHandlerID, int* result) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    const auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection)
+        return ERROR_parameter_invalid;
+    *result = connection->status;
+    return ERROR_ok;
+}
+
+unsigned int ts3client_registerCustomDevice(const char* deviceID, const char* /*deviceDisplayName*/, int capFrequency, int capChannels, int playFrequency, int playChannels) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (!deviceID || !*deviceID || capChannels < 0 || capChannels > 2 || playChannels < 0 || playChannels > 2)
+        return ERROR_parameter_invalid;
+    if (!gDevices.emplace(deviceID, Device{capFrequency, capChannels, playFrequency, playChannels}).second)
+        return ERROR_undefined;
+    return ERROR_ok;
+}
+
+unsigned int ts3client_unregisterCustomDevice(const char* deviceID) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    return deviceID && gDevices.erase(deviceID) ? ERROR_ok : ERROR_parameter_invalid;
+}
+
+unsigned int ts3client_processCustomCaptureData(const char* deviceName, const short* buffer, int samples) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    const auto it = deviceName ? gDevices.find(deviceName) : gDevices.end();
+    if (it == gDevices.end() || !buffer || samples < 0)
+        return ERROR_parameter_invalid;
+    gCapturedFrames.fetch_add(static_cast<uint64_t>(samples), std::memory_order_relaxed);
+    return ERROR_ok;
+}
+
+unsigned int ts3client_acquireCustomPlaybackData(const char* deviceName, short* buffer, int samples) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    const auto it = deviceName ? gDevices.find(deviceName) : gDevices.end();
+    if (it == gDevices.end() || !buffer || samples < 0)
+        return ERROR_parameter_invalid;
+    auto& device = it->second;
+    for (int frame = 0; frame < samples; ++frame) {
+        for (int channel = 0; channel < device.playback_channels; ++channel)
+            buffer[frame * device.playback_channels + channel] = device.ramp;
+        device.ramp = static_cast<short>(device.ramp + 64);
+    }
+    gPlayedFrames.fetch_add(static_cast<uint64_t>(samples), std::memory_order_relaxed);
+    return ERROR_ok;
+}
+
+static unsigned int deviceCall(uint64 serverConnectionHandlerID) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    return find_connection(serverConnectionHandlerID) ? ERROR_ok : ERROR_parameter_invalid;
+}
+
+unsigned int ts3client_openCaptureDevice(uint64 serverConnectionHandlerID, const char* /*modeID*/, const char* /*captureDevice*/) {
+    return deviceCall(serverConnectionHandlerID);
+}
+
+unsigned int ts3client_openPlaybackDevice(uint64 serverConnectionHandlerID, const char* /*modeID*/, const char* /*playbackDevice*/) {
+    return deviceCall(serverConnectionHandlerID);
+}
+
+unsigned int ts3client_closeCaptureDevice(uint64 serverConnectionHandlerID) {
+    return deviceCall(serverConnectionHandlerID);
+}
+
+unsigned int ts3client_closePlaybackDevice(uint64 serverConnectionHandlerID) {
+    return deviceCall(serverConnectionHandlerID);
+}
+
+unsigned int ts3client_activateCaptureDevice(uint64 serverConnectionHandlerID) {
+    return deviceCall(serverConnectionHandlerID);
+}
+
+unsigned int ts3client_setPreProcessorConfigValue(uint64 serverConnectionHandlerID, const char* ident, const char* value) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection || !ident || !value)
+        return ERROR_parameter_invalid;
+    connection->preprocessor[ident] = value;
+    return ERROR_ok;
+}
+
+unsigned int ts3client_getPreProcessorConfigValue(uint64 serverConnectionHandlerID, const char* ident, char** result) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    auto* connection = find_connection(serverConnectionHandlerID);
+    const auto it = connection && ident ? connection->preprocessor.find(ident) : std::map<std::string, std::string>::iterator();
+    if (!connection || !ident || it == connection->preprocessor.end())
+        return ERROR_parameter_invalid;
+    *result = copy_string(it->second);
+    return ERROR_ok;
+}
+
+unsigned int ts3client_setPlaybackConfigValue(uint64 serverConnectionHandlerID, const char* ident, const char* value) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection || !ident || !value)
+        return ERROR_parameter_invalid;
+    connection->playback[ident] = value;
+    return ERROR_ok;
+}
+
+unsigned int ts3client_getPlaybackConfigValueAsFloat(uint64 serverConnectionHandlerID, const char* ident, float* result) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    auto* connection = find_connection(serverConnectionHandlerID);
+    const auto it = connection && ident ? connection->playback.find(ident) : std::map<std::string, std::string>::iterator();
+    if (!connection || !ident || it == connection->playback.end())
+        return ERROR_parameter_invalid;
+    *result = std::strtof(it->second.c_str(), nullptr);
+    return ERROR_ok;
+}
+
+unsigned int ts3client_setClientSelfVariableAsInt(uint64 serverConnectionHandlerID, size_t flag, int /*value*/) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection || flag >= CLIENT_ENDMARKER)
+        return ERROR_parameter_invalid;
+    connection->self_update_pending = true;
+    return ERROR_ok;
+}
+
+unsigned int ts3client_flushClientSelfUpdates(uint64 serverConnectionHandlerID, const char* /*returnCode*/) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection)
+        return ERROR_parameter_invalid;
+    const bool pending = connection->self_update_pending;
+    connection->self_update_pending = false;
+    return pending ? ERROR_ok : ERROR_ok_no_update;
+}
+
+unsigned int ts3client_getClientID(uint64 serverConnectionHandlerID, anyID* result) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    const auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection || connection->status != STATUS_CONNECTION_ESTABLISHED)
+        return ERROR_parameter_invalid;
+    *result = stub_clientlib::own_client;
+    return ERROR_ok;
+}
+
+unsigned int ts3client_getClientList(uint64 serverConnectionHandlerID, anyID** result) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    const auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection || connection->status != STATUS_CONNECTION_ESTABLISHED)
+        return ERROR_parameter_invalid;
+    auto* list = static_cast<anyID*>(std::malloc((stub_clientlib::server_clients + 1) * sizeof(anyID)));
+    for (anyID client = 1; client <= stub_clientlib::server_clients; ++client)
+        list[client - 1] = client;
+    list[stub_clientlib::server_clients] = 0;
+    *result = list;
+    return ERROR_ok;
+}
+
+unsigned int ts3client_getClientVariableAsInt(uint64 serverConnectionHandlerID, anyID clientID, size_t flag, int* result) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    const auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection || !is_client(clientID) || flag >= CLIENT_ENDMARKER)
+        return ERROR_parameter_invalid;
+    *result = static_cast<int>(clientID * 100 + flag);
+    return ERROR_ok;
+}
+
+unsigned int ts3client_getClientVariableAsString(uint64 serverConnectionHandlerID, anyID clientID, size_t flag, char** result) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    const auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection || !is_client(clientID) || flag >= CLIENT_ENDMARKER)
+        return ERROR_parameter_invalid;
+    const auto id = std::to_string(clientID);
+    switch (flag) {
+        case CLIENT_NICKNAME: *result = copy_string("Client " + id); break;
+        case CLIENT_UNIQUE_IDENTIFIER: *result = copy_string("stub-uid-" + id + "="); break;
+        default: *result = copy_string(id + "/" + std::to_string(flag)); break;
+    }
+    return ERROR_ok;
+}
+
+unsigned int ts3client_getChannelVariableAsString(uint64 serverConnectionHandlerID, uint64 channelID, size_t flag, char** result) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    const auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection || channelID < 1 || channelID > stub_clientlib::server_channels || flag >= CHANNEL_ENDMARKER)
+        return ERROR_parameter_invalid;
+    const auto id = std::to_string(channelID);
+    *result = copy_string(flag == CHANNEL_NAME ? "Channel " + id : id + "/" + std::to_string(flag));
+    return ERROR_ok;
+}
+
+unsigned int ts3client_getConnectionVariableAsDouble(uint64 serverConnectionHandlerID, anyID clientID, size_t flag, double* result) {
+    uint64_t requests;
+    const auto error = connection_variable(serverConnectionHandlerID, clientID, flag, requests);
+    if (error != ERROR_ok)
+        return error;
+    if (!is_double_variable(flag))
+        return ERROR_parameter_invalid;
+    *result = static_cast<double>(clientID % 10 + flag % 10 + requests % 7) / 100.0;
+    return ERROR_ok;
+}
+
+unsigned int ts3client_getConnectionVariableAsUInt64(uint64 serverConnectionHandlerID, anyID clientID, size_t flag, uint64* result) {
+    uint64_t requests;
+    const auto error = connection_variable(serverConnectionHandlerID, clientID, flag, requests);
+    if (error != ERROR_ok)
+        return error;
+    if (is_double_variable(flag))
+        return ERROR_parameter_invalid;
+    *result = static_cast<uint64>(clientID) * 1000 + flag * 10 + requests;
+    return ERROR_ok;
+}
+
+unsigned int ts3client_requestConnectionInfo(uint64 serverConnectionHandlerID, anyID clientID, const char* /*returnCode*/) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    auto* connection = find_connection(serverConnectionHandlerID);
+    if (!connection || !is_client(clientID))
+        return ERROR_parameter_invalid;
+    ++connection->info_requests;
+    return ERROR_ok;
+}
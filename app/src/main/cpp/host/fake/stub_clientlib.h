@@ -0,0 +1,32 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Stand-in libts3client of the host build. Every connection reaches the same small server at once:
+ * ts3client_startConnection raises the connect status changes, a NewChannel event per channel and a
+ * ClientMove per client on the calling thread, ts3client_stopConnection the disconnect. Custom devices
+ * consume capture data and play a ramp. The callbacks registered by ts3client_initClientLib are available
+ * to drive the wrapper directly, as the clientlib threads would.
+ */
+#pragma once
+
+#include "teamspeak/clientlib.h"
+
+#include <cstdint>
+
+namespace stub_clientlib {
+
+/* Channels 1..server_channels, clients 1..server_clients, the own client is 1 */
+constexpr uint64 server_channels = 8;
+constexpr anyID server_clients = 32;
+constexpr anyID own_client = 1;
+
+/* The callbacks of ts3client_initClientLib, all null before and after ts3client_destroyClientLib */
+ClientUIFunctions callbacks();
+
+/* Frames passed to ts3client_processCustomCaptureData and taken by ts3client_acquireCustomPlaybackData */
+uint64_t captured_frames();
+uint64_t played_frames();
+
+}
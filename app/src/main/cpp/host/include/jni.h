@@ -0,0 +1,177 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * jni.h of the host build. Declares the part of the JNI the wrapper uses, with the types and signatures of
+ * the NDK header, implemented in process by the fake VM in host/fake/fake_jni.cpp. The object types carry
+ * the bookkeeping of that VM, nothing else may touch it.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+
+#define JNIEXPORT __attribute__((visibility("default")))
+#define JNICALL
+
+#define JNI_VERSION_1_6 0x00010006
+
+#define JNI_OK 0
+#define JNI_ERR (-1)
+#define JNI_EDETACHED (-2)
+#define JNI_EVERSION (-3)
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+
+typedef uint8_t jboolean;
+typedef int8_t jbyte;
+typedef uint16_t jchar;
+typedef int16_t jshort;
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef float jfloat;
+typedef double jdouble;
+typedef jint jsize;
+
+class _jclass;
+
+class _jobject {
+public:
+    virtual ~_jobject() = default;
+
+    /* Fake VM: references to the object, it is deleted with the last one */
+    std::atomic<int> fake_references{0};
+    _jclass* fake_class = nullptr;
+};
+class _jclass : public _jobject {};
+class _jstring : public _jobject {};
+class _jarray : public _jobject {};
+class _jobjectArray : public _jarray {};
+class _jbooleanArray : public _jarray {};
+class _jbyteArray : public _jarray {};
+class _jcharArray : public _jarray {};
+class _jshortArray : public _jarray {};
+class _jintArray : public _jarray {};
+class _jlongArray : public _jarray {};
+class _jfloatArray : public _jarray {};
+class _jdoubleArray : public _jarray {};
+class _jthrowable : public _jobject {};
+
+typedef _jobject* jobject;
+typedef _jclass* jclass;
+typedef _jstring* jstring;
+typedef _jarray* jarray;
+typedef _jobjectArray* jobjectArray;
+typedef _jbooleanArray* jbooleanArray;
+typedef _jbyteArray* jbyteArray;
+typedef _jcharArray* jcharArray;
+typedef _jshortArray* jshortArray;
+typedef _jintArray* jintArray;
+typedef _jlongArray* jlongArray;
+typedef _jfloatArray* jfloatArray;
+typedef _jdoubleArray* jdoubleArray;
+typedef _jthrowable* jthrowable;
+
+struct _jfieldID;
+typedef struct _jfieldID* jfieldID;
+struct _jmethodID;
+typedef struct _jmethodID* jmethodID;
+
+typedef union jvalue {
+    jboolean z;
+    jbyte b;
+    jchar c;
+    jshort s;
+    jint i;
+    jlong j;
+    jfloat f;
+    jdouble d;
+    jobject l;
+} jvalue;
+
+typedef struct {
+    const char* name;
+    const char* signature;
+    void* fnPtr;
+} JNINativeMethod;
+
+struct _JNIEnv;
+struct _JavaVM;
+typedef _JNIEnv JNIEnv;
+typedef _JavaVM JavaVM;
+
+struct JavaVMAttachArgs {
+    jint version;
+    const char* name;
+    jobject group;
+};
+
+struct _JNIEnv {
+    jclass FindClass(const char* name);
+    jclass GetObjectClass(jobject obj);
+
+    jint ThrowNew(jclass cls, const char* message);
+    jboolean ExceptionCheck();
+    void ExceptionDescribe();
+    void ExceptionClear();
+
+    jint PushLocalFrame(jint capacity);
+    jobject PopLocalFrame(jobject result);
+    jobject NewGlobalRef(jobject obj);
+    void DeleteGlobalRef(jobject obj);
+    jobject NewLocalRef(jobject obj);
+    void DeleteLocalRef(jobject obj);
+
+    jobject NewObject(jclass cls, jmethodID constructor, ...);
+    jobject NewObjectA(jclass cls, jmethodID constructor, const jvalue* args);
+
+    jmethodID GetMethodID(jclass cls, const char* name, const char* signature);
+    jobject CallObjectMethod(jobject obj, jmethodID method, ...);
+    void CallVoidMethod(jobject obj, jmethodID method, ...);
+
+    jfieldID GetFieldID(jclass cls, const char* name, const char* signature);
+    jobject GetObjectField(jobject obj, jfieldID field);
+
+    jstring NewStringUTF(const char* bytes);
+    jsize GetStringLength(jstring string);
+    jsize GetStringUTFLength(jstring string);
+    void GetStringUTFRegion(jstring string, jsize start, jsize length, char* buffer);
+
+    jsize GetArrayLength(jarray array);
+    jobjectArray NewObjectArray(jsize length, jclass element_class, jobject initial);
+    jobject GetObjectArrayElement(jobjectArray array, jsize index);
+    void SetObjectArrayElement(jobjectArray array, jsize index, jobject value);
+
+    jbyteArray NewByteArray(jsize length);
+    jintArray NewIntArray(jsize length);
+    jlongArray NewLongArray(jsize length);
+    jdoubleArray NewDoubleArray(jsize length);
+    void GetByteArrayRegion(jbyteArray array, jsize start, jsize length, jbyte* buffer);
+    void GetIntArrayRegion(jintArray array, jsize start, jsize length, jint* buffer);
+    void GetLongArrayRegion(jlongArray array, jsize start, jsize length, jlong* buffer);
+    void GetDoubleArrayRegion(jdoubleArray array, jsize start, jsize length, jdouble* buffer);
+    void SetByteArrayRegion(jbyteArray array, jsize start, jsize length, const jbyte* buffer);
+    void SetIntArrayRegion(jintArray array, jsize start, jsize length, const jint* buffer);
+    void SetLongArrayRegion(jlongArray array, jsize start, jsize length, const jlong* buffer);
+    void SetDoubleArrayRegion(jdoubleArray array, jsize start, jsize length, const jdouble* buffer);
+
+    jint RegisterNatives(jclass cls, const JNINativeMethod* methods, jint count);
+
+    jint GetJavaVM(JavaVM** vm);
+
+    jobject NewDirectByteBuffer(void* address, jlong capacity);
+    void* GetDirectBufferAddress(jobject buffer);
+    jlong GetDirectBufferCapacity(jobject buffer);
+};
+
+struct _JavaVM {
+    jint DestroyJavaVM();
+    jint AttachCurrentThread(JNIEnv** env, void* args);
+    jint DetachCurrentThread();
+    jint GetEnv(void** env, jint version);
+};
+
+extern "C" JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved);
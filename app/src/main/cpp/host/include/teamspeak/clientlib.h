@@ -0,0 +1,82 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Host build stand-in for the SDK header of the same name: the callbacks and functions of the clientlib the
+ * wrapper uses, with the SDK signatures. host/fake/stub_clientlib.cpp implements them.
+ */
+#pragma once
+
+#include "public_definitions.h"
+
+#include <cstddef>
+
+struct ClientUIFunctions {
+    void (*onConnectStatusChangeEvent)(uint64 serverConnectionHandlerID, int newStatus, unsigned int errorNumber);
+    void (*onServerProtocolVersionEvent)(uint64 serverConnectionHandlerID, int protocolVersion);
+    void (*onNewChannelEvent)(uint64 serverConnectionHandlerID, uint64 channelID, uint64 channelParentID);
+    void (*onNewChannelCreatedEvent)(uint64 serverConnectionHandlerID, uint64 channelID, uint64 channelParentID, anyID invokerID, const char* invokerName, const char* invokerUniqueIdentifier);
+    void (*onDelChannelEvent)(uint64 serverConnectionHandlerID, uint64 channelID, anyID invokerID, const char* invokerName, const char* invokerUniqueIdentifier);
+    void (*onChannelMoveEvent)(uint64 serverConnectionHandlerID, uint64 channelID, uint64 newChannelParentID, anyID invokerID, const char* invokerName, const char* invokerUniqueIdentifier);
+    void (*onUpdateChannelEvent)(uint64 serverConnectionHandlerID, uint64 channelID);
+    void (*onUpdateChannelEditedEvent)(uint64 serverConnectionHandlerID, uint64 channelID, anyID invokerID, const char* invokerName, const char* invokerUniqueIdentifier);
+    void (*onUpdateClientEvent)(uint64 serverConnectionHandlerID, anyID clientID, anyID invokerID, const char* invokerName, const char* invokerUniqueIdentifier);
+    void (*onClientMoveEvent)(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, const char* moveMessage);
+    void (*onClientMoveSubscriptionEvent)(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility);
+    void (*onClientMoveTimeoutEvent)(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, const char* timeoutMessage);
+    void (*onClientMoveMovedEvent)(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, anyID moverID, const char* moverName, const char* moverUniqueIdentifier, const char* moveMessage);
+    void (*onTalkStatusChangeEvent)(uint64 serverConnectionHandlerID, int status, int isReceivedWhisper, anyID clientID);
+    void (*onServerErrorEvent)(uint64 serverConnectionHandlerID, const char* errorMessage, unsigned int error, const char* returnCode, const char* extraMessage);
+    void (*onUserLoggingMessageEvent)(const char* logmessage, int logLevel, const char* logChannel, uint64 logID, const char* logTime, const char* completeLogString);
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+unsigned int ts3client_initClientLib(const struct ClientUIFunctions* functionPointers, const void* functionRarePointers, int usedLogTypes, const char* logFileFolder, const char* resourcesFolder);
+unsigned int ts3client_destroyClientLib();
+unsigned int ts3client_getClientLibVersion(char** result);
+unsigned int ts3client_freeMemory(void* pointer);
+unsigned int ts3client_setLogVerbosity(enum LogLevel logVerbosity);
+unsigned int ts3client_getErrorMessage(unsigned int errorCode, char** error);
+
+unsigned int ts3client_spawnNewServerConnectionHandler(int port, uint64* result);
+unsigned int ts3client_destroyServerConnectionHandler(uint64 serverConnectionHandlerID);
+unsigned int ts3client_createIdentity(char** result);
+unsigned int ts3client_startConnection(uint64 serverConnectionHandlerID, const char* identity, const char* ip, unsigned int port, const char* nickname,
+                                       const char** defaultChannelArray, const char* defaultChannelPassword, const char* serverPassword);
+unsigned int ts3client_stopConnection(uint64 serverConnectionHandlerID, const char* quitMessage);
+unsigned int ts3client_getConnectionStatus(uint64 serverConnectionHandlerID, int* result);
+
+unsigned int ts3client_registerCustomDevice(const char* deviceID, const char* deviceDisplayName, int capFrequency, int capChannels, int playFrequency, int playChannels);
+unsigned int ts3client_unregisterCustomDevice(const char* deviceID);
+unsigned int ts3client_processCustomCaptureData(const char* deviceName, const short* buffer, int samples);
+unsigned int ts3client_acquireCustomPlaybackData(const char* deviceName, short* buffer, int samples);
+unsigned int ts3client_openCaptureDevice(uint64 serverConnectionHandlerID, const char* modeID, const char* captureDevice);
+unsigned int ts3client_openPlaybackDevice(uint64 serverConnectionHandlerID, const char* modeID, const char* playbackDevice);
+unsigned int ts3client_closeCaptureDevice(uint64 serverConnectionHandlerID);
+unsigned int ts3client_closePlaybackDevice(uint64 serverConnectionHandlerID);
+unsigned int ts3client_activateCaptureDevice(uint64 serverConnectionHandlerID);
+
+unsigned int ts3client_setPreProcessorConfigValue(uint64 serverConnectionHandlerID, const char* ident, const char* value);
+unsigned int ts3client_getPreProcessorConfigValue(uint64 serverConnectionHandlerID, const char* ident, char** result);
+unsigned int ts3client_setPlaybackConfigValue(uint64 serverConnectionHandlerID, const char* ident, const char* value);
+unsigned int ts3client_getPlaybackConfigValueAsFloat(uint64 serverConnectionHandlerID, const char* ident, float* result);
+
+unsigned int ts3client_setClientSelfVariableAsInt(uint64 serverConnectionHandlerID, size_t flag, int value);
+unsigned int ts3client_flushClientSelfUpdates(uint64 serverConnectionHandlerID, const char* returnCode);
+unsigned int ts3client_getClientID(uint64 serverConnectionHandlerID, anyID* result);
+unsigned int ts3client_getClientList(uint64 serverConnectionHandlerID, anyID** result);
+unsigned int ts3client_getClientVariableAsInt(uint64 serverConnectionHandlerID, anyID clientID, size_t flag, int* result);
+unsigned int ts3client_getClientVariableAsString(uint64 serverConnectionHandlerID, anyID clientID, size_t flag, char** result);
+unsigned int ts3client_getChannelVariableAsString(uint64 serverConnectionHandlerID, uint64 channelID, size_t flag, char** result);
+
+unsigned int ts3client_getConnectionVariableAsDouble(uint64 serverConnectionHandlerID, anyID clientID, size_t flag, double* result);
+unsigned int ts3client_getConnectionVariableAsUInt64(uint64 serverConnectionHandlerID, anyID clientID, size_t flag, uint64* result);
+unsigned int ts3client_requestConnectionInfo(uint64 serverConnectionHandlerID, anyID clientID, const char* returnCode);
+
+#ifdef __cplusplus
+}
+#endif
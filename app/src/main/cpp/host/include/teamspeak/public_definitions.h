@@ -0,0 +1,155 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Host build stand-in for the SDK header of the same name: the types and enums the wrapper uses, with the
+ * values of the SDK.
+ */
+#pragma once
+
+#include <cstdint>
+
+typedef uint64_t uint64;
+typedef unsigned short anyID;
+
+enum LogLevel {
+    LogLevel_CRITICAL = 0,
+    LogLevel_ERROR,
+    LogLevel_WARNING,
+    LogLevel_DEBUG,
+    LogLevel_INFO,
+    LogLevel_DEVEL
+};
+
+enum LogTypes {
+    LogType_NONE = 0x0000,
+    LogType_FILE = 0x0001,
+    LogType_CONSOLE = 0x0002,
+    LogType_USERLOGGING = 0x0004,
+    LogType_NO_NETLOGGING = 0x0008,
+    LogType_DATABASE = 0x0010,
+    LogType_SYSLOG = 0x0020
+};
+
+enum ConnectStatus {
+    STATUS_DISCONNECTED = 0,
+    STATUS_CONNECTING,
+    STATUS_CONNECTED,
+    STATUS_CONNECTION_ESTABLISHING,
+    STATUS_CONNECTION_ESTABLISHED
+};
+
+enum TalkStatus {
+    STATUS_NOT_TALKING = 0,
+    STATUS_TALKING = 1,
+    STATUS_TALKING_WHILE_DISABLED = 2
+};
+
+enum Visibility {
+    ENTER_VISIBILITY = 0,
+    RETAIN_VISIBILITY,
+    LEAVE_VISIBILITY
+};
+
+enum ChannelProperties {
+    CHANNEL_NAME = 0,
+    CHANNEL_TOPIC,
+    CHANNEL_DESCRIPTION,
+    CHANNEL_PASSWORD,
+    CHANNEL_CODEC,
+    CHANNEL_CODEC_QUALITY,
+    CHANNEL_MAXCLIENTS,
+    CHANNEL_MAXFAMILYCLIENTS,
+    CHANNEL_ORDER,
+    CHANNEL_FLAG_PERMANENT,
+    CHANNEL_FLAG_SEMI_PERMANENT,
+    CHANNEL_FLAG_DEFAULT,
+    CHANNEL_FLAG_PASSWORD,
+    CHANNEL_CODEC_LATENCY_FACTOR,
+    CHANNEL_CODEC_IS_UNENCRYPTED,
+    CHANNEL_SECURITY_SALT,
+    CHANNEL_DELETE_DELAY,
+    CHANNEL_ENDMARKER
+};
+
+enum ClientProperties {
+    CLIENT_UNIQUE_IDENTIFIER = 0,
+    CLIENT_NICKNAME,
+    CLIENT_VERSION,
+    CLIENT_PLATFORM,
+    CLIENT_FLAG_TALKING,
+    CLIENT_INPUT_MUTED,
+    CLIENT_OUTPUT_MUTED,
+    CLIENT_OUTPUTONLY_MUTED,
+    CLIENT_INPUT_HARDWARE,
+    CLIENT_OUTPUT_HARDWARE,
+    CLIENT_INPUT_DEACTIVATED,
+    CLIENT_IDLE_TIME,
+    CLIENT_DEFAULT_CHANNEL,
+    CLIENT_DEFAULT_CHANNEL_PASSWORD,
+    CLIENT_SERVER_PASSWORD,
+    CLIENT_META_DATA,
+    CLIENT_IS_MUTED,
+    CLIENT_IS_RECORDING,
+    CLIENT_VOLUME_MODIFICATOR,
+    CLIENT_VERSION_SIGN,
+    CLIENT_SECURITY_HASH,
+    CLIENT_ENDMARKER
+};
+
+enum ConnectionProperties {
+    CONNECTION_PING = 0,
+    CONNECTION_PING_DEVIATION,
+    CONNECTION_CONNECTED_TIME,
+    CONNECTION_IDLE_TIME,
+    CONNECTION_CLIENT_IP,
+    CONNECTION_CLIENT_PORT,
+    CONNECTION_SERVER_IP,
+    CONNECTION_SERVER_PORT,
+    CONNECTION_PACKETS_SENT_SPEECH,
+    CONNECTION_PACKETS_SENT_KEEPALIVE,
+    CONNECTION_PACKETS_SENT_CONTROL,
+    CONNECTION_PACKETS_SENT_TOTAL,
+    CONNECTION_BYTES_SENT_SPEECH,
+    CONNECTION_BYTES_SENT_KEEPALIVE,
+    CONNECTION_BYTES_SENT_CONTROL,
+    CONNECTION_BYTES_SENT_TOTAL,
+    CONNECTION_PACKETS_RECEIVED_SPEECH,
+    CONNECTION_PACKETS_RECEIVED_KEEPALIVE,
+    CONNECTION_PACKETS_RECEIVED_CONTROL,
+    CONNECTION_PACKETS_RECEIVED_TOTAL,
+    CONNECTION_BYTES_RECEIVED_SPEECH,
+    CONNECTION_BYTES_RECEIVED_KEEPALIVE,
+    CONNECTION_BYTES_RECEIVED_CONTROL,
+    CONNECTION_BYTES_RECEIVED_TOTAL,
+    CONNECTION_PACKETLOSS_SPEECH,
+    CONNECTION_PACKETLOSS_KEEPALIVE,
+    CONNECTION_PACKETLOSS_CONTROL,
+    CONNECTION_PACKETLOSS_TOTAL,
+    CONNECTION_SERVER2CLIENT_PACKETLOSS_SPEECH,
+    CONNECTION_SERVER2CLIENT_PACKETLOSS_KEEPALIVE,
+    CONNECTION_SERVER2CLIENT_PACKETLOSS_CONTROL,
+    CONNECTION_SERVER2CLIENT_PACKETLOSS_TOTAL,
+    CONNECTION_CLIENT2SERVER_PACKETLOSS_SPEECH,
+    CONNECTION_CLIENT2SERVER_PACKETLOSS_KEEPALIVE,
+    CONNECTION_CLIENT2SERVER_PACKETLOSS_CONTROL,
+    CONNECTION_CLIENT2SERVER_PACKETLOSS_TOTAL,
+    CONNECTION_BANDWIDTH_SENT_LAST_SECOND_SPEECH,
+    CONNECTION_BANDWIDTH_SENT_LAST_SECOND_KEEPALIVE,
+    CONNECTION_BANDWIDTH_SENT_LAST_SECOND_CONTROL,
+    CONNECTION_BANDWIDTH_SENT_LAST_SECOND_TOTAL,
+    CONNECTION_BANDWIDTH_SENT_LAST_MINUTE_SPEECH,
+    CONNECTION_BANDWIDTH_SENT_LAST_MINUTE_KEEPALIVE,
+    CONNECTION_BANDWIDTH_SENT_LAST_MINUTE_CONTROL,
+    CONNECTION_BANDWIDTH_SENT_LAST_MINUTE_TOTAL,
+    CONNECTION_BANDWIDTH_RECEIVED_LAST_SECOND_SPEECH,
+    CONNECTION_BANDWIDTH_RECEIVED_LAST_SECOND_KEEPALIVE,
+    CONNECTION_BANDWIDTH_RECEIVED_LAST_SECOND_CONTROL,
+    CONNECTION_BANDWIDTH_RECEIVED_LAST_SECOND_TOTAL,
+    CONNECTION_BANDWIDTH_RECEIVED_LAST_MINUTE_SPEECH,
+    CONNECTION_BANDWIDTH_RECEIVED_LAST_MINUTE_KEEPALIVE,
+    CONNECTION_BANDWIDTH_RECEIVED_LAST_MINUTE_CONTROL,
+    CONNECTION_BANDWIDTH_RECEIVED_LAST_MINUTE_TOTAL,
+    CONNECTION_ENDMARKER
+};
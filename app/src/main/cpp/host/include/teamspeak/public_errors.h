@@ -0,0 +1,18 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Host build stand-in for the SDK header of the same name, the error codes the wrapper and the stub
+ * clientlib use.
+ */
+#pragma once
+
+enum Ts3ErrorType {
+    ERROR_ok = 0x0000,
+    ERROR_undefined = 0x0001,
+    ERROR_not_implemented = 0x0002,
+    ERROR_ok_no_update = 0x0003,
+    ERROR_parameter_invalid_count = 0x0601,
+    ERROR_parameter_invalid = 0x0602
+};
@@ -0,0 +1,49 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Host test runner. TEST(name) registers a test, CHECK fails it and continues, REQUIRE fails it and
+ * returns. Tests run in registration order on a thread attached to the fake VM.
+ */
+#pragma once
+
+#include <jni.h>
+
+#include <cstdio>
+
+class Test {
+public:
+    using Body = void (*)(JNIEnv* env);
+
+    Test(const char* name, Body body);
+
+    const char* name() const { return m_name; }
+    Body body() const { return m_body; }
+
+    /* Reports a failed check of the running test */
+    static void fail(const char* file, int line, const char* expression);
+
+private:
+    const char* m_name;
+    Body m_body;
+};
+
+#define TEST(name) \
+    static void test_##name(JNIEnv* env); \
+    static const Test test_##name##_registration(#name, test_##name); \
+    static void test_##name(JNIEnv* env)
+
+#define CHECK(expression) \
+    do { \
+        if (!(expression)) \
+            Test::fail(__FILE__, __LINE__, #expression); \
+    } while (0)
+
+#define REQUIRE(expression) \
+    do { \
+        if (!(expression)) { \
+            Test::fail(__FILE__, __LINE__, #expression); \
+            return; \
+        } \
+    } while (0)
@@ -0,0 +1,63 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * JavaAudioStream slots reopened with another format, like a custom device registered again in the same slot.
+ */
+#include "test.h"
+#include "audio_backend.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+AudioBackend::Format format(int frequency, int channels) {
+    AudioBackend::Format result;
+    result.capture_frequency = frequency;
+    result.capture_channels = channels;
+    result.playback_frequency = frequency;
+    result.playback_channels = channels;
+    result.period_ms = 20;
+    return result;
+}
+
+/* Writes a second of capture and half a second of playback, checks that all of it comes back in order */
+void checkRoundTrip(JavaAudioStream& stream, int frequency, int channels) {
+    const auto frames = static_cast<std::size_t>(frequency);
+    std::vector<short> written(frames * channels);
+    for (std::size_t i = 0; i < written.size(); ++i)
+        written[i] = static_cast<short>(i);
+    std::vector<short> read(written.size());
+
+    CHECK(stream.capture.capacity() >= frames);
+    CHECK(stream.capture.write(written.data(), frames) == frames);
+    CHECK(stream.capture.read(read.data(), frames) == frames);
+    CHECK(read == written);
+
+    const auto playback_frames = frames / 2;
+    stream.playback.write(written.data(), playback_frames);
+    CHECK(stream.playback.read(read.data(), playback_frames) == playback_frames);
+    CHECK(std::equal(read.begin(), read.begin() + playback_frames * channels, written.begin()));
+}
+
+}
+
+TEST(audio_stream_reopens_with_bigger_format) {
+    JavaAudioStream stream;
+    AudioLatency latency;
+    JavaStreamBackend backend(stream, latency);
+
+    REQUIRE(backend.open(format(16000, 1)));
+    checkRoundTrip(stream, 16000, 1);
+    backend.close();
+
+    REQUIRE(backend.open(format(48000, 2)));
+    checkRoundTrip(stream, 48000, 2);
+    backend.close();
+
+    REQUIRE(backend.open(format(16000, 1)));
+    checkRoundTrip(stream, 16000, 1);
+    backend.close();
+}
@@ -0,0 +1,116 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * CustomDeviceTable under concurrent registration: readers on several threads must only ever see whole
+ * devices, and a snapshot must stay unchanged and allocated for as long as its Reader lives.
+ */
+#include "test.h"
+#include "custom_device.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int reader_threads = 4;
+constexpr int writer_threads = 2;
+/* Long enough for many preemptions even on a single core */
+constexpr auto duration = std::chrono::milliseconds(200);
+/* Device IDs per writer, together they fill the table so adds also fail */
+constexpr int ids_per_writer = CustomDeviceTable::max_devices / writer_threads + 1;
+
+/* Every field carries the generation, a torn or freed device shows up as a mismatch */
+CustomDevice device(int writer, int id, int generation) {
+    CustomDevice result;
+    std::memset(&result, 0, sizeof(result));
+    std::snprintf(result.id, sizeof(result.id), "writer%d_%d", writer, id);
+    result.capture_frequency = generation;
+    result.capture_channels = generation;
+    result.playback_frequency = generation;
+    result.playback_channels = generation;
+    result.capture_buffer_size = static_cast<std::size_t>(generation);
+    result.playback_buffer_size = static_cast<std::size_t>(generation);
+    return result;
+}
+
+bool whole(const CustomDevice& device) {
+    const auto generation = device.capture_frequency;
+    return std::strncmp(device.id, "writer", 6) == 0 && device.capture_channels == generation &&
+           device.playback_frequency == generation && device.playback_channels == generation &&
+           device.capture_buffer_size == static_cast<std::size_t>(generation) &&
+           device.playback_buffer_size == static_cast<std::size_t>(generation);
+}
+
+}
+
+TEST(custom_device_table_concurrent_readers_and_writers) {
+    CustomDeviceTable table;
+    std::atomic<bool> running{true};
+    std::atomic<int> generation{1};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> torn{0};
+    std::atomic<uint64_t> changed{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < reader_threads; ++r) {
+        readers.emplace_back([&] {
+            uint64_t local_reads = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                CustomDeviceTable::Reader reader(table);
+                for (int handle = 0; handle < CustomDeviceTable::max_devices; ++handle) {
+                    const auto* device = reader.get(handle);
+                    if (!device)
+                        continue;
+                    ++local_reads;
+                    const auto copy = *device;
+                    if (!whole(copy))
+                        torn.fetch_add(1, std::memory_order_relaxed);
+                    // Give the writers a chance to publish, the snapshot must not move under the reader
+                    std::this_thread::yield();
+                    if (std::memcmp(&copy, device, sizeof(copy)) != 0 || reader.get(handle) != device)
+                        changed.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            reads.fetch_add(local_reads, std::memory_order_relaxed);
+        });
+    }
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < writer_threads; ++w) {
+        writers.emplace_back([&, w] {
+            for (int i = 0; running.load(std::memory_order_relaxed); ++i) {
+                const auto id = i % ids_per_writer;
+                const auto handle = table.add(device(w, id, generation.fetch_add(1)));
+                if (handle >= 0 && i % 3 == 0)
+                    table.remove(handle);
+                std::this_thread::yield();
+            }
+        });
+    }
+    std::this_thread::sleep_for(duration);
+    running.store(false);
+    for (auto& writer : writers)
+        writer.join();
+    for (auto& reader : readers)
+        reader.join();
+
+    CHECK(reads.load() > 0);
+    CHECK(torn.load() == 0);
+    CHECK(changed.load() == 0);
+
+    // Each remaining ID is found under the handle it is stored at
+    CustomDeviceTable::Reader reader(table);
+    for (int handle = 0; handle < CustomDeviceTable::max_devices; ++handle) {
+        const auto* device = reader.get(handle);
+        if (device) {
+            CHECK(whole(*device));
+            CHECK(table.find(device->id) == handle);
+        }
+    }
+}
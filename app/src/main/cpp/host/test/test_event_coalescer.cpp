@@ -0,0 +1,74 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * EventCoalescer delivery order.
+ */
+#include "test.h"
+#include "event_coalescer.h"
+
+#include <chrono>
+#include <vector>
+
+namespace {
+
+void noDispatch(JNIEnv*, const EventRecord&) {}
+
+EventRecord talkStatus(uint64 connection, int status, anyID client) {
+    EventRecord record;
+    record.pack(noDispatch, EventType_TalkStatusChange, connection, status, 0, client);
+    return record;
+}
+
+EventRecord subscription(uint64 connection, anyID client, int visibility) {
+    EventRecord record;
+    record.pack(noDispatch, EventType_ClientMoveSubscription, connection, client, uint64{1}, uint64{2}, visibility);
+    return record;
+}
+
+}
+
+/* Two coalesced types of the same client and connection are delivered in arrival order */
+TEST(event_coalescer_keeps_order_across_types) {
+    EventCoalescer coalescer;
+    REQUIRE(coalescer.set_window(EventType_TalkStatusChange, std::chrono::milliseconds(1000)));
+    REQUIRE(coalescer.set_window(EventType_ClientMoveSubscription, std::chrono::milliseconds(1000)));
+
+    std::vector<EventRecord> delivered;
+    const auto deliver = [&](const EventRecord& record) { delivered.push_back(record); };
+    const auto now = EventCoalescer::Clock::now();
+    CHECK(coalescer.offer(talkStatus(1, 1, 5), now, deliver));
+    CHECK(coalescer.offer(subscription(1, 5, RETAIN_VISIBILITY), now, deliver));
+    CHECK(coalescer.offer(talkStatus(1, 0, 5), now, deliver));
+    coalescer.flush_all(deliver);
+
+    REQUIRE(delivered.size() == 3);
+    CHECK(delivered[0].type == EventType_TalkStatusChange && delivered[0].values[1] == 1);
+    CHECK(delivered[1].type == EventType_ClientMoveSubscription);
+    CHECK(delivered[2].type == EventType_TalkStatusChange && delivered[2].values[1] == 0);
+    CHECK(coalescer.pending() == 0);
+}
+
+/* Within a type the latest event of a client takes the place of its first one */
+TEST(event_coalescer_merges_within_type) {
+    EventCoalescer coalescer;
+    REQUIRE(coalescer.set_window(EventType_TalkStatusChange, std::chrono::milliseconds(1000)));
+
+    std::vector<EventRecord> delivered;
+    const auto deliver = [&](const EventRecord& record) { delivered.push_back(record); };
+    const auto now = EventCoalescer::Clock::now();
+    coalescer.offer(talkStatus(1, 1, 5), now, deliver);
+    coalescer.offer(talkStatus(1, 1, 6), now, deliver);
+    coalescer.offer(talkStatus(1, 0, 5), now, deliver);
+    // Another connection does not flush the first one
+    coalescer.offer(talkStatus(2, 1, 5), now, deliver);
+    CHECK(delivered.empty());
+    coalescer.flush_all(deliver);
+
+    REQUIRE(delivered.size() == 3);
+    CHECK(delivered[0].values[0] == 1 && delivered[0].values[3] == 5 && delivered[0].values[1] == 0);
+    CHECK(delivered[1].values[0] == 1 && delivered[1].values[3] == 6);
+    CHECK(delivered[2].values[0] == 2);
+    CHECK(coalescer.eliminated() == 1);
+}
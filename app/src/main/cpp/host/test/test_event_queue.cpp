@@ -0,0 +1,186 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * EventQueue overflow policies, with a sink that holds the dispatcher until the queue has overflowed.
+ */
+#include "test.h"
+#include "event_queue.h"
+#include "fake_jni.h"
+
+#include <pthread.h>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+void noDispatch(JNIEnv*, const EventRecord&) {}
+
+/* Attaches the dispatcher thread until it exits, like connectVM does for the clientlib threads */
+JNIEnv* attachUntilExit() {
+    static pthread_key_t key;
+    static std::once_flag once;
+    std::call_once(once, [] {
+        pthread_key_create(&key, [](void*) { fake_jni::java_vm()->DetachCurrentThread(); });
+    });
+    JNIEnv* env = fake_jni::attach();
+    pthread_setspecific(key, env);
+    return env;
+}
+
+/*
+ * Holds the dispatcher at the start of its first pass until released, then records what it gets.
+ * With hold_at set it holds again after consuming that many records.
+ */
+class HoldingSink : public EventSink {
+public:
+    explicit HoldingSink(std::size_t hold_at = 0) : m_hold_at(hold_at) {}
+
+    void begin(JNIEnv*) override {
+        if (!m_began) {
+            m_began = true;
+            hold();
+        }
+    }
+    void end(JNIEnv*) override {}
+    void consume(JNIEnv*, const EventRecord& record) override {
+        m_records.push_back(record);
+        if (m_records.size() == m_hold_at)
+            hold();
+    }
+
+    /* Waits until the dispatcher is held for the count-th time */
+    void wait_held(int count = 1) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this, count] { return m_held >= count; });
+    }
+    void release() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_released;
+        m_changed.notify_all();
+    }
+    const std::vector<EventRecord>& records() const { return m_records; }
+
+private:
+    void hold() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const auto held = ++m_held;
+        m_changed.notify_all();
+        m_changed.wait(lock, [this, held] { return m_released >= held; });
+    }
+
+    const std::size_t m_hold_at;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    bool m_began = false;
+    int m_held = 0;
+    int m_released = 0;
+    std::vector<EventRecord> m_records;
+};
+
+void pushTalkStatus(EventQueue& queue, uint64 connection, int status, anyID client) {
+    queue.push(EventType_TalkStatusChange, [&](EventRecord& record) {
+        record.pack(noDispatch, EventType_TalkStatusChange, connection, status, 0, client);
+    });
+}
+
+void pushClientMove(EventQueue& queue, uint64 connection, anyID client, uint64 channel) {
+    queue.push(EventType_ClientMove, [&](EventRecord& record) {
+        record.pack(noDispatch, EventType_ClientMove, connection, client, uint64{1}, channel, 0, "");
+    });
+}
+
+}
+
+/* Every (connection, client) keeps its latest status, none is lost to another client or connection */
+TEST(event_queue_coalesce_keeps_latest_per_client) {
+    HoldingSink sink;
+    EventQueue queue;
+    queue.set_sink(&sink);
+    queue.set_overflow(EventQueueOverflow_Coalesce);
+    REQUIRE(queue.start(2, attachUntilExit));
+
+    pushTalkStatus(queue, 1, 0, 100);
+    sink.wait_held();
+    // Four rounds over 2 connections x 8 clients overflow the two cells many times
+    std::map<std::tuple<uint64_t, uint64_t>, uint64_t> latest;
+    for (int status = 1; status <= 4; ++status) {
+        for (uint64 connection = 1; connection <= 2; ++connection) {
+            for (anyID client = 1; client <= 8; ++client) {
+                pushTalkStatus(queue, connection, status, client);
+                latest[std::make_tuple(connection, client)] = static_cast<uint64_t>(status);
+            }
+        }
+    }
+    sink.release();
+    queue.stop();
+
+    std::map<std::tuple<uint64_t, uint64_t>, uint64_t> delivered;
+    for (const auto& record : sink.records()) {
+        if (record.values[3] != 100)
+            delivered[std::make_tuple(record.values[0], record.values[3])] = record.values[1];
+    }
+    CHECK(delivered == latest);
+    CHECK(queue.counters().coalesced > 0);
+    CHECK(queue.counters().dropped == 0);
+}
+
+/* More keys than overflow slots drop the oldest held events instead */
+TEST(event_queue_coalesce_full_table_drops_oldest) {
+    HoldingSink sink;
+    EventQueue queue;
+    queue.set_sink(&sink);
+    queue.set_overflow(EventQueueOverflow_Coalesce);
+    REQUIRE(queue.start(2, attachUntilExit));
+
+    pushTalkStatus(queue, 1, 0, 1000);
+    sink.wait_held();
+    const auto clients = static_cast<anyID>(EventQueue::overflow_slots * 2);
+    for (anyID client = 1; client <= clients; ++client)
+        pushTalkStatus(queue, 1, 1, client);
+    sink.release();
+    queue.stop();
+
+    CHECK(queue.counters().dropped > 0);
+    CHECK(sink.records().size() + queue.counters().dropped == static_cast<std::size_t>(clients) + 1);
+    // The last client is always kept
+    bool last = false;
+    for (const auto& record : sink.records())
+        last = last || record.values[3] == clients;
+    CHECK(last);
+}
+
+/* A held event is not overtaken by a later one that finds room in the ring again */
+TEST(event_queue_coalesce_keeps_order_after_overflow) {
+    HoldingSink sink(2);
+    EventQueue queue;
+    queue.set_sink(&sink);
+    queue.set_overflow(EventQueueOverflow_Coalesce);
+    REQUIRE(queue.start(2, attachUntilExit));
+
+    pushClientMove(queue, 1, 7, 1);
+    sink.wait_held();
+    pushClientMove(queue, 1, 8, 1);
+    // The ring is full, client 5 moving to channel 2 is held
+    pushClientMove(queue, 1, 5, 2);
+    sink.release();
+    // Held after the first two records, the cell of the first is free again
+    sink.wait_held(2);
+    pushClientMove(queue, 1, 5, 3);
+    pushTalkStatus(queue, 1, 1, 5);
+    sink.release();
+    queue.stop();
+
+    // The later move replaced the held one, the talk status of client 5 stays behind it
+    const auto& records = sink.records();
+    REQUIRE(records.size() == 4);
+    CHECK(records[2].type == EventType_ClientMove);
+    CHECK(records[2].values[1] == 5);
+    CHECK(records[2].values[3] == 3);
+    CHECK(records[3].type == EventType_TalkStatusChange);
+    CHECK(queue.counters().coalesced == 1);
+}
@@ -0,0 +1,65 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * EventRecord packing of strings that do not fit its text area.
+ */
+#include "test.h"
+#include "event_record.h"
+
+#include <cstring>
+#include <string>
+#include <tuple>
+
+namespace {
+
+void noDispatch(JNIEnv*, const EventRecord&) {}
+
+/* A record followed by bytes that packing must never touch, like the next cell of the ring */
+struct GuardedRecord {
+    EventRecord record;
+    unsigned char guard[64];
+};
+
+}
+
+/* A first string that fills the text area leaves the later ones empty, nothing is written past it */
+TEST(event_record_oversized_string_then_more_strings) {
+    GuardedRecord guarded;
+    std::memset(guarded.guard, 0xA5, sizeof(guarded.guard));
+    const std::string message(2000, 'x');
+    guarded.record.pack(noDispatch, EventType_ServerError, uint64{1}, message.c_str(), 2568u, "return code", "extra");
+
+    CHECK(guarded.record.text_size <= EventRecord::text_capacity);
+    bool intact = true;
+    for (const auto byte : guarded.guard)
+        intact = intact && byte == 0xA5;
+    CHECK(intact);
+
+    const auto args = guarded.record.unpack<uint64, const char*, unsigned int, const char*, const char*>();
+    CHECK(std::strlen(std::get<1>(args)) == EventRecord::text_capacity - 1);
+    CHECK(std::get<2>(args) == 2568u);
+    CHECK(std::string(std::get<3>(args)).empty());
+    CHECK(std::string(std::get<4>(args)).empty());
+}
+
+/* One byte left: the next string is empty, the one after it too */
+TEST(event_record_string_after_nearly_full_text) {
+    GuardedRecord guarded;
+    std::memset(guarded.guard, 0xA5, sizeof(guarded.guard));
+    const std::string message(EventRecord::text_capacity - 2, 'x');
+    guarded.record.pack(noDispatch, EventType_UserLoggingMessage, message.c_str(), 4, "channel", uint64{1}, "time", "complete");
+
+    CHECK(guarded.record.text_size <= EventRecord::text_capacity);
+    bool intact = true;
+    for (const auto byte : guarded.guard)
+        intact = intact && byte == 0xA5;
+    CHECK(intact);
+
+    const auto args = guarded.record.unpack<const char*, int, const char*, uint64, const char*, const char*>();
+    CHECK(std::string(std::get<0>(args)) == message);
+    CHECK(std::string(std::get<2>(args)).empty());
+    CHECK(std::string(std::get<4>(args)).empty());
+    CHECK(std::string(std::get<5>(args)).empty());
+}
@@ -0,0 +1,55 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Usage: wrapper_tests [<name substring>]
+ */
+#include "test.h"
+#include "fake_jni.h"
+#include "host_app.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+static std::vector<const Test*>& registry() {
+    static std::vector<const Test*> tests;
+    return tests;
+}
+
+static int gFailures = 0;
+
+Test::Test(const char* name, Body body) : m_name(name), m_body(body) {
+    registry().push_back(this);
+}
+
+void Test::fail(const char* file, int line, const char* expression) {
+    std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+    ++gFailures;
+}
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    JNIEnv* env = host_app::load();
+    int failed = 0;
+    int run = 0;
+    for (const auto* test : registry()) {
+        if (filter && std::strstr(test->name(), filter) == nullptr)
+            continue;
+        const int failures = gFailures;
+        const auto objects = fake_jni::live_objects();
+        test->body()(env);
+        fake_jni::return_to_java(env);
+        if (fake_jni::live_objects() > objects) {
+            std::fprintf(stderr, "%s leaked %zu Java objects\n", test->name(), fake_jni::live_objects() - objects);
+            ++gFailures;
+        }
+        const bool passed = gFailures == failures;
+        std::printf("%s %s\n", passed ? "PASS" : "FAIL", test->name());
+        failed += passed ? 0 : 1;
+        ++run;
+    }
+    std::printf("%d of %d tests passed\n", run - failed, run);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * The sample conversion kernels against plain scalar references. The lengths are not multiples of the
+ * vector width, so both the vector body and the scalar tail are covered.
+ */
+#include "test.h"
+#include "sample_convert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t samples = 1027;
+
+/* Deterministic values in [-1.25, 1.25), including some out of range */
+std::vector<float> randomFloats(std::size_t count) {
+    std::vector<float> result(count);
+    uint32_t state = 12345;
+    for (auto& value : result) {
+        state = state * 1664525u + 1013904223u;
+        value = (static_cast<float>(state >> 8) / 16777216.0f - 0.5f) * 2.5f;
+    }
+    return result;
+}
+
+std::vector<short> randomShorts(std::size_t count) {
+    std::vector<short> result(count);
+    uint32_t state = 54321;
+    for (auto& value : result) {
+        state = state * 1664525u + 1013904223u;
+        value = static_cast<short>(state >> 16);
+    }
+    return result;
+}
+
+short referenceInt16(float value) {
+    return static_cast<short>(std::lrintf(std::fmin(std::fmax(value * 32768.0f, -32768.0f), 32767.0f)));
+}
+
+}
+
+TEST(sample_convert_float_to_int16_matches_reference) {
+    auto in = randomFloats(samples);
+    // Halfway cases round to even, extremes clip
+    const float edges[] = {0.5f, 1.5f, 2.5f, -0.5f, -1.5f, -2.5f, 32766.5f, -32767.5f, 40000.0f, -40000.0f, 0.0f, -0.0f};
+    for (std::size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i)
+        in[i] = edges[i] / 32768.0f;
+
+    std::vector<short> out(samples);
+    float_to_int16(in.data(), out.data(), samples, nullptr);
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < samples; ++i)
+        mismatches += out[i] != referenceInt16(in[i]) ? 1 : 0;
+    CHECK(mismatches == 0);
+    CHECK(out[0] == 0);
+    CHECK(out[1] == 2);
+    CHECK(out[2] == 2);
+    CHECK(out[5] == -2);
+    CHECK(out[6] == 32766);
+    CHECK(out[8] == 32767);
+    CHECK(out[9] == -32768);
+}
+
+/* The vector paths draw the noise of each lane in the order of the scalar path */
+TEST(sample_convert_dithered_float_to_int16_matches_scalar) {
+    const auto in = randomFloats(samples);
+    DitherState vector_dither;
+    std::vector<short> out(samples);
+    float_to_int16(in.data(), out.data(), samples, &vector_dither);
+
+    // One sample per call always takes the scalar path
+    DitherState scalar_dither;
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < samples; i += 4) {
+        const auto count = std::min<std::size_t>(4, samples - i);
+        short reference[4];
+        for (std::size_t lane = 0; lane < count; ++lane) {
+            DitherState lane_dither;
+            lane_dither.lanes[0] = scalar_dither.lanes[lane];
+            float_to_int16(&in[i + lane], &reference[lane], 1, &lane_dither);
+            scalar_dither.lanes[lane] = lane_dither.lanes[0];
+            mismatches += out[i + lane] != reference[lane] ? 1 : 0;
+        }
+    }
+    CHECK(mismatches == 0);
+    for (int lane = 0; lane < 4; ++lane)
+        CHECK(vector_dither.lanes[lane] == scalar_dither.lanes[lane]);
+}
+
+TEST(sample_convert_int16_to_float_matches_reference) {
+    const auto in = randomShorts(samples);
+    std::vector<float> out(samples);
+    int16_to_float(in.data(), out.data(), samples);
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < samples; ++i)
+        mismatches += out[i] != static_cast<float>(in[i]) / 32768.0f ? 1 : 0;
+    CHECK(mismatches == 0);
+}
+
+TEST(sample_convert_channels_match_reference) {
+    const auto in = randomShorts(samples * 2);
+
+    std::vector<short> stereo(samples * 2);
+    mono_to_stereo(in.data(), stereo.data(), samples);
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < samples; ++i)
+        mismatches += stereo[2 * i] != in[i] || stereo[2 * i + 1] != in[i] ? 1 : 0;
+    CHECK(mismatches == 0);
+
+    std::vector<short> mono(samples);
+    stereo_to_mono(in.data(), mono.data(), samples);
+    mismatches = 0;
+    for (std::size_t i = 0; i < samples; ++i)
+        mismatches += mono[i] != static_cast<short>((in[2 * i] + in[2 * i + 1]) >> 1) ? 1 : 0;
+    CHECK(mismatches == 0);
+}
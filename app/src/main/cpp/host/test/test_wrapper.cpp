@@ -0,0 +1,137 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * The wrapper loaded and connected to the stub server like the app does it.
+ */
+#include "test.h"
+#include "fake_jni.h"
+#include "host_app.h"
+#include "stub_clientlib.h"
+#include "ts3client_wrapper.h"
+#include "teamspeak/public_errors.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define NATIVE(name) Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1##name
+
+/* Waits up to a second for the dispatcher to post count events of type */
+static bool waitPosted(EventType type, uint64_t count) {
+    for (int i = 0; i < 1000 && host_app::posted(type) < count; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return host_app::posted(type) >= count;
+}
+
+TEST(natives_registered) {
+    CHECK(fake_jni::natives(host_app::native_class()).size() > 0);
+}
+
+TEST(connect_posts_events) {
+    const auto status = host_app::posted(EventType_ConnectStatusChange);
+    const auto channels = host_app::posted(EventType_NewChannel);
+    const auto moves = host_app::posted(EventType_ClientMove);
+    {
+        host_app::Client client(env);
+        CHECK(waitPosted(EventType_ConnectStatusChange, status + 4));
+        CHECK(waitPosted(EventType_NewChannel, channels + stub_clientlib::server_channels));
+        CHECK(waitPosted(EventType_ClientMove, moves + stub_clientlib::server_clients));
+    }
+    // The disconnect of the destroyed client
+    CHECK(waitPosted(EventType_ConnectStatusChange, status + 5));
+}
+
+TEST(queries_after_connect) {
+    host_app::Client client(env);
+    CHECK(NATIVE(getConnectionStatus)(env, nullptr, client.connection()) == STATUS_CONNECTION_ESTABLISHED);
+    CHECK(NATIVE(getClientID)(env, nullptr, client.connection()) == stub_clientlib::own_client);
+
+    jintArray clients = NATIVE(getClientList)(env, nullptr, client.connection());
+    REQUIRE(clients != nullptr);
+    CHECK(env->GetArrayLength(clients) == stub_clientlib::server_clients);
+
+    jbyteArray tree = NATIVE(getServerTree)(env, nullptr, client.connection(), 0);
+    REQUIRE(tree != nullptr);
+    CHECK(env->GetArrayLength(tree) > 0);
+}
+
+TEST(talk_status_reaches_post) {
+    host_app::Client client(env);
+    const auto callbacks = stub_clientlib::callbacks();
+    REQUIRE(callbacks.onTalkStatusChangeEvent != nullptr);
+
+    const auto posted = host_app::posted(EventType_TalkStatusChange);
+    callbacks.onTalkStatusChangeEvent(static_cast<uint64>(client.connection()), STATUS_TALKING, 0, 2);
+    CHECK(waitPosted(EventType_TalkStatusChange, posted + 1));
+}
+
+static jintArray javaInts(JNIEnv* env, const std::vector<jint>& values) {
+    jintArray array = env->NewIntArray(static_cast<jsize>(values.size()));
+    env->SetIntArrayRegion(array, 0, static_cast<jsize>(values.size()), values.data());
+    return array;
+}
+
+/* Both batch queries take null for all visible clients, start every row with the ID and reject IDs outside anyID */
+TEST(client_variables_batch) {
+    host_app::Client client(env);
+    jintArray clients = NATIVE(getClientList)(env, nullptr, client.connection());
+    REQUIRE(clients != nullptr);
+    const auto count = env->GetArrayLength(clients);
+    std::vector<jint> ids(static_cast<std::size_t>(count));
+    env->GetIntArrayRegion(clients, 0, count, ids.data());
+
+    jintArray flags = javaInts(env, {CLIENT_NICKNAME, CLIENT_UNIQUE_IDENTIFIER});
+    jobjectArray strings = NATIVE(getClientVariablesAsString)(env, nullptr, client.connection(), nullptr, flags);
+    REQUIRE(strings != nullptr);
+    REQUIRE(env->GetArrayLength(strings) == count * 3);
+    for (jsize i = 0; i < count; ++i) {
+        const auto id = static_cast<jstring>(env->GetObjectArrayElement(strings, i * 3));
+        REQUIRE(id != nullptr);
+        CHECK(fake_jni::utf8(id) == std::to_string(ids[static_cast<std::size_t>(i)]));
+    }
+
+    jintArray ints = NATIVE(getClientVariablesAsInt)(env, nullptr, client.connection(), nullptr, flags);
+    REQUIRE(ints != nullptr);
+    CHECK(env->GetArrayLength(ints) == count * 3);
+
+    for (const jint invalid : {-1, 65536, INT32_MIN}) {
+        jintArray bad = javaInts(env, {ids[0], invalid});
+        CHECK(NATIVE(getClientVariablesAsString)(env, nullptr, client.connection(), bad, flags) == nullptr);
+        CHECK(NATIVE(getClientVariablesAsInt)(env, nullptr, client.connection(), bad, flags) == nullptr);
+    }
+}
+
+#ifdef LOAD_GENERATOR
+static std::vector<jbyte> serverTree(JNIEnv* env, jlong connection) {
+    jbyteArray tree = NATIVE(getServerTree)(env, nullptr, connection, 0);
+    if (!tree)
+        return {};
+    std::vector<jbyte> bytes(static_cast<std::size_t>(env->GetArrayLength(tree)));
+    env->GetByteArrayRegion(tree, 0, static_cast<jsize>(bytes.size()), bytes.data());
+    return bytes;
+}
+
+/* Synthetic channel, move and status events reach Java without touching the server tree */
+TEST(load_generator_skips_server_tree) {
+    host_app::Client client(env);
+    const auto before = serverTree(env, client.connection());
+    REQUIRE(!before.empty());
+
+    const auto channels = host_app::posted(EventType_NewChannel);
+    const auto moves = host_app::posted(EventType_ClientMove);
+    const auto status = host_app::posted(EventType_ConnectStatusChange);
+    jintArray types = javaInts(env, {EventType_NewChannel, EventType_ClientMove, EventType_ConnectStatusChange});
+    jintArray rates = javaInts(env, {1000, 1000, 1000});
+    REQUIRE(NATIVE(startLoadGenerator)(env, nullptr, client.connection(), types, rates, 1, 1, 0) == ERROR_ok);
+    CHECK(waitPosted(EventType_NewChannel, channels + 10));
+    CHECK(waitPosted(EventType_ClientMove, moves + 10));
+    CHECK(waitPosted(EventType_ConnectStatusChange, status + 10));
+    NATIVE(stopLoadGenerator)(env, nullptr);
+
+    CHECK(serverTree(env, client.connection()) == before);
+}
+#endif
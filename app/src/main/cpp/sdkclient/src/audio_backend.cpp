@@ -0,0 +1,112 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "audio_backend.h"
+
+#include <cstring>
+
+int NullAudioBackend::read_capture(short* samples, int frames) {
+    std::memset(samples, 0, sizeof(short) * frames * m_capture_channels);
+    return frames;
+}
+
+static void copy_path(char* destination, const char* source, std::size_t size) {
+    if (!source)
+        source = "";
+    std::strncpy(destination, source, size - 1);
+    destination[size - 1] = '\0';
+}
+
+FileAudioBackend::FileAudioBackend(const char* capture_path, const char* playback_path) {
+    copy_path(m_capture_path, capture_path, sizeof(m_capture_path));
+    copy_path(m_playback_path, playback_path, sizeof(m_playback_path));
+}
+
+bool FileAudioBackend::open(const Format& format) {
+    close();
+    m_format = format;
+    if (m_capture_path[0] && format.capture_channels > 0) {
+        m_capture = std::fopen(m_capture_path, "rb");
+        if (!m_capture)
+            return false;
+    }
+    if (m_playback_path[0] && format.playback_channels > 0) {
+        m_playback = std::fopen(m_playback_path, "ab");
+        if (!m_playback) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void FileAudioBackend::close() {
+    if (m_capture)
+        std::fclose(m_capture);
+    if (m_playback)
+        std::fclose(m_playback);
+    m_capture = nullptr;
+    m_playback = nullptr;
+}
+
+int FileAudioBackend::read_capture(short* samples, int frames) {
+    const auto channels = static_cast<std::size_t>(m_format.capture_channels);
+    std::size_t done = 0;
+    if (m_capture) {
+        bool rewound = false;
+        while (done < static_cast<std::size_t>(frames)) {
+            const auto read = std::fread(samples + done * channels, sizeof(short) * channels, frames - done, m_capture);
+            done += read;
+            if (read == 0) {
+                // Empty file or read error, do not spin
+                if (rewound)
+                    break;
+                std::rewind(m_capture);
+                rewound = true;
+            } else {
+                rewound = false;
+            }
+        }
+    }
+    std::memset(samples + done * channels, 0, sizeof(short) * channels * (frames - done));
+    return frames;
+}
+
+void FileAudioBackend::write_playback(const short* samples, int frames) {
+    if (m_playback)
+        std::fwrite(samples, sizeof(short) * m_format.playback_channels, frames, m_playback);
+}
+
+bool JavaStreamBackend::open(const Format& format) {
+    m_latency.capture_chunks.reset();
+    m_latency.playback_chunks.reset();
+    if (format.capture_channels > 0) {
+        if (!m_stream.capture.allocate(JavaAudioStream::default_capture_capacity * JavaAudioStream::max_capture_channels))
+            return false;
+        m_stream.capture.configure(format.capture_channels);
+    }
+    if (format.playback_channels > 0) {
+        m_playback_period = format.playback_frequency * format.period_ms / 1000;
+        if (!m_stream.playback.configure(format.playback_frequency, format.playback_channels, m_playback_period))
+            return false;
+    }
+    return true;
+}
+
+int JavaStreamBackend::read_capture(short* samples, int frames) {
+    const auto read = m_stream.capture.read(samples, static_cast<std::size_t>(frames));
+    m_latency.capture_chunks.pop(m_stream.capture.read_position(), monotonic_ns(), m_latency.histograms[AudioLatency::CaptureQueueing]);
+    return static_cast<int>(read);
+}
+
+int JavaStreamBackend::playback_frames_wanted(int) {
+    return static_cast<int>(m_stream.playback.frames_wanted());
+}
+
+void JavaStreamBackend::write_playback(const short* samples, int frames) {
+    m_stream.playback.write(samples, static_cast<std::size_t>(frames));
+    m_latency.playback_chunks.push(m_stream.playback.write_position(), monotonic_ns());
+}
@@ -0,0 +1,127 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * PCM endpoints the native audio pump exchanges samples with. Samples are interleaved 16 bit.
+ */
+#pragma once
+
+#include "pcm_ring.h"
+#include "jitter_buffer.h"
+#include "audio_latency.h"
+
+#include <cstddef>
+#include <cstdio>
+
+/* Backends selectable from Java, see Native.AUDIO_PUMP_BACKEND_* */
+enum AudioPumpBackend {
+    AudioPumpBackend_Null = 0,
+    AudioPumpBackend_File = 1,
+    AudioPumpBackend_Java = 2
+};
+
+class AudioBackend {
+public:
+    struct Format {
+        int capture_frequency;
+        int capture_channels;
+        int playback_frequency;
+        int playback_channels;
+        int period_ms;
+    };
+
+    virtual ~AudioBackend() = default;
+
+    virtual bool open(const Format& format) = 0;
+    virtual void close() = 0;
+
+    /*
+     * True if read_capture / write_playback block until the hardware consumed the period, the pump then
+     * runs at the pace of the backend. Otherwise the pump sleeps to the next period itself.
+     */
+    virtual bool paces() const = 0;
+
+    /* Playback frames to fetch this period, backends that buffer ahead may ask for more or less than one period */
+    virtual int playback_frames_wanted(int period_frames) { return period_frames; }
+
+    /* Fills frames frames of capture data, returns the number of frames written */
+    virtual int read_capture(short* samples, int frames) = 0;
+    virtual void write_playback(const short* samples, int frames) = 0;
+};
+
+/* Captures silence and discards playback */
+class NullAudioBackend : public AudioBackend {
+public:
+    bool open(const Format& format) override { m_capture_channels = format.capture_channels; return true; }
+    void close() override {}
+    bool paces() const override { return false; }
+    int read_capture(short* samples, int frames) override;
+    void write_playback(const short*, int) override {}
+
+private:
+    int m_capture_channels = 0;
+};
+
+/*
+ * Reads capture data from a raw PCM file, starting over at its end, and appends playback to another.
+ * Either path may be empty, that direction then behaves like NullAudioBackend.
+ */
+class FileAudioBackend : public AudioBackend {
+public:
+    FileAudioBackend(const char* capture_path, const char* playback_path);
+    ~FileAudioBackend() override { close(); }
+
+    bool open(const Format& format) override;
+    void close() override;
+    bool paces() const override { return false; }
+    int read_capture(short* samples, int frames) override;
+    void write_playback(const short* samples, int frames) override;
+
+private:
+    static constexpr std::size_t max_path_length = 511;
+
+    char m_capture_path[max_path_length + 1];
+    char m_playback_path[max_path_length + 1];
+    std::FILE* m_capture = nullptr;
+    std::FILE* m_playback = nullptr;
+    Format m_format = {};
+};
+
+/*
+ * PCM exchanged with Java for one custom device. Java writes capture data of any chunk size into capture,
+ * the pump drains it at the clientlib cadence. The pump keeps playback filled to its adaptive target
+ * depth, Java reads from it whenever the audio device needs data. Lives as long as the process, so Java calls racing with
+ * a pump start or stop never touch freed memory.
+ */
+struct JavaAudioStream {
+    /*
+     * Frames of capture, a second at 48 kHz. The ring is allocated once for max_capture_channels, so the slot
+     * reopens with any format without reallocating under a Java writer; wider formats get fewer frames.
+     */
+    static constexpr std::size_t default_capture_capacity = 48000;
+    static constexpr std::size_t max_capture_channels = 2;
+
+    PcmRing capture;
+    PlaybackJitterBuffer playback;
+};
+
+/* Exchanges the pump periods with a JavaAudioStream */
+class JavaStreamBackend : public AudioBackend {
+public:
+    JavaStreamBackend(JavaAudioStream& stream, AudioLatency& latency) : m_stream(stream), m_latency(latency) {}
+
+    bool open(const Format& format) override;
+    void close() override {}
+    bool paces() const override { return false; }
+
+    /* Hands over what Java has written so far, at most frames */
+    int read_capture(short* samples, int frames) override;
+    int playback_frames_wanted(int period_frames) override;
+    void write_playback(const short* samples, int frames) override;
+
+private:
+    JavaAudioStream& m_stream;
+    AudioLatency& m_latency;
+    int m_playback_period = 0;
+};
@@ -0,0 +1,176 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Latency instrumentation of the custom device path. Histograms are log2 bucketed nanoseconds updated with
+ * relaxed atomics, so recording never blocks an audio thread and reading never stops one.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+inline uint64_t monotonic_ns() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000u + static_cast<uint64_t>(now.tv_nsec);
+}
+
+class LatencyHistogram {
+public:
+    /* Bucket b counts values below 2^b ns and at least 2^(b-1) ns, the last one everything above */
+    static constexpr int buckets = 32;
+    /* count, sum, max, p50, p90, p99, then the buckets */
+    static constexpr int snapshot_size = 6 + buckets;
+
+    void record(uint64_t ns) {
+        m_buckets[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > m_max.load(std::memory_order_relaxed))
+            m_max.store(ns, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        for (auto& bucket : m_buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+    /* Adds the values recorded by other, e.g. to report several histograms as one */
+    void merge(const LatencyHistogram& other) {
+        for (int b = 0; b < buckets; ++b)
+            m_buckets[b].fetch_add(other.m_buckets[b].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_sum.fetch_add(other.m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        const auto max = other.m_max.load(std::memory_order_relaxed);
+        if (max > m_max.load(std::memory_order_relaxed))
+            m_max.store(max, std::memory_order_relaxed);
+    }
+
+    /* Percentiles are the upper bound of their bucket, capped at the maximum */
+    void snapshot(int64_t* out) const {
+        uint64_t counts[buckets];
+        uint64_t total = 0;
+        for (int b = 0; b < buckets; ++b) {
+            counts[b] = m_buckets[b].load(std::memory_order_relaxed);
+            total += counts[b];
+        }
+        const auto max = m_max.load(std::memory_order_relaxed);
+        out[0] = static_cast<int64_t>(total);
+        out[1] = static_cast<int64_t>(m_sum.load(std::memory_order_relaxed));
+        out[2] = static_cast<int64_t>(max);
+        out[3] = static_cast<int64_t>(percentile(counts, total, max, 500));
+        out[4] = static_cast<int64_t>(percentile(counts, total, max, 900));
+        out[5] = static_cast<int64_t>(percentile(counts, total, max, 990));
+        for (int b = 0; b < buckets; ++b)
+            out[6 + b] = static_cast<int64_t>(counts[b]);
+    }
+
+    static int bucket_of(uint64_t ns) {
+        int bucket = 0;
+        for (uint64_t value = ns; value != 0 && bucket < buckets - 1; value >>= 1)
+            ++bucket;
+        return bucket;
+    }
+
+    static uint64_t percentile(const uint64_t* counts, uint64_t total, uint64_t max, unsigned int permille) {
+        if (total == 0)
+            return 0;
+        const uint64_t rank = (total * permille + 999) / 1000;
+        uint64_t seen = 0;
+        int b = 0;
+        while (b < buckets - 1 && seen + counts[b] < rank)
+            seen += counts[b++];
+        const uint64_t upper = b == 0 ? 0 : (uint64_t{1} << b) - 1;
+        return upper < max ? upper : max;
+    }
+
+private:
+    std::atomic<uint64_t> m_buckets[buckets] = {};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+/*
+ * When chunks of samples entered a PcmRing, keyed by the ring write position after the chunk. The producer
+ * of the ring pushes, the consumer pops the chunks it has read completely. Chunks beyond capacity are not
+ * timed, the ring never blocks.
+ */
+class ChunkTimestamps {
+public:
+    static constexpr std::size_t capacity = 64;
+
+    void push(std::size_t end_position, uint64_t ns) {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= capacity)
+            return;
+        m_entries[head % capacity] = {end_position, ns};
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    /* Records the age of every chunk that ends at or before read_position */
+    void pop(std::size_t read_position, uint64_t now, LatencyHistogram& histogram) {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto head = m_head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const auto& entry = m_entries[tail % capacity];
+            if (entry.end_position > read_position)
+                break;
+            histogram.record(now - entry.ns);
+        }
+        m_tail.store(tail, std::memory_order_release);
+    }
+
+    /* Neither side may be active */
+    void reset() {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    struct Entry {
+        std::size_t end_position;
+        uint64_t ns;
+    };
+
+    Entry m_entries[capacity] = {};
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+};
+
+/* Everything measured for one custom device */
+struct AudioLatency {
+    enum Histogram {
+        CaptureCall = 0,     // duration of a per-frame capture call from Java
+        CaptureInterval,     // time between those calls
+        CaptureQueueing,     // time capture data waits in the capture ring
+        CaptureClientlib,    // duration of ts3client_processCustomCaptureData, from Java or the pump
+        PlaybackCall,
+        PlaybackInterval,
+        PlaybackQueueing,    // time prefetched playback waits in the playback buffer
+        PlaybackClientlib,   // duration of ts3client_acquireCustomPlaybackData
+        HistogramCount
+    };
+
+    void record_interval(Histogram histogram, std::atomic<uint64_t>& last, uint64_t now) {
+        const auto previous = last.exchange(now, std::memory_order_relaxed);
+        if (previous != 0 && now > previous)
+            histograms[histogram].record(now - previous);
+    }
+
+    void reset() {
+        for (auto& histogram : histograms)
+            histogram.reset();
+        last_capture_call.store(0, std::memory_order_relaxed);
+        last_playback_call.store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram histograms[HistogramCount];
+    std::atomic<uint64_t> last_capture_call{0};
+    std::atomic<uint64_t> last_playback_call{0};
+    ChunkTimestamps capture_chunks;
+    ChunkTimestamps playback_chunks;
+};
@@ -0,0 +1,148 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "audio_pump.h"
+
+#include "teamspeak/clientlib.h"
+#include "teamspeak/public_errors.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+/* Same value as android.os.Process.THREAD_PRIORITY_URGENT_AUDIO */
+static constexpr int urgent_audio_nice = -19;
+
+static void raise_priority() {
+    sched_param param = {};
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0)
+        return;
+    // Without the permission for realtime scheduling use the best nice value we are allowed to
+    const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    for (int nice = urgent_audio_nice; nice < 0; ++nice) {
+        if (setpriority(PRIO_PROCESS, tid, nice) == 0)
+            return;
+    }
+}
+
+static int frames_per_period(int frequency, int channels, int period_ms) {
+    return channels > 0 ? frequency * period_ms / 1000 : 0;
+}
+
+static uint64_t to_ns(const timespec& time) {
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000u + static_cast<uint64_t>(time.tv_nsec);
+}
+
+bool AudioPump::start(const CustomDevice& device, std::unique_ptr<AudioBackend> backend, int period_ms, AudioLatency* latency) {
+    if (m_running.load() || !backend || period_ms <= 0)
+        return false;
+
+    const AudioBackend::Format format = {
+            device.capture_frequency,
+            device.capture_channels,
+            device.playback_frequency,
+            device.playback_channels,
+            period_ms
+    };
+    if (!backend->open(format))
+        return false;
+
+    m_device = device;
+    m_backend = std::move(backend);
+    m_period_ms = period_ms;
+    m_latency = latency;
+    m_capture.assign(static_cast<std::size_t>(frames_per_period(device.capture_frequency, device.capture_channels, period_ms)) * device.capture_channels, 0);
+    m_playback.assign(static_cast<std::size_t>(frames_per_period(device.playback_frequency, device.playback_channels, period_ms)) * device.playback_channels, 0);
+    m_periods.store(0, std::memory_order_relaxed);
+    m_playback_underruns.store(0, std::memory_order_relaxed);
+    m_capture_errors.store(0, std::memory_order_relaxed);
+    m_late_periods.store(0, std::memory_order_relaxed);
+
+    m_running.store(true);
+    m_thread = std::thread(&AudioPump::run, this);
+    return true;
+}
+
+void AudioPump::stop() {
+    if (!m_running.exchange(false))
+        return;
+    m_thread.join();
+    m_backend->close();
+    m_backend.reset();
+}
+
+AudioPump::Counters AudioPump::counters() const {
+    Counters result;
+    result.periods = m_periods.load(std::memory_order_relaxed);
+    result.playback_underruns = m_playback_underruns.load(std::memory_order_relaxed);
+    result.capture_errors = m_capture_errors.load(std::memory_order_relaxed);
+    result.late_periods = m_late_periods.load(std::memory_order_relaxed);
+    return result;
+}
+
+void AudioPump::pump(int capture_frames, int playback_frames) {
+    if (capture_frames > 0) {
+        const auto frames = m_backend->read_capture(m_capture.data(), capture_frames);
+        if (frames > 0) {
+            const auto start = m_latency ? monotonic_ns() : 0;
+            if (ts3client_processCustomCaptureData(m_device.id, m_capture.data(), frames) != ERROR_ok)
+                m_capture_errors.fetch_add(1, std::memory_order_relaxed);
+            if (m_latency)
+                m_latency->histograms[AudioLatency::CaptureClientlib].record(monotonic_ns() - start);
+        }
+    }
+    if (playback_frames > 0) {
+        for (auto wanted = m_backend->playback_frames_wanted(playback_frames); wanted > 0; wanted -= playback_frames) {
+            const auto frames = std::min(wanted, playback_frames);
+            const auto start = m_latency ? monotonic_ns() : 0;
+            if (ts3client_acquireCustomPlaybackData(m_device.id, m_playback.data(), frames) != ERROR_ok) {
+                std::memset(m_playback.data(), 0, m_playback.size() * sizeof(short));
+                m_playback_underruns.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (m_latency)
+                m_latency->histograms[AudioLatency::PlaybackClientlib].record(monotonic_ns() - start);
+            m_backend->write_playback(m_playback.data(), frames);
+        }
+    }
+    m_periods.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioPump::run() {
+    raise_priority();
+
+    const auto capture_frames = frames_per_period(m_device.capture_frequency, m_device.capture_channels, m_period_ms);
+    const auto playback_frames = frames_per_period(m_device.playback_frequency, m_device.playback_channels, m_period_ms);
+    const auto period_ns = static_cast<uint64_t>(m_period_ms) * 1000000u;
+    const bool self_paced = !m_backend->paces();
+
+    timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (m_running.load(std::memory_order_relaxed)) {
+        pump(capture_frames, playback_frames);
+        if (!self_paced)
+            continue;
+
+        // Absolute deadlines, so the processing time does not add up as drift
+        auto deadline = to_ns(next) + period_ns;
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (to_ns(now) > deadline + period_ns) {
+            // Too late to catch up without bursting, start over from now
+            m_late_periods.fetch_add(1, std::memory_order_relaxed);
+            deadline = to_ns(now);
+        }
+        next.tv_sec = static_cast<time_t>(deadline / 1000000000u);
+        next.tv_nsec = static_cast<long>(deadline % 1000000000u);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr) == EINTR) {}
+    }
+}
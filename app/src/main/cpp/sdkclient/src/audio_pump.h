@@ -0,0 +1,62 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Moves PCM between a custom sound device and an AudioBackend on a native high priority thread, so no
+ * per-buffer JNI call is needed while the device is pumped.
+ */
+#pragma once
+
+#include "audio_backend.h"
+#include "custom_device.h"
+#include "audio_latency.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class AudioPump {
+public:
+    struct Counters {
+        uint64_t periods;
+        uint64_t playback_underruns;  // the clientlib had no playback data
+        uint64_t capture_errors;      // processCustomCaptureData failed
+        uint64_t late_periods;        // the thread woke up more than one period late
+    };
+
+    AudioPump() = default;
+    AudioPump(const AudioPump&) = delete;
+    AudioPump& operator=(const AudioPump&) = delete;
+    ~AudioPump() { stop(); }
+
+    /*
+     * Takes ownership of backend, exchanges period_ms worth of samples per direction and period. The
+     * clientlib calls are timed into latency if given.
+     */
+    bool start(const CustomDevice& device, std::unique_ptr<AudioBackend> backend, int period_ms, AudioLatency* latency = nullptr);
+    void stop();
+    bool is_running() const { return m_running.load(std::memory_order_relaxed); }
+
+    Counters counters() const;
+
+private:
+    void run();
+    void pump(int capture_frames, int playback_frames);
+
+    CustomDevice m_device = {};
+    std::unique_ptr<AudioBackend> m_backend;
+    int m_period_ms = 0;
+    AudioLatency* m_latency = nullptr;
+    std::vector<short> m_capture;
+    std::vector<short> m_playback;
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+
+    std::atomic<uint64_t> m_periods{0};
+    std::atomic<uint64_t> m_playback_underruns{0};
+    std::atomic<uint64_t> m_capture_errors{0};
+    std::atomic<uint64_t> m_late_periods{0};
+};
@@ -0,0 +1,155 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "connection_sampler.h"
+#include "audio_latency.h"
+
+#include <pthread.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+static constexpr double not_available = std::numeric_limits<double>::quiet_NaN();
+
+bool ConnectionSampler::start(Read read, std::size_t variables, int interval_ms, std::size_t history) {
+    if (m_thread.joinable() || !read || variables == 0 || interval_ms < min_interval_ms || history == 0 || history > max_history)
+        return false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_read = read;
+        m_variables = variables;
+        m_history = history;
+        m_interval_ms = interval_ms;
+        m_stopping = false;
+        for (auto& target : m_targets) {
+            target.second.samples.clear();
+            target.second.next = 0;
+            target.second.count = 0;
+        }
+    }
+    m_thread = std::thread(&ConnectionSampler::run, this);
+    return true;
+}
+
+void ConnectionSampler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+bool ConnectionSampler::is_running() const {
+    return m_thread.joinable();
+}
+
+void ConnectionSampler::watch(uint64_t connection, uint16_t client) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& target = m_targets[connection];
+    if (target.client != client) {
+        target.client = client;
+        target.next = 0;
+        target.count = 0;
+    }
+}
+
+void ConnectionSampler::unwatch(uint64_t connection) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_targets.erase(connection);
+}
+
+template <typename Visit>
+void ConnectionSampler::rows(const Target& target, Visit&& visit) const {
+    const auto row_size = 1 + m_variables;
+    auto row = (target.next + m_history - target.count) % m_history;
+    for (std::size_t i = 0; i < target.count; ++i, row = (row + 1) % m_history)
+        visit(target.samples.data() + row * row_size);
+}
+
+bool ConnectionSampler::history(uint64_t connection, double since_ms, std::vector<double>& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_targets.find(connection);
+    if (it == m_targets.end())
+        return false;
+    const auto row_size = 1 + m_variables;
+    rows(it->second, [&](const double* row) {
+        if (row[0] > since_ms)
+            out.insert(out.end(), row, row + row_size);
+    });
+    return true;
+}
+
+bool ConnectionSampler::percentiles(uint64_t connection, std::size_t variable, const int* permilles, std::size_t count, double* out) const {
+    std::vector<double> values;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_targets.find(connection);
+        if (it == m_targets.end() || variable >= m_variables)
+            return false;
+        values.reserve(it->second.count);
+        rows(it->second, [&](const double* row) {
+            if (!std::isnan(row[1 + variable]))
+                values.push_back(row[1 + variable]);
+        });
+    }
+    std::sort(values.begin(), values.end());
+    for (std::size_t i = 0; i < count; ++i) {
+        if (values.empty() || permilles[i] < 0 || permilles[i] > 1000) {
+            out[i] = not_available;
+            continue;
+        }
+        const auto rank = (values.size() * static_cast<std::size_t>(permilles[i]) + 999) / 1000;
+        out[i] = values[rank == 0 ? 0 : rank - 1];
+    }
+    return true;
+}
+
+void ConnectionSampler::record(uint64_t connection, uint16_t client, const std::vector<double>& row) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_targets.find(connection);
+    // Unwatched or watched for another client while the variables were read
+    if (it == m_targets.end() || it->second.client != client)
+        return;
+    auto& target = it->second;
+    if (target.samples.empty())
+        target.samples.resize(m_history * row.size());
+    std::copy(row.begin(), row.end(), target.samples.begin() + static_cast<std::ptrdiff_t>(target.next * row.size()));
+    target.next = (target.next + 1) % m_history;
+    target.count = std::min(target.count + 1, m_history);
+}
+
+void ConnectionSampler::run() {
+    pthread_setname_np(pthread_self(), "ts3 stats");
+    const auto interval = std::chrono::milliseconds(m_interval_ms);
+    std::vector<std::pair<uint64_t, uint16_t>> targets;
+    std::vector<double> row(1 + m_variables);
+    auto deadline = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        targets.clear();
+        for (const auto& target : m_targets)
+            targets.emplace_back(target.first, target.second.client);
+        lock.unlock();
+
+        // The clientlib is read without the lock, so watch and history never wait for it
+        for (const auto& target : targets) {
+            row[0] = static_cast<double>(monotonic_ns()) / 1e6;
+            std::fill(row.begin() + 1, row.end(), not_available);
+            if (m_read(target.first, target.second, row.data() + 1))
+                record(target.first, target.second, row);
+        }
+
+        // Behind by more than an interval, skip the missed ticks instead of bursting
+        deadline = std::max(deadline + interval, std::chrono::steady_clock::now());
+        lock.lock();
+        m_wake.wait_until(lock, deadline, [this] { return m_stopping; });
+    }
+}
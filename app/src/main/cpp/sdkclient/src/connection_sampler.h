@@ -0,0 +1,72 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Records the connection variables of watched connections at a fixed rate on a native thread, so ping and
+ * packet loss history and percentiles are available without Java polling them. Each connection keeps the
+ * last history samples in a ring, a sample is the monotonic time in ms followed by the variables.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class ConnectionSampler {
+public:
+    /* Fills the variables of client on connection, false if there is nothing to record */
+    using Read = bool (*)(uint64_t connection, uint16_t client, double* values);
+
+    static constexpr int min_interval_ms = 10;
+    static constexpr std::size_t max_history = 86400;
+
+    ConnectionSampler() = default;
+    ConnectionSampler(const ConnectionSampler&) = delete;
+    ConnectionSampler& operator=(const ConnectionSampler&) = delete;
+    ~ConnectionSampler() { stop(); }
+
+    /* Samples every interval_ms until stop, restarting drops the recorded history */
+    bool start(Read read, std::size_t variables, int interval_ms, std::size_t history);
+    void stop();
+    bool is_running() const;
+
+    /* Samples connection from the next tick on, watching it again only replaces the client */
+    void watch(uint64_t connection, uint16_t client);
+    void unwatch(uint64_t connection);
+
+    /* Appends the samples taken after since_ms to out, false if the connection is not watched */
+    bool history(uint64_t connection, double since_ms, std::vector<double>& out) const;
+
+    /* Nearest rank percentiles of variable over the recorded samples, NaN if there are none */
+    bool percentiles(uint64_t connection, std::size_t variable, const int* permilles, std::size_t count, double* out) const;
+
+private:
+    struct Target {
+        uint16_t client = 0;
+        std::vector<double> samples;  // ring of m_history rows, allocated on the first sample
+        std::size_t next = 0;
+        std::size_t count = 0;
+    };
+
+    void run();
+    void record(uint64_t connection, uint16_t client, const std::vector<double>& row);
+    /* Calls visit for the recorded rows of target, oldest first */
+    template <typename Visit>
+    void rows(const Target& target, Visit&& visit) const;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+    std::thread m_thread;
+
+    Read m_read = nullptr;
+    std::size_t m_variables = 0;
+    std::size_t m_history = 0;
+    int m_interval_ms = 0;
+    std::unordered_map<uint64_t, Target> m_targets;
+};
@@ -0,0 +1,96 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "custom_device.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+CustomDeviceTable::Reader::Reader(const CustomDeviceTable& table) : m_table(table) {
+    // The writer flips the epoch only after publishing, so a reader that registers on a stale epoch
+    // still loads a snapshot the writer waits for
+    m_epoch = table.m_epoch.load() & 1u;
+    table.m_readers[m_epoch].fetch_add(1);
+    m_snapshot = table.m_current.load();
+}
+
+CustomDeviceTable::Reader::~Reader() {
+    m_table.m_readers[m_epoch].fetch_sub(1, std::memory_order_release);
+}
+
+const CustomDevice* CustomDeviceTable::Reader::get(int handle) const {
+    if (handle < 0 || handle >= max_devices || !m_snapshot->used[handle])
+        return nullptr;
+    return &m_snapshot->devices[handle];
+}
+
+CustomDeviceTable::CustomDeviceTable() : m_current(new Snapshot()) {}
+
+CustomDeviceTable::~CustomDeviceTable() {
+    delete m_current.load();
+}
+
+int CustomDeviceTable::add(const CustomDevice& device) {
+    if (strnlen(device.id, sizeof(device.id)) > CustomDevice::max_id_length)
+        return -1;
+
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    const auto existing = find(device.id);
+    const auto* current = m_current.load(std::memory_order_relaxed);
+    for (int handle = 0; handle < max_devices; ++handle) {
+        if (handle == existing || (existing < 0 && !current->used[handle])) {
+            auto* next = new Snapshot(*current);
+            next->devices[handle] = device;
+            next->used[handle] = true;
+            publish(next);
+            return handle;
+        }
+    }
+    return -1;
+}
+
+void CustomDeviceTable::remove(int handle) {
+    if (handle < 0 || handle >= max_devices)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    const auto* current = m_current.load(std::memory_order_relaxed);
+    if (!current->used[handle])
+        return;
+    auto* next = new Snapshot(*current);
+    next->used[handle] = false;
+    publish(next);
+}
+
+int CustomDeviceTable::find(const char* id) const {
+    Reader reader(*this);
+    for (int handle = 0; handle < max_devices; ++handle) {
+        const auto* device = reader.get(handle);
+        if (device && std::strcmp(device->id, id) == 0)
+            return handle;
+    }
+    return -1;
+}
+
+void CustomDeviceTable::publish(Snapshot* next) {
+    const auto* previous = m_current.exchange(next);
+    synchronize();
+    delete previous;
+}
+
+void CustomDeviceTable::synchronize() {
+    // Two flips: readers of either parity that started before the publication have left
+    for (int phase = 0; phase < 2; ++phase) {
+        const auto epoch = m_epoch.fetch_add(1) & 1u;
+        for (unsigned int spin = 0; m_readers[epoch].load(std::memory_order_acquire) != 0; ++spin) {
+            if (spin < 64)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
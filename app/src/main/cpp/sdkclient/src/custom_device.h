@@ -0,0 +1,118 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Custom sound devices registered through the wrapper, addressed by a small integer handle so the per-frame
+ * calls neither touch Java strings nor hash device IDs.
+ *
+ * The table is read from the audio threads while Java registers and unregisters devices. Writers publish
+ * a new immutable snapshot and free the old one after a grace period, readers only increment and
+ * decrement a counter and never wait.
+ */
+#pragma once
+
+#include "sample_convert.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+struct CustomDevice {
+    static constexpr std::size_t max_id_length = 127;
+
+    char id[max_id_length + 1];
+    int capture_frequency;
+    int capture_channels;
+    int playback_frequency;
+    int playback_channels;
+    void* capture_buffer;
+    std::size_t capture_buffer_size;
+    void* playback_buffer;
+    std::size_t playback_buffer_size;
+
+    /* Layout of the Java buffers, see SampleEncoding. Int16 at the clientlib channel count unless changed. */
+    int capture_buffer_encoding;
+    int capture_buffer_channels;
+    int playback_buffer_encoding;
+    int playback_buffer_channels;
+    /* Rates of the Java buffers, resampled to the clientlib rates above if they differ */
+    int capture_buffer_frequency;
+    int playback_buffer_frequency;
+    int resampler_quality;
+
+    bool converts_capture() const {
+        return capture_buffer_encoding != SampleEncoding_Int16 || capture_buffer_channels != capture_channels;
+    }
+    bool converts_playback() const {
+        return playback_buffer_encoding != SampleEncoding_Int16 || playback_buffer_channels != playback_channels;
+    }
+    bool resamples_capture() const { return capture_buffer_frequency != capture_frequency; }
+    bool resamples_playback() const { return playback_buffer_frequency != playback_frequency; }
+    bool capture_buffer_fits(int frames) const {
+        return frames >= 0 && static_cast<std::size_t>(frames) * capture_buffer_channels * bytes_per_sample(capture_buffer_encoding) <= capture_buffer_size;
+    }
+    bool playback_buffer_fits(int frames) const {
+        return frames >= 0 && static_cast<std::size_t>(frames) * playback_buffer_channels * bytes_per_sample(playback_buffer_encoding) <= playback_buffer_size;
+    }
+};
+
+class CustomDeviceTable {
+    struct Snapshot;
+
+public:
+    static constexpr int max_devices = 8;
+
+    /*
+     * Keeps the current snapshot alive for its lifetime. Pointers returned by get are valid until the
+     * Reader is destroyed, even if the device is unregistered meanwhile. Wait-free.
+     */
+    class Reader {
+    public:
+        explicit Reader(const CustomDeviceTable& table);
+        ~Reader();
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        /* Returns nullptr for an invalid or unregistered handle */
+        const CustomDevice* get(int handle) const;
+
+    private:
+        const CustomDeviceTable& m_table;
+        unsigned int m_epoch;
+        const Snapshot* m_snapshot;
+    };
+
+    CustomDeviceTable();
+    ~CustomDeviceTable();
+    CustomDeviceTable(const CustomDeviceTable&) = delete;
+    CustomDeviceTable& operator=(const CustomDeviceTable&) = delete;
+
+    /* Returns the handle of the new device, -1 if the table is full or id too long. May wait for readers. */
+    int add(const CustomDevice& device);
+    /* May wait for readers */
+    void remove(int handle);
+
+    /* Returns -1 if no device with this id is registered. Wait-free. */
+    int find(const char* id) const;
+
+    bool contains(int handle) const { return Reader(*this).get(handle) != nullptr; }
+
+private:
+    struct Snapshot {
+        CustomDevice devices[max_devices];
+        bool used[max_devices];
+    };
+
+    /* Publishes next and frees the previous snapshot once no reader can still see it. Caller holds m_write_mutex. */
+    void publish(Snapshot* next);
+    void synchronize();
+
+    std::atomic<const Snapshot*> m_current;
+    std::mutex m_write_mutex;
+
+    alignas(64) std::atomic<unsigned int> m_epoch{0};
+    /* Readers inside a read section, per epoch parity */
+    alignas(64) mutable std::atomic<uint32_t> m_readers[2] = {};
+};
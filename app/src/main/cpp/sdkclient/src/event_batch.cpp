@@ -0,0 +1,137 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "event_batch.h"
+
+#include <cstring>
+
+namespace {
+    constexpr std::size_t record_header_size = 8;
+
+    std::size_t align8(std::size_t size) { return (size + 7) & ~std::size_t{7}; }
+}
+
+void EventBatchWriter::configure(JNIEnv* env, jobject batch, bool copy) {
+    jobject ref = batch ? env->NewGlobalRef(batch) : nullptr;
+    m_copy.store(copy, std::memory_order_relaxed);
+    if (jobject superseded = m_pending.exchange(ref))
+        env->DeleteGlobalRef(superseded);
+    m_reconfigure.store(true, std::memory_order_release);
+}
+
+void EventBatchWriter::begin(JNIEnv* env) {
+    if (!m_reconfigure.exchange(false, std::memory_order_acquire))
+        return;
+
+    if (m_batch)
+        env->DeleteGlobalRef(m_batch);
+    m_batch = m_pending.exchange(nullptr);
+    m_buffer = nullptr;
+    m_capacity = 0;
+    m_size = 0;
+    m_count = 0;
+    if (m_batch && m_copy.load(std::memory_order_relaxed))
+        copy_batch(env);
+    if (!m_batch)
+        return;
+
+    jclass cls = env->GetObjectClass(m_batch);
+    jfieldID buffer_field = env->GetFieldID(cls, "buffer", "Ljava/nio/ByteBuffer;");
+    m_deliver = env->GetMethodID(cls, "deliver", "(II)V");
+    jobject buffer = buffer_field ? env->GetObjectField(m_batch, buffer_field) : nullptr;
+    if (buffer && m_deliver) {
+        m_buffer = static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer));
+        m_capacity = static_cast<std::size_t>(env->GetDirectBufferCapacity(buffer));
+    }
+    if (env->ExceptionCheck())
+        env->ExceptionClear();
+    env->DeleteLocalRef(buffer);
+    env->DeleteLocalRef(cls);
+    if (!m_buffer) {
+        env->DeleteGlobalRef(m_batch);
+        m_batch = nullptr;
+    }
+}
+
+void EventBatchWriter::consume(JNIEnv* env, const EventRecord& record) {
+    if (!m_batch) {
+        record.dispatch(env, record);
+        return;
+    }
+
+    std::size_t text_size = 0;
+    for (uint8_t i = 0; i < record.count; ++i) {
+        if ((record.string_mask & (1u << i)) && record.values[i] != EventRecord::null_string)
+            text_size += std::strlen(record.text + record.values[i]);
+    }
+    const std::size_t slots_end = record_header_size + record.count * sizeof(int64_t);
+    const std::size_t size = align8(slots_end + text_size);
+    if (size > m_capacity - m_size)
+        flush(env);
+    if (size > m_capacity) {
+        // does not fit into an empty batch either
+        record.dispatch(env, record);
+        return;
+    }
+
+    uint8_t* out = m_buffer + m_size;
+    const auto record_size = static_cast<uint32_t>(size);
+    std::memcpy(out, &record_size, sizeof(record_size));
+    out[4] = record.type;
+    out[5] = record.count;
+    out[6] = out[7] = 0;
+
+    std::size_t text_pos = slots_end;
+    for (uint8_t i = 0; i < record.count; ++i) {
+        int64_t slot = static_cast<int64_t>(record.values[i]);
+        if (record.string_mask & (1u << i)) {
+            if (record.values[i] == EventRecord::null_string) {
+                slot = -1;
+            } else {
+                const char* text = record.text + record.values[i];
+                const std::size_t length = std::strlen(text);
+                std::memcpy(out + text_pos, text, length);
+                slot = static_cast<int64_t>((uint64_t{text_pos} << 32) | length);
+                text_pos += length;
+            }
+        }
+        std::memcpy(out + record_header_size + i * sizeof(int64_t), &slot, sizeof(slot));
+    }
+    m_size += size;
+    ++m_count;
+}
+
+void EventBatchWriter::copy_batch(JNIEnv* env) {
+    jclass cls = env->GetObjectClass(m_batch);
+    jfieldID buffer_field = env->GetFieldID(cls, "buffer", "Ljava/nio/ByteBuffer;");
+    jmethodID constructor = env->GetMethodID(cls, "<init>", "(I)V");
+    jobject buffer = buffer_field ? env->GetObjectField(m_batch, buffer_field) : nullptr;
+    const auto capacity = buffer ? env->GetDirectBufferCapacity(buffer) : -1;
+    jobject copy = constructor && capacity > 0 ? env->NewObject(cls, constructor, static_cast<jint>(capacity)) : nullptr;
+    if (env->ExceptionCheck())
+        env->ExceptionClear();
+    env->DeleteGlobalRef(m_batch);
+    m_batch = copy ? env->NewGlobalRef(copy) : nullptr;
+    env->DeleteLocalRef(copy);
+    env->DeleteLocalRef(buffer);
+    env->DeleteLocalRef(cls);
+}
+
+void EventBatchWriter::end(JNIEnv* env) {
+    flush(env);
+}
+
+void EventBatchWriter::flush(JNIEnv* env) {
+    if (!m_count)
+        return;
+    env->CallVoidMethod(m_batch, m_deliver, static_cast<jint>(m_size), m_count);
+    if (env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+    m_size = 0;
+    m_count = 0;
+}
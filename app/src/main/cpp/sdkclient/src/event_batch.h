@@ -0,0 +1,58 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Optional event delivery mode: the dispatcher thread serializes the queued events into the direct
+ * ByteBuffer of a Java EventBatch object and hands over the whole batch with a single call.
+ *
+ * Record layout, native byte order, every record starts 8 byte aligned:
+ *   u32 size        record size in bytes including padding
+ *   u8  type        EventType
+ *   u8  count       number of arguments
+ *   u16 reserved
+ *   i64 slots[count]
+ *                   integral arguments, or (offset << 32 | length) of a string argument relative to the
+ *                   record start, -1 for a null string
+ *   u8  text[]      UTF-8 string bytes, not terminated
+ */
+#pragma once
+
+#include <jni.h>
+#include "event_queue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class EventBatchWriter : public EventSink {
+public:
+    /*
+     * Switches to batch delivery into batch, an EventBatch object, or back to one object per event if
+     * batch is null. With copy the dispatcher thread delivers through a new EventBatch of the same
+     * capacity instead, so several dispatcher threads never share a buffer. Takes effect with the next
+     * pass of the dispatcher thread.
+     */
+    void configure(JNIEnv* env, jobject batch, bool copy = false);
+
+    void begin(JNIEnv* env) override;
+    void consume(JNIEnv* env, const EventRecord& record) override;
+    void end(JNIEnv* env) override;
+
+private:
+    void flush(JNIEnv* env);
+    /* Replaces m_batch by a new object of its class and buffer capacity */
+    void copy_batch(JNIEnv* env);
+
+    std::atomic<jobject> m_pending{nullptr};
+    std::atomic<bool> m_copy{false};
+    std::atomic<bool> m_reconfigure{false};
+
+    // only touched by the dispatcher thread
+    jobject m_batch = nullptr;
+    jmethodID m_deliver = nullptr;
+    uint8_t* m_buffer = nullptr;
+    std::size_t m_capacity = 0;
+    std::size_t m_size = 0;
+    jint m_count = 0;
+};
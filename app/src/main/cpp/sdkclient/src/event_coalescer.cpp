@@ -0,0 +1,153 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "event_coalescer.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace {
+    // argument positions, see ClientUIFunctions
+    constexpr int talk_status_client_arg = 3;
+    constexpr int subscription_client_arg = 1;
+    constexpr int subscription_old_channel_arg = 2;
+    constexpr int subscription_visibility_arg = 4;
+
+    bool is_coalescable(EventType type) {
+        return type == EventType_TalkStatusChange || type == EventType_ClientMoveSubscription;
+    }
+
+    uint64_t key_of(const EventRecord& record) {
+        const auto client_arg = record.type == EventType_TalkStatusChange ? talk_status_client_arg : subscription_client_arg;
+        return (record.values[0] << 24) | (uint64_t{record.type} << 16) | (record.values[client_arg] & 0xFFFF);
+    }
+}
+
+bool EventCoalescer::set_window(EventType type, std::chrono::milliseconds window) {
+    if (!is_coalescable(type) || window.count() < 0)
+        return false;
+    m_window_ms[type].store(static_cast<uint32_t>(window.count()), std::memory_order_relaxed);
+    return true;
+}
+
+bool EventCoalescer::offer(const EventRecord& record, Clock::time_point now, const Deliver& deliver) {
+    const auto window_ms = is_coalescable(record.type) ? m_window_ms[record.type].load(std::memory_order_relaxed) : 0;
+    if (window_ms == 0) {
+        if (!m_pending.empty() && record.type != EventType_UserLoggingMessage)
+            flush_connection(record.values[0], deliver);
+        return false;
+    }
+
+    const auto connection = record.values[0];
+    const auto pending_type = m_connections.find(connection);
+    if (pending_type != m_connections.end() && pending_type->second.type != record.type)
+        flush_connection(connection, deliver);
+
+    const auto key = key_of(record);
+    auto it = m_pending.find(key);
+    if (it == m_pending.end()) {
+        Pending pending;
+        pending.dispatch = record.dispatch;
+        pending.type = record.type;
+        pending.count = record.count;
+        std::copy(record.values, record.values + record.count, pending.values);
+        pending.sequence = m_sequence++;
+        pending.queued_ns = record.queued_ns;
+        pending.deadline = now + std::chrono::milliseconds(window_ms);
+        m_pending.emplace(key, pending);
+        auto& connection_pending = m_connections[connection];
+        connection_pending.type = record.type;
+        ++connection_pending.count;
+        m_pending_count.store(m_pending.size(), std::memory_order_relaxed);
+        m_next_deadline = std::min(m_next_deadline, pending.deadline);
+        return true;
+    }
+
+    auto& pending = it->second;
+    if (record.type == EventType_ClientMoveSubscription) {
+        const auto first_visibility = pending.values[subscription_visibility_arg];
+        const auto visibility = record.values[subscription_visibility_arg];
+        if (first_visibility == ENTER_VISIBILITY && visibility == LEAVE_VISIBILITY) {
+            // appeared and vanished within the window
+            erase_pending(it);
+            m_pending_count.store(m_pending.size(), std::memory_order_relaxed);
+            m_eliminated.fetch_add(2, std::memory_order_relaxed);
+            update_deadline();
+            return true;
+        }
+        const auto old_channel = pending.values[subscription_old_channel_arg];
+        std::copy(record.values, record.values + record.count, pending.values);
+        pending.values[subscription_old_channel_arg] = old_channel;
+        if (first_visibility == ENTER_VISIBILITY)
+            pending.values[subscription_visibility_arg] = ENTER_VISIBILITY;
+    } else {
+        std::copy(record.values, record.values + record.count, pending.values);
+    }
+    m_eliminated.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void EventCoalescer::flush_expired(Clock::time_point now, const Deliver& deliver) {
+    if (now < m_next_deadline)
+        return;
+    flush_if([now](const Pending& pending) { return pending.deadline <= now; }, deliver);
+}
+
+void EventCoalescer::flush_all(const Deliver& deliver) {
+    flush_if([](const Pending&) { return true; }, deliver);
+}
+
+void EventCoalescer::flush_connection(uint64_t connection, const Deliver& deliver) {
+    if (m_connections.find(connection) == m_connections.end())
+        return;
+    flush_if([connection](const Pending& pending) { return pending.values[0] == connection; }, deliver);
+}
+
+void EventCoalescer::erase_pending(std::unordered_map<uint64_t, Pending>::iterator it) {
+    const auto connection = m_connections.find(it->second.values[0]);
+    if (connection != m_connections.end() && --connection->second.count == 0)
+        m_connections.erase(connection);
+    m_pending.erase(it);
+}
+
+template <typename Predicate>
+void EventCoalescer::flush_if(Predicate&& predicate, const Deliver& deliver) {
+    std::vector<Pending> due;
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (predicate(it->second)) {
+            due.push_back(it->second);
+            const auto next = std::next(it);
+            erase_pending(it);
+            it = next;
+        } else {
+            ++it;
+        }
+    }
+    if (due.empty())
+        return;
+    m_pending_count.store(m_pending.size(), std::memory_order_relaxed);
+    update_deadline();
+
+    std::sort(due.begin(), due.end(), [](const Pending& a, const Pending& b) { return a.sequence < b.sequence; });
+    EventRecord record;
+    record.string_mask = 0;
+    record.text_size = 0;
+    for (const auto& pending : due) {
+        record.dispatch = pending.dispatch;
+        record.type = pending.type;
+        record.count = pending.count;
+        record.queued_ns = pending.queued_ns;
+        std::copy(pending.values, pending.values + pending.count, record.values);
+        deliver(record);
+    }
+}
+
+void EventCoalescer::update_deadline() {
+    m_next_deadline = Clock::time_point::max();
+    for (const auto& entry : m_pending)
+        m_next_deadline = std::min(m_next_deadline, entry.second.deadline);
+}
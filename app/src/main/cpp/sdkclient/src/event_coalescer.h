@@ -0,0 +1,82 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Collapses bursts of onTalkStatusChangeEvent and onClientMoveSubscriptionEvent per (server connection handler,
+ * client) on the dispatcher thread, before they cross JNI. Each type has its own time window, 0 disables it.
+ *
+ * Events of one server connection keep their order, with one exception: within a type, the coalesced event
+ * of a client is delivered in the place of its first event in the window. A connection only has pending
+ * events of one type, an event of another type delivers them first.
+ */
+#pragma once
+
+#include "jni_event.h"
+#include "event_record.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+class EventCoalescer {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Deliver = std::function<void(const EventRecord&)>;
+
+    /* Returns false if events of this type can not be coalesced */
+    bool set_window(EventType type, std::chrono::milliseconds window);
+
+    /*
+     * Takes ownership of record if its type is coalesced, after delivering pending events of the same
+     * server connection and another type. Otherwise delivers all pending events of the same server
+     * connection first and returns false.
+     */
+    bool offer(const EventRecord& record, Clock::time_point now, const Deliver& deliver);
+
+    /* Delivers the pending events whose window ended, in arrival order */
+    void flush_expired(Clock::time_point now, const Deliver& deliver);
+    void flush_all(const Deliver& deliver);
+
+    /* End of the earliest pending window, Clock::time_point::max() if nothing is pending */
+    Clock::time_point next_deadline() const { return m_next_deadline; }
+
+    uint64_t pending() const { return m_pending_count.load(std::memory_order_relaxed); }
+    uint64_t eliminated() const { return m_eliminated.load(std::memory_order_relaxed); }
+
+private:
+    struct Pending {
+        EventRecord::Dispatch dispatch;
+        EventType type;
+        uint8_t count;
+        uint64_t values[EventRecord::max_values];
+        uint64_t sequence;
+        uint64_t queued_ns;  // of the first record, the latency covers the whole window
+        Clock::time_point deadline;
+    };
+
+    /* The type of the pending events of a server connection */
+    struct ConnectionPending {
+        EventType type;
+        std::size_t count;
+    };
+
+    template <typename Predicate>
+    void flush_if(Predicate&& predicate, const Deliver& deliver);
+    void flush_connection(uint64_t connection, const Deliver& deliver);
+    void erase_pending(std::unordered_map<uint64_t, Pending>::iterator it);
+    void update_deadline();
+
+    std::atomic<uint32_t> m_window_ms[EventType_Count] = {};
+
+    // only touched by the dispatcher thread
+    std::unordered_map<uint64_t, Pending> m_pending;
+    std::unordered_map<uint64_t, ConnectionPending> m_connections;
+    uint64_t m_sequence = 0;
+    Clock::time_point m_next_deadline = Clock::time_point::max();
+
+    std::atomic<uint64_t> m_pending_count{0};
+    std::atomic<uint64_t> m_eliminated{0};
+};
@@ -0,0 +1,95 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "event_dispatch.h"
+
+#include <algorithm>
+
+EventDispatch::EventDispatch() {
+    for (std::size_t i = 0; i < max_shards; ++i)
+        m_queues[i].set_sink(&m_batches[i]);
+}
+
+bool EventDispatch::set_shards(std::size_t count) {
+    if (count == 0 || count > max_shards)
+        return false;
+    m_configured.store(count, std::memory_order_relaxed);
+    return true;
+}
+
+bool EventDispatch::start(std::size_t capacity, JNIEnv* (*attach)()) {
+    auto count = m_configured.load(std::memory_order_relaxed);
+    if (!m_queues[0].start(capacity, attach))
+        return false;
+    for (std::size_t i = 1; i < count; ++i) {
+        if (!m_queues[i].start(capacity, attach)) {
+            count = i;
+            break;
+        }
+    }
+    m_active.store(count, std::memory_order_relaxed);
+    return true;
+}
+
+void EventDispatch::stop() {
+    for (auto& queue : m_queues)
+        queue.stop();
+}
+
+void EventDispatch::set_overflow(EventQueueOverflow policy) {
+    for (auto& queue : m_queues)
+        queue.set_overflow(policy);
+}
+
+bool EventDispatch::set_coalescing_window(EventType type, std::chrono::milliseconds window) {
+    for (auto& queue : m_queues) {
+        if (!queue.coalescer().set_window(type, window))
+            return false;
+    }
+    return true;
+}
+
+void EventDispatch::set_batch(JNIEnv* env, jobject batch) {
+    for (std::size_t i = 0; i < max_shards; ++i)
+        m_batches[i].configure(env, batch, i != 0);
+}
+
+EventQueue::Counters EventDispatch::counters() const {
+    EventQueue::Counters result = {};
+    for (const auto& queue : m_queues) {
+        const auto counters = queue.counters();
+        result.depth += counters.depth;
+        result.high_water = std::max(result.high_water, counters.high_water);
+        result.dispatched += counters.dispatched;
+        result.dropped += counters.dropped;
+        result.coalesced += counters.coalesced;
+    }
+    return result;
+}
+
+uint64_t EventDispatch::coalescing_pending() const {
+    uint64_t result = 0;
+    for (const auto& queue : m_queues)
+        result += queue.coalescer().pending();
+    return result;
+}
+
+uint64_t EventDispatch::coalescing_eliminated() const {
+    uint64_t result = 0;
+    for (const auto& queue : m_queues)
+        result += queue.coalescer().eliminated();
+    return result;
+}
+
+void EventDispatch::latency_snapshot(EventType type, int64_t* out, bool reset) {
+    LatencyHistogram total;
+    for (auto& queue : m_queues) {
+        total.merge(queue.latency(type));
+        if (reset)
+            queue.latency(type).reset();
+    }
+    total.snapshot(out);
+}
@@ -0,0 +1,72 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Spreads the forwarded events over up to max_shards EventQueues by server connection handler, each with a
+ * dispatcher thread of its own. All events of a connection go through the same shard, so their order is
+ * kept, while a busy connection only delays the connections sharing its shard. One shard by default.
+ */
+#pragma once
+
+#include <jni.h>
+#include "event_queue.h"
+#include "event_batch.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+class EventDispatch {
+public:
+    static constexpr std::size_t max_shards = 8;
+
+    EventDispatch();
+    EventDispatch(const EventDispatch&) = delete;
+    EventDispatch& operator=(const EventDispatch&) = delete;
+
+    /* Applied by the next start */
+    bool set_shards(std::size_t count);
+
+    /* Starts the shards with capacity records each, false if not even the first one runs */
+    bool start(std::size_t capacity, JNIEnv* (*attach)());
+    void stop();
+
+    /* Shards of the last start */
+    std::size_t shards() const { return m_active.load(std::memory_order_relaxed); }
+    EventQueue& shard(std::size_t index) { return m_queues[index]; }
+
+    /*
+     * EventQueue::push on the shard of connection. Also false on any dispatcher thread: a listener that
+     * blocks on a full shard could otherwise wait for a dispatcher that waits for the listener.
+     */
+    template <typename Fill>
+    bool push(EventType type, uint64 connection, Fill&& fill) {
+        const auto count = m_active.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (m_queues[i].is_dispatcher_thread())
+                return false;
+        }
+        return m_queues[connection % count].push(type, fill);
+    }
+
+    void set_overflow(EventQueueOverflow policy);
+    bool set_coalescing_window(EventType type, std::chrono::milliseconds window);
+    /* Shards beyond the first deliver through EventBatch objects of their own with the capacity of batch */
+    void set_batch(JNIEnv* env, jobject batch);
+
+    /* Summed over the shards, the high water mark is the highest one */
+    EventQueue::Counters counters() const;
+    uint64_t coalescing_pending() const;
+    uint64_t coalescing_eliminated() const;
+
+    /* LatencyHistogram::snapshot over all shards */
+    void latency_snapshot(EventType type, int64_t* out, bool reset);
+
+private:
+    EventQueue m_queues[max_shards];
+    EventBatchWriter m_batches[max_shards];
+    std::atomic<std::size_t> m_configured{1};
+    std::atomic<std::size_t> m_active{1};
+};
@@ -0,0 +1,81 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Which callbacks are forwarded to Java. One bit per EventType, a default mask plus optional overrides
+ * per server connection handler. Readers never block, writers are serialized.
+ */
+#pragma once
+
+#include "jni_event.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+class EventMask {
+public:
+    static constexpr uint32_t all = (1u << EventType_Count) - 1;
+    static constexpr std::size_t max_overrides = 64;
+
+    bool is_enabled(EventType type, uint64 connection) const {
+        uint32_t mask = m_default.load(std::memory_order_relaxed);
+        if (connection != 0 && m_override_count.load(std::memory_order_relaxed) != 0) {
+            for (const auto& entry : m_overrides) {
+                const auto value = entry.load(std::memory_order_acquire);
+                if (value >> mask_bits == connection) {
+                    mask = static_cast<uint32_t>(value & all);
+                    break;
+                }
+            }
+        }
+        return (mask >> type) & 1u;
+    }
+
+    void set_default(uint32_t mask) { m_default.store(mask & all, std::memory_order_relaxed); }
+
+    /* Returns false if there are too many overrides */
+    bool set(uint64 connection, uint32_t mask) {
+        std::lock_guard<std::mutex> lock(m_write_mutex);
+        const uint64_t value = (connection << mask_bits) | (mask & all);
+        std::atomic<uint64_t>* free_entry = nullptr;
+        for (auto& entry : m_overrides) {
+            const auto current = entry.load(std::memory_order_relaxed);
+            if (current >> mask_bits == connection) {
+                entry.store(value, std::memory_order_release);
+                return true;
+            }
+            if (current == 0 && !free_entry)
+                free_entry = &entry;
+        }
+        if (!free_entry)
+            return false;
+        free_entry->store(value, std::memory_order_release);
+        m_override_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /* The connection follows the default mask again */
+    void reset(uint64 connection) {
+        std::lock_guard<std::mutex> lock(m_write_mutex);
+        for (auto& entry : m_overrides) {
+            if (entry.load(std::memory_order_relaxed) >> mask_bits == connection) {
+                entry.store(0, std::memory_order_release);
+                m_override_count.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+private:
+    static constexpr unsigned int mask_bits = 16;
+    static_assert(EventType_Count <= mask_bits, "EventType does not fit into the override entries");
+
+    std::atomic<uint32_t> m_default{all};
+    std::atomic<uint32_t> m_override_count{0};
+    // (connection << mask_bits | mask), 0 if unused
+    std::atomic<uint64_t> m_overrides[max_overrides] = {};
+    std::mutex m_write_mutex;
+};
@@ -0,0 +1,289 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "event_queue.h"
+
+#include <pthread.h>
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <new>
+
+namespace {
+    // argument positions, see ClientUIFunctions
+    constexpr int log_id_arg = 3;
+    constexpr int talk_status_client_arg = 3;
+
+    /* Server connection handler of a record, the log ID for log messages */
+    uint64_t connection_of(const EventRecord& record) {
+        return record.type == EventType_UserLoggingMessage ? record.values[log_id_arg] : record.values[0];
+    }
+
+    /* The client a record is about, the channel for channel events, 0 for connection wide events */
+    uint64_t client_of(const EventRecord& record) {
+        switch (record.type) {
+            case EventType_NewChannel:
+            case EventType_NewChannelCreated:
+            case EventType_DelChannel:
+            case EventType_ClientMove:
+            case EventType_ClientMoveSubscription:
+            case EventType_ClientMoveTimeout:
+            case EventType_ClientMoveMoved:
+                return record.values[1];
+            case EventType_TalkStatusChange:
+                return record.values[talk_status_client_arg];
+            default:
+                return 0;
+        }
+    }
+}
+
+bool EventQueue::start(std::size_t capacity, JNIEnv* (*attach)()) {
+    if (m_running.load())
+        return true;
+
+    std::size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+    m_cells = new (std::nothrow) Cell[size];
+    if (!m_cells)
+        return false;
+    m_overflow_tables = new (std::nothrow) OverflowTable[2];
+    if (!m_overflow_tables) {
+        delete[] m_cells;
+        m_cells = nullptr;
+        return false;
+    }
+    for (std::size_t t = 0; t < 2; ++t) {
+        auto& table = m_overflow_tables[t];
+        for (std::size_t i = 0; i < overflow_slots; ++i) {
+            table.entries[i].used = false;
+            table.entries[i].record = static_cast<uint8_t>(i);
+        }
+        table.used = 0;
+        table.spare = overflow_slots;
+    }
+    m_overflow_active = 0;
+    m_overflow_held.store(false, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < size; ++i)
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    m_mask = size - 1;
+    m_enqueue_pos.store(0, std::memory_order_relaxed);
+    m_dequeue_pos.store(0, std::memory_order_relaxed);
+    m_high_water.store(0, std::memory_order_relaxed);
+    sem_init(&m_wakeup, 0, 0);
+
+    m_running.store(true);
+    m_thread = std::thread(&EventQueue::run, this, attach);
+    m_accepting.store(true, std::memory_order_release);
+    return true;
+}
+
+void EventQueue::stop() {
+    if (!m_running.load())
+        return;
+
+    m_accepting.store(false);
+    while (m_producers.load() != 0)
+        std::this_thread::yield();
+
+    m_running.store(false);
+    sem_post(&m_wakeup);
+    m_thread.join();
+    m_thread_id.store(std::thread::id(), std::memory_order_relaxed);
+
+    sem_destroy(&m_wakeup);
+    delete[] m_cells;
+    m_cells = nullptr;
+    delete[] m_overflow_tables;
+    m_overflow_tables = nullptr;
+}
+
+EventQueue::Counters EventQueue::counters() const {
+    Counters result;
+    const auto enqueued = m_enqueue_pos.load(std::memory_order_relaxed);
+    const auto dequeued = m_dequeue_pos.load(std::memory_order_relaxed);
+    result.depth = enqueued > dequeued ? enqueued - dequeued : 0;
+    result.high_water = m_high_water.load(std::memory_order_relaxed);
+    result.dispatched = m_dispatched.load(std::memory_order_relaxed);
+    result.dropped = m_dropped.load(std::memory_order_relaxed);
+    result.coalesced = m_coalesced_count.load(std::memory_order_relaxed);
+    return result;
+}
+
+bool EventQueue::pop(JNIEnv* env, bool consume) {
+    std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        const auto sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+        if (difference == 0) {
+            if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (difference < 0) {
+            return false;
+        } else {
+            pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    if (consume)
+        this->consume(env, cell->record);
+    cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+}
+
+EventRecord& EventQueue::begin_overflow() {
+    while (m_overflow_lock.test_and_set(std::memory_order_acquire))
+        std::this_thread::yield();
+    auto& table = m_overflow_tables[m_overflow_active];
+    return table.records[table.spare];
+}
+
+void EventQueue::end_overflow() {
+    auto& table = m_overflow_tables[m_overflow_active];
+    const auto& record = table.records[table.spare];
+    const auto connection = connection_of(record);
+    const auto client = client_of(record);
+
+    OverflowTable::Entry* free_entry = nullptr;
+    OverflowTable::Entry* oldest = nullptr;
+    OverflowTable::Entry* entry = nullptr;
+    for (auto& candidate : table.entries) {
+        if (!candidate.used) {
+            if (!free_entry)
+                free_entry = &candidate;
+            continue;
+        }
+        if (!oldest || candidate.sequence < oldest->sequence)
+            oldest = &candidate;
+        if (candidate.type == record.type && candidate.connection == connection && candidate.client == client) {
+            entry = &candidate;
+            break;
+        }
+    }
+    if (entry) {
+        std::swap(entry->record, table.spare);
+        entry->sequence = m_overflow_sequence++;
+        m_coalesced_count.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        if (free_entry) {
+            entry = free_entry;
+            ++table.used;
+        } else {
+            // the ring already gave way to the table, so the oldest held record goes
+            entry = oldest;
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        entry->used = true;
+        entry->type = record.type;
+        entry->connection = connection;
+        entry->client = client;
+        entry->sequence = m_overflow_sequence++;
+        std::swap(entry->record, table.spare);
+    }
+    m_overflow_held.store(true, std::memory_order_release);
+    m_overflow_lock.clear(std::memory_order_release);
+}
+
+void EventQueue::drain_overflow(JNIEnv* env) {
+    while (m_overflow_lock.test_and_set(std::memory_order_acquire))
+        std::this_thread::yield();
+    auto& table = m_overflow_tables[m_overflow_active];
+    m_overflow_active ^= 1;
+    m_overflow_held.store(false, std::memory_order_release);
+    const auto boundary = m_enqueue_pos.load(std::memory_order_relaxed);
+    m_overflow_lock.clear(std::memory_order_release);
+    if (table.used == 0)
+        return;
+
+    // ring records claimed before the swap are older than the held ones, wait for those still being filled
+    while (static_cast<intptr_t>(boundary - m_dequeue_pos.load(std::memory_order_relaxed)) > 0) {
+        if (!pop(env, env != nullptr))
+            std::this_thread::yield();
+    }
+
+    // in arrival order of the latest record per key
+    OverflowTable::Entry* due[overflow_slots];
+    std::size_t count = 0;
+    for (auto& entry : table.entries) {
+        if (entry.used)
+            due[count++] = &entry;
+    }
+    std::sort(due, due + count, [](const OverflowTable::Entry* a, const OverflowTable::Entry* b) {
+        return a->sequence < b->sequence;
+    });
+    for (std::size_t i = 0; i < count; ++i) {
+        if (env)
+            consume(env, table.records[due[i]->record]);
+        due[i]->used = false;
+    }
+    table.used = 0;
+}
+
+void EventQueue::consume(JNIEnv* env, const EventRecord& record) {
+    const auto deliver = [this, env](const EventRecord& held) { this->deliver(env, held); };
+    if (!m_coalescer.offer(record, EventCoalescer::Clock::now(), deliver))
+        this->deliver(env, record);
+}
+
+void EventQueue::deliver(JNIEnv* env, const EventRecord& record) {
+    if (m_sink)
+        m_sink->consume(env, record);
+    else
+        record.dispatch(env, record);
+    m_dispatched.fetch_add(1, std::memory_order_relaxed);
+    m_latency[record.type].record(monotonic_ns() - record.queued_ns);
+}
+
+void EventQueue::wait() {
+    const auto deadline = m_coalescer.next_deadline();
+    if (deadline == EventCoalescer::Clock::time_point::max()) {
+        while (sem_wait(&m_wakeup) != 0 && errno == EINTR) {}
+        return;
+    }
+
+    const auto remaining = deadline - EventCoalescer::Clock::now();
+    if (remaining <= EventCoalescer::Clock::duration::zero())
+        return;
+    const auto remaining_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+    timespec timeout;
+    clock_gettime(CLOCK_REALTIME, &timeout);
+    timeout.tv_sec += static_cast<time_t>(remaining_ns / 1000000000);
+    timeout.tv_nsec += static_cast<long>(remaining_ns % 1000000000);
+    if (timeout.tv_nsec >= 1000000000) {
+        timeout.tv_nsec -= 1000000000;
+        ++timeout.tv_sec;
+    }
+    sem_timedwait(&m_wakeup, &timeout);
+}
+
+void EventQueue::run(JNIEnv* (*attach)()) {
+    pthread_setname_np(pthread_self(), "ts3 events");
+    m_thread_id.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    JNIEnv* env = attach();
+
+    for (;;) {
+        wait();
+        const bool running = m_running.load();
+
+        if (env && m_sink)
+            m_sink->begin(env);
+        while (pop(env, env != nullptr)) {}
+        drain_overflow(env);
+        if (env) {
+            const auto deliver = [this, env](const EventRecord& held) { this->deliver(env, held); };
+            if (running)
+                m_coalescer.flush_expired(EventCoalescer::Clock::now(), deliver);
+            else
+                m_coalescer.flush_all(deliver);
+        }
+        if (env && m_sink)
+            m_sink->end(env);
+        if (!running)
+            break;
+    }
+}
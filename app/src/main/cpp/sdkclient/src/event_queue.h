@@ -0,0 +1,243 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Bounded multi-producer queue between the clientlib callback threads and a single dispatcher thread
+ * that posts the events to Java. Producers never take a lock while there is room, the dispatcher sleeps
+ * on a semaphore.
+ */
+#pragma once
+
+#include <jni.h>
+#include "jni_event.h"
+#include "event_record.h"
+#include "event_coalescer.h"
+#include "audio_latency.h"
+
+#include <semaphore.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+/* What a producer does when the queue is full */
+enum EventQueueOverflow {
+    EventQueueOverflow_Block = 0,       // wait until the dispatcher made room
+    EventQueueOverflow_DropOldest = 1,  // discard the oldest queued event
+    EventQueueOverflow_Coalesce = 2,    // keep only the latest overflowing event per type, connection and client, see EventQueue
+    EventQueueOverflow_Count
+};
+
+/*
+ * Optional consumer of the records drained by the dispatcher thread, replacing the per-record dispatch.
+ * begin and end bracket each pass over the queue.
+ */
+class EventSink {
+public:
+    virtual ~EventSink() = default;
+    virtual void begin(JNIEnv* env) = 0;
+    virtual void consume(JNIEnv* env, const EventRecord& record) = 0;
+    virtual void end(JNIEnv* env) = 0;
+};
+
+class EventQueue {
+public:
+    struct Counters {
+        uint64_t depth;
+        uint64_t high_water;
+        uint64_t dispatched;
+        uint64_t dropped;
+        uint64_t coalesced;
+    };
+
+    static constexpr std::size_t default_capacity = 512;
+    /*
+     * Distinct (type, server connection, client) keys the Coalesce policy holds while the queue is full.
+     * Channel events use the channel as client. With all slots taken a push drops the oldest held event.
+     * Once an event is held, later pushes are held as well until the dispatcher takes the table, so no
+     * event reaches Java ahead of an older held one.
+     */
+    static constexpr std::size_t overflow_slots = 32;
+
+    EventQueue() = default;
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+    ~EventQueue() { stop(); }
+
+    /*
+     * Allocates capacity (rounded up to a power of two) records and starts the dispatcher thread.
+     * attach must return the JNIEnv of the calling thread.
+     */
+    bool start(std::size_t capacity, JNIEnv* (*attach)());
+
+    /* Dispatches the events still queued and joins the dispatcher thread */
+    void stop();
+
+    void set_overflow(EventQueueOverflow policy) { m_overflow.store(policy, std::memory_order_relaxed); }
+
+    /* Must be called before start */
+    void set_sink(EventSink* sink) { m_sink = sink; }
+
+    /*
+     * Claims a record, lets fill(EventRecord&) write it and wakes the dispatcher.
+     * Returns false if the caller has to deliver the event itself: the queue is not running or the
+     * caller is the dispatcher thread (a listener triggered a callback, blocking would deadlock).
+     */
+    template <typename Fill>
+    bool push(EventType type, Fill&& fill);
+
+    Counters counters() const;
+
+    /* Time from push to the delivery to Java or the sink, per event type. Events the producer delivered itself are not counted. */
+    LatencyHistogram& latency(EventType type) { return m_latency[type]; }
+
+    /* Coalescing stage in front of the Java delivery, configurable while running */
+    EventCoalescer& coalescer() { return m_coalescer; }
+    const EventCoalescer& coalescer() const { return m_coalescer; }
+
+    /* True on the dispatcher thread, events raised by its listeners are not queued */
+    bool is_dispatcher_thread() const { return std::this_thread::get_id() == m_thread_id.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<std::size_t> sequence;
+        EventRecord record;
+    };
+
+    /*
+     * Latest overflowing record per key. Every entry owns one of the records, used or not. Producers fill
+     * the spare record and swap it into the entry of its key, the superseded record becomes the spare, so
+     * nothing is copied or allocated.
+     */
+    struct OverflowTable {
+        struct Entry {
+            bool used;
+            uint8_t record;
+            EventType type;
+            uint64_t connection;
+            uint64_t client;
+            uint64_t sequence;
+        };
+        Entry entries[overflow_slots];
+        std::size_t used;
+        uint8_t spare;
+        EventRecord records[overflow_slots + 1];
+    };
+
+    template <typename Fill>
+    bool try_emplace(Fill& fill);
+    template <typename Fill>
+    void coalesce_overflow(Fill& fill);
+
+    /* Removes the oldest record and dispatches it if consume is set */
+    bool pop(JNIEnv* env, bool consume);
+    /* Locks the active overflow table and returns its spare record */
+    EventRecord& begin_overflow();
+    /* Stores the spare record under its key, in place of the oldest one if the table is full, and unlocks */
+    void end_overflow();
+    /* Swaps the tables, dispatches the ring records pushed before the swap and then the held ones */
+    void drain_overflow(JNIEnv* env);
+    void consume(JNIEnv* env, const EventRecord& record);
+    void deliver(JNIEnv* env, const EventRecord& record);
+    void wait();
+    void run(JNIEnv* (*attach)());
+
+    Cell* m_cells = nullptr;
+    std::size_t m_mask = 0;
+    alignas(64) std::atomic<std::size_t> m_enqueue_pos{0};
+    alignas(64) std::atomic<std::size_t> m_dequeue_pos{0};
+
+    std::atomic<bool> m_accepting{false};
+    std::atomic<int> m_producers{0};
+    std::atomic<bool> m_running{false};
+    std::atomic<int> m_overflow{EventQueueOverflow_Block};
+    // Producers write the active table, the dispatcher swaps them and drains the other one
+    OverflowTable* m_overflow_tables = nullptr;
+    std::atomic_flag m_overflow_lock = ATOMIC_FLAG_INIT;
+    std::size_t m_overflow_active = 0;
+    // Set while the active table holds records, pushes then bypass the ring
+    std::atomic<bool> m_overflow_held{false};
+    uint64_t m_overflow_sequence = 0;
+    EventSink* m_sink = nullptr;
+    EventCoalescer m_coalescer;
+    sem_t m_wakeup;
+    std::thread m_thread;
+    /* Set by the dispatcher thread itself before its first event, read by every push */
+    std::atomic<std::thread::id> m_thread_id{std::thread::id()};
+
+    std::atomic<uint64_t> m_high_water{0};
+    std::atomic<uint64_t> m_dispatched{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_coalesced_count{0};
+    LatencyHistogram m_latency[EventType_Count];
+};
+
+template <typename Fill>
+bool EventQueue::try_emplace(Fill& fill) {
+    std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        const auto sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (difference == 0) {
+            if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (difference < 0) {
+            return false;
+        } else {
+            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    fill(cell->record);
+    cell->record.queued_ns = monotonic_ns();
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    const auto dequeued = m_dequeue_pos.load(std::memory_order_relaxed);
+    const uint64_t depth = pos + 1 > dequeued ? pos + 1 - dequeued : 0;
+    uint64_t high_water = m_high_water.load(std::memory_order_relaxed);
+    while (depth > high_water && !m_high_water.compare_exchange_weak(high_water, depth, std::memory_order_relaxed)) {}
+    return true;
+}
+
+template <typename Fill>
+void EventQueue::coalesce_overflow(Fill& fill) {
+    auto& record = begin_overflow();
+    fill(record);
+    record.queued_ns = monotonic_ns();
+    end_overflow();
+}
+
+template <typename Fill>
+bool EventQueue::push(EventType type, Fill&& fill) {
+    m_producers.fetch_add(1);
+    if (!m_accepting.load() || is_dispatcher_thread()) {
+        m_producers.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    for (unsigned int attempt = 0;; ++attempt) {
+        const auto policy = m_overflow.load(std::memory_order_relaxed);
+        if (policy == EventQueueOverflow_Coalesce) {
+            // once an event is held, the ring would let later ones overtake it
+            if (m_overflow_held.load(std::memory_order_acquire) || !try_emplace(fill))
+                coalesce_overflow(fill);
+            break;
+        }
+        if (try_emplace(fill))
+            break;
+        if (policy == EventQueueOverflow_DropOldest) {
+            if (pop(nullptr, false))
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+        } else if (attempt < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    sem_post(&m_wakeup);
+    m_producers.fetch_sub(1, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,103 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#pragma once
+
+#include <jni.h>
+#include "jni_event.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Fixed-size copy of the arguments of one callback. Integral arguments are stored in values,
+ * strings are copied into text and values holds their offset. Strings that do not fit are truncated,
+ * those after a full text area are empty.
+ */
+struct EventRecord {
+    static constexpr std::size_t max_values = 10;
+    static constexpr std::size_t text_capacity = 1024;
+    static constexpr uint64_t null_string = UINT64_MAX;
+
+    using Dispatch = void (*)(JNIEnv*, const EventRecord&);
+
+    Dispatch dispatch;
+    EventType type;
+    uint8_t count;          // number of arguments
+    uint16_t string_mask;   // bit i is set if argument i is a string
+    uint16_t text_size;
+    uint64_t queued_ns;     // monotonic time the record entered the event queue
+    uint64_t values[max_values];
+    char text[text_capacity];
+
+    template <typename... Args>
+    void pack(Dispatch dispatch_function, EventType event_type, Args... args) {
+        static_assert(sizeof...(Args) <= max_values, "too many callback arguments");
+        dispatch = dispatch_function;
+        type = event_type;
+        count = static_cast<uint8_t>(sizeof...(Args));
+        string_mask = 0;
+        text_size = 0;
+        std::size_t index = 0;
+        (store(index++, args), ...);
+    }
+
+    template <typename... Args>
+    std::tuple<Args...> unpack() const {
+        return unpack<Args...>(std::index_sequence_for<Args...>{});
+    }
+
+private:
+    template <typename T>
+    void store(std::size_t index, T value) {
+        static_assert(std::is_integral<T>::value, "unsupported callback argument");
+        values[index] = static_cast<uint64_t>(value);
+    }
+
+    void store(std::size_t index, const char* value) {
+        string_mask = static_cast<uint16_t>(string_mask | (1u << index));
+        if (!value) {
+            values[index] = null_string;
+            return;
+        }
+        if (std::size_t{text_size} + 1 >= text_capacity) {
+            // no room left, not even for the terminator: an empty string on the last byte
+            text[text_capacity - 1] = '\0';
+            values[index] = text_capacity - 1;
+            text_size = static_cast<uint16_t>(text_capacity);
+            return;
+        }
+        std::size_t length = std::strlen(value);
+        const std::size_t available = text_capacity - text_size - 1;
+        if (length > available) {
+            length = available;
+            // do not cut a UTF-8 sequence in half
+            while (length > 0 && (static_cast<unsigned char>(value[length]) & 0xC0) == 0x80)
+                --length;
+        }
+        values[index] = text_size;
+        std::memcpy(text + text_size, value, length);
+        text[text_size + length] = '\0';
+        text_size = static_cast<uint16_t>(text_size + length + 1);
+    }
+
+    template <typename T>
+    T load(std::size_t index) const {
+        if constexpr (std::is_same<T, const char*>::value)
+            return values[index] == null_string ? nullptr : text + values[index];
+        else
+            return static_cast<T>(values[index]);
+    }
+
+    template <typename... Args, std::size_t... I>
+    std::tuple<Args...> unpack(std::index_sequence<I...>) const {
+        return std::tuple<Args...>(load<Args>(I)...);
+    }
+};
@@ -0,0 +1,103 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "jitter_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+/* Upper bound of the buffered audio */
+static constexpr int max_depth_ms = 500;
+/* The ring is allocated once for this format, a reopen never reallocates under the Java reader */
+static constexpr std::size_t max_frequency = 48000;
+static constexpr std::size_t max_channels = 2;
+/* The target is only lowered after this long without an underrun */
+static constexpr int shrink_window_ms = 1000;
+
+static constexpr uint64_t histogram_limits_ms[PlaybackJitterBuffer::histogram_buckets - 1] = {1, 2, 5, 10, 20, 50, 100};
+
+bool PlaybackJitterBuffer::configure(int frequency, int channels, int period_frames) {
+    if (frequency <= 0 || channels <= 0 || period_frames <= 0)
+        return false;
+    if (!m_ring.allocate(max_frequency * max_depth_ms / 1000 * max_channels))
+        return false;
+    m_ring.configure(channels);
+
+    m_frequency.store(frequency, std::memory_order_relaxed);
+    m_channels.store(static_cast<std::size_t>(channels), std::memory_order_relaxed);
+    m_period = static_cast<std::size_t>(period_frames);
+    m_window_periods = std::max<std::size_t>(1, static_cast<std::size_t>(frequency) * shrink_window_ms / 1000 / m_period);
+    m_window_position = 0;
+    m_seen_underruns = 0;
+    m_target.store(std::min(2 * m_period, m_ring.capacity()), std::memory_order_relaxed);
+    m_low_water.store(SIZE_MAX, std::memory_order_relaxed);
+    m_largest_read.store(0, std::memory_order_relaxed);
+    m_underruns.store(0, std::memory_order_relaxed);
+    for (auto& bucket : m_histogram)
+        bucket.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void PlaybackJitterBuffer::adapt() {
+    auto target = m_target.load(std::memory_order_relaxed);
+    const auto underruns = m_underruns.load(std::memory_order_relaxed);
+    if (underruns != m_seen_underruns) {
+        // Grow right away, by one period per underrun burst
+        m_seen_underruns = underruns;
+        target += m_period;
+        m_window_position = 0;
+        m_low_water.store(SIZE_MAX, std::memory_order_relaxed);
+    } else if (++m_window_position >= m_window_periods) {
+        // A whole window without underrun. If the buffer never drained below a period, that period is
+        // pure latency. Never go below the largest chunk Java reads at once.
+        m_window_position = 0;
+        const auto low_water = m_low_water.exchange(SIZE_MAX, std::memory_order_relaxed);
+        const auto floor = std::max(m_period, m_largest_read.exchange(0, std::memory_order_relaxed));
+        if (low_water != SIZE_MAX && low_water > m_period && target >= floor + m_period)
+            target -= m_period;
+    }
+    m_target.store(std::min(target, m_ring.capacity()), std::memory_order_relaxed);
+}
+
+std::size_t PlaybackJitterBuffer::frames_wanted() {
+    adapt();
+    const auto target = m_target.load(std::memory_order_relaxed);
+    const auto depth = m_ring.fill();
+    return depth < target ? target - depth : 0;
+}
+
+std::size_t PlaybackJitterBuffer::read(short* samples, std::size_t frames) {
+    const auto depth = m_ring.fill();
+    if (depth < m_low_water.load(std::memory_order_relaxed))
+        m_low_water.store(depth, std::memory_order_relaxed);
+    if (frames > m_largest_read.load(std::memory_order_relaxed))
+        m_largest_read.store(frames, std::memory_order_relaxed);
+
+    const auto count = m_ring.read(samples, frames);
+    if (count < frames) {
+        const auto channels = m_channels.load(std::memory_order_relaxed);
+        const auto frequency = m_frequency.load(std::memory_order_relaxed);
+        std::memset(samples + count * channels, 0, (frames - count) * channels * sizeof(short));
+        if (frequency > 0) {
+            const auto missing_ms = (frames - count) * 1000 / static_cast<std::size_t>(frequency);
+            const auto bucket = std::upper_bound(std::begin(histogram_limits_ms), std::end(histogram_limits_ms), missing_ms) - std::begin(histogram_limits_ms);
+            m_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+            m_underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return count;
+}
+
+PlaybackJitterBuffer::Counters PlaybackJitterBuffer::counters() const {
+    Counters result;
+    result.depth = m_ring.fill();
+    result.target = m_target.load(std::memory_order_relaxed);
+    result.underruns = m_underruns.load(std::memory_order_relaxed);
+    for (int i = 0; i < histogram_buckets; ++i)
+        result.histogram[i] = m_histogram[i].load(std::memory_order_relaxed);
+    return result;
+}
@@ -0,0 +1,68 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Playback buffer between the audio pump, which prefetches mixed audio from the clientlib, and Java,
+ * which reads it at the pace of the audio device. The target depth grows on underruns and shrinks again
+ * while the reads leave slack, so latency stays as low as the device allows.
+ */
+#pragma once
+
+#include "pcm_ring.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class PlaybackJitterBuffer {
+public:
+    /* Underruns by the length of the missing audio: < 1, 2, 5, 10, 20, 50, 100 ms and longer */
+    static constexpr int histogram_buckets = 8;
+
+    struct Counters {
+        uint64_t depth;         // frames
+        uint64_t target;        // frames
+        uint64_t underruns;
+        uint64_t histogram[histogram_buckets];
+    };
+
+    /*
+     * Empties the buffer, allocating it on the first call. Neither side may be active. Formats above
+     * 48 kHz stereo get less than the maximum depth.
+     */
+    bool configure(int frequency, int channels, int period_frames);
+
+    /* Pump side: frames to fetch from the clientlib this period to reach the target depth */
+    std::size_t frames_wanted();
+    void write(const short* samples, std::size_t frames) { m_ring.write(samples, frames); }
+
+    /* Java side: fills all frames, the part the buffer could not provide with silence. Returns the frames provided. */
+    std::size_t read(short* samples, std::size_t frames);
+
+    Counters counters() const;
+
+    std::size_t write_position() const { return m_ring.write_position(); }
+    std::size_t read_position() const { return m_ring.read_position(); }
+
+private:
+    void adapt();
+
+    PcmRing m_ring;
+    /* Read by the Java side too */
+    std::atomic<int> m_frequency{0};
+    std::atomic<std::size_t> m_channels{1};
+    std::size_t m_period = 0;
+    std::size_t m_window_periods = 0;
+
+    /* Pump side state */
+    std::size_t m_window_position = 0;
+    uint64_t m_seen_underruns = 0;
+
+    std::atomic<std::size_t> m_target{0};
+    /* Written by the reader, consumed by the pump once per adaptation window */
+    std::atomic<std::size_t> m_low_water{SIZE_MAX};
+    std::atomic<std::size_t> m_largest_read{0};
+    std::atomic<uint64_t> m_underruns{0};
+    std::atomic<uint64_t> m_histogram[histogram_buckets] = {};
+};
@@ -0,0 +1,76 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "jni_event.h"
+#include "wrapper_log.h"
+
+#include <string>
+
+static jobject gClassLoader;
+static jmethodID gLoadClass;
+
+bool init_class_loader(JNIEnv* env, jclass anchor) {
+    jclass class_class = env->GetObjectClass(anchor);
+    jmethodID get_class_loader = env->GetMethodID(class_class, "getClassLoader", "()Ljava/lang/ClassLoader;");
+    jobject loader = get_class_loader ? env->CallObjectMethod(anchor, get_class_loader) : nullptr;
+    jclass loader_class = loader ? env->GetObjectClass(loader) : nullptr;
+    jmethodID load_class = loader_class ? env->GetMethodID(loader_class, "loadClass", "(Ljava/lang/String;)Ljava/lang/Class;") : nullptr;
+    if (load_class) {
+        gClassLoader = env->NewGlobalRef(loader);
+        gLoadClass = load_class;
+    }
+    if (env->ExceptionCheck())
+        env->ExceptionClear();
+    env->DeleteLocalRef(loader_class);
+    env->DeleteLocalRef(loader);
+    env->DeleteLocalRef(class_class);
+    return gClassLoader != nullptr;
+}
+
+jclass find_app_class(JNIEnv* env, const char* path) {
+    if (!gClassLoader)
+        return nullptr;
+    // ClassLoader.loadClass takes the binary name
+    std::string name(path);
+    for (auto& c : name) {
+        if (c == '/')
+            c = '.';
+    }
+    jstring java_name = env->NewStringUTF(name.c_str());
+    jobject cls = java_name ? env->CallObjectMethod(gClassLoader, gLoadClass, java_name) : nullptr;
+    if (env->ExceptionCheck()) {
+        env->ExceptionClear();
+        cls = nullptr;
+    }
+    env->DeleteLocalRef(java_name);
+    return static_cast<jclass>(cls);
+}
+
+bool JniEventClass::resolve_slow(JNIEnv* env) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto state = m_state.load(std::memory_order_relaxed);
+    if (state != state_unresolved)
+        return state == state_resolved;
+
+    jclass cls = find_app_class(env, m_path);
+    jmethodID constructor = cls ? env->GetMethodID(cls, "<init>", m_signature) : nullptr;
+    jmethodID post = constructor ? env->GetMethodID(cls, "Post", "()V") : nullptr;
+    if (env->ExceptionCheck())
+        env->ExceptionClear();
+    if (post) {
+        m_class = static_cast<jclass>(env->NewGlobalRef(cls));
+        m_constructor = constructor;
+        m_post = post;
+    }
+    env->DeleteLocalRef(cls);
+    if (!m_class) {
+        LOGE("Failed to resolve %s%s and its Post method", m_path, m_signature);
+        m_state.store(state_failed, std::memory_order_relaxed);
+        return false;
+    }
+    m_state.store(state_resolved, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,156 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Compile-time bridge between ClientUIFunctions callbacks and the Kotlin event classes in ts3sdk/events.
+ * The JNI constructor signature of each event class is derived from the callback signature, the jclass
+ * and jmethodIDs are resolved when the event type is first subscribed to or posted. Listeners that only
+ * take EventBatches never load the event classes at all.
+ */
+#pragma once
+
+#include <jni.h>
+#include "teamspeak/clientlib.h"
+#include "string_intern.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+/*
+ * Maps a callback parameter type to its JNI field descriptor and converts the value to a jvalue.
+ * Strings come from event_strings() as local references, those are released by JniEvent::post.
+ */
+template <typename T> struct JniType;
+
+template <> struct JniType<uint64> {
+    static constexpr char descriptor[] = "J";
+    static jvalue to_jvalue(JNIEnv*, uint64 value) { jvalue result; result.j = static_cast<jlong>(value); return result; }
+};
+
+template <> struct JniType<int> {
+    static constexpr char descriptor[] = "I";
+    static jvalue to_jvalue(JNIEnv*, int value) { jvalue result; result.i = value; return result; }
+};
+
+template <> struct JniType<unsigned int> {
+    static constexpr char descriptor[] = "I";
+    static jvalue to_jvalue(JNIEnv*, unsigned int value) { jvalue result; result.i = static_cast<jint>(value); return result; }
+};
+
+template <> struct JniType<anyID> {
+    static constexpr char descriptor[] = "I";
+    static jvalue to_jvalue(JNIEnv*, anyID value) { jvalue result; result.i = value; return result; }
+};
+
+template <> struct JniType<const char*> {
+    static constexpr char descriptor[] = "Ljava/lang/String;";
+    static jvalue to_jvalue(JNIEnv* env, const char* value) { jvalue result; result.l = event_strings().get(env, value); return result; }
+};
+
+/* Builds "(<descriptors>)V" at compile time */
+template <typename... Args>
+constexpr auto constructor_signature() {
+    constexpr std::size_t length = (std::size_t{3} + ... + (sizeof(JniType<Args>::descriptor) - 1));
+    std::array<char, length + 1> result{};
+    std::size_t pos = 0;
+    result[pos++] = '(';
+    for (const char* descriptor : {JniType<Args>::descriptor..., ""})
+        while (*descriptor)
+            result[pos++] = *descriptor++;
+    result[pos++] = ')';
+    result[pos++] = 'V';
+    result[pos] = '\0';
+    return result;
+}
+
+/* Identifies the forwarded callbacks, e.g. for per-type queue bookkeeping */
+enum EventType : uint8_t {
+    EventType_ConnectStatusChange = 0,
+    EventType_NewChannel,
+    EventType_NewChannelCreated,
+    EventType_DelChannel,
+    EventType_ClientMove,
+    EventType_ClientMoveSubscription,
+    EventType_ClientMoveTimeout,
+    EventType_ClientMoveMoved,
+    EventType_TalkStatusChange,
+    EventType_ServerError,
+    EventType_UserLoggingMessage,
+    EventType_Count
+};
+
+/*
+ * Looks classes up through the class loader of the app. FindClass on a thread attached by the wrapper
+ * only sees the system classes. init_class_loader is called from JNI_OnLoad with a class of the app.
+ */
+bool init_class_loader(JNIEnv* env, jclass anchor);
+/* Local reference, nullptr with the exception cleared if there is no such class */
+jclass find_app_class(JNIEnv* env, const char* path);
+
+/* The untyped part of JniEvent: the event class and its lookup */
+class JniEventClass {
+public:
+    JniEventClass(EventType type, const char* path, const char* signature)
+        : m_type(type), m_path(path), m_signature(signature) {}
+    JniEventClass(const JniEventClass&) = delete;
+    JniEventClass& operator=(const JniEventClass&) = delete;
+
+    EventType type() const { return m_type; }
+    const char* path() const { return m_path; }
+
+    /* Resolves class, constructor and Post method the first time, false for good if that fails */
+    bool resolve(JNIEnv* env) {
+        const auto state = m_state.load(std::memory_order_acquire);
+        return state == state_resolved || (state == state_unresolved && resolve_slow(env));
+    }
+
+protected:
+    jclass m_class = nullptr;
+    jmethodID m_constructor = nullptr;
+    jmethodID m_post = nullptr;
+
+private:
+    enum : int { state_unresolved, state_resolved, state_failed };
+
+    bool resolve_slow(JNIEnv* env);
+
+    const EventType m_type;
+    const char* const m_path;
+    const char* const m_signature;
+    std::atomic<int> m_state{state_unresolved};
+    std::mutex m_mutex;
+};
+
+template <typename Callback> class JniEvent;
+
+/*
+ * A Kotlin event class whose constructor takes the same parameters as the clientlib callback Callback.
+ * Declare as JniEvent<decltype(ClientUIFunctions::onXxxEvent)>.
+ */
+template <typename... Args>
+class JniEvent<void (*)(Args...)> : public JniEventClass {
+public:
+    static constexpr auto signature = constructor_signature<Args...>();
+
+    JniEvent(EventType type, const char* path) : JniEventClass(type, path, signature.data()) {}
+
+    /* Constructs the event object and calls its Post method. All local references are released on return. */
+    void post(JNIEnv* env, Args... args) {
+        if (!resolve(env))
+            return;
+        if (env->PushLocalFrame(static_cast<jint>(sizeof...(Args) + 1)) != JNI_OK)
+            return;
+        const jvalue values[] = {JniType<Args>::to_jvalue(env, args)...};
+        jobject event = env->NewObjectA(m_class, m_constructor, values);
+        if (event)
+            env->CallVoidMethod(event, m_post);
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+        }
+        env->PopLocalFrame(nullptr);
+    }
+};
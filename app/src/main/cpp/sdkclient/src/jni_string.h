@@ -0,0 +1,98 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Scoped Java string arguments for the entry points. The modified UTF-8 bytes are copied out with
+ * GetStringUTFRegion, into the object itself up to inline_capacity bytes and into the heap only beyond
+ * that, so the usual identifiers, paths and passwords cost no allocation and nothing has to be released
+ * by hand on any return path.
+ */
+#pragma once
+
+#include <jni.h>
+
+#include <cstddef>
+#include <memory>
+
+class JniUtf8 {
+public:
+    static constexpr std::size_t inline_capacity = 128;
+
+    JniUtf8() = default;
+    JniUtf8(JNIEnv* env, jstring string) { assign(env, string); }
+    JniUtf8(const JniUtf8&) = delete;
+    JniUtf8& operator=(const JniUtf8&) = delete;
+
+    /* Copies string, nullptr stays nullptr */
+    void assign(JNIEnv* env, jstring string) {
+        m_heap.reset();
+        m_data = nullptr;
+        m_size = 0;
+        if (!string)
+            return;
+        const auto size = static_cast<std::size_t>(env->GetStringUTFLength(string));
+        char* data = m_inline;
+        if (size >= inline_capacity) {
+            m_heap.reset(new char[size + 1]);
+            data = m_heap.get();
+        }
+        env->GetStringUTFRegion(string, 0, env->GetStringLength(string), data);
+        data[size] = '\0';
+        m_data = data;
+        m_size = size;
+    }
+
+    /* nullptr for a null jstring */
+    const char* c_str() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    explicit operator bool() const { return m_data != nullptr; }
+
+private:
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    std::unique_ptr<char[]> m_heap;
+    char m_inline[inline_capacity];
+};
+
+/*
+ * A String[] as the clientlib takes string lists, e.g. the default channel path of ts3client_startConnection:
+ * the elements in order, followed by an empty string. Null arrays are empty, null elements empty strings.
+ */
+class JniUtf8Array {
+public:
+    static constexpr std::size_t inline_capacity = 8;
+
+    JniUtf8Array(JNIEnv* env, jobjectArray array) {
+        m_size = array ? static_cast<std::size_t>(env->GetArrayLength(array)) : 0;
+        m_strings = m_inline_strings;
+        m_list = m_inline_list;
+        if (m_size > inline_capacity) {
+            m_heap_strings.reset(new JniUtf8[m_size]);
+            m_heap_list.reset(new const char*[m_size + 1]);
+            m_strings = m_heap_strings.get();
+            m_list = m_heap_list.get();
+        }
+        for (std::size_t i = 0; i < m_size; ++i) {
+            auto element = static_cast<jstring>(env->GetObjectArrayElement(array, static_cast<jsize>(i)));
+            m_strings[i].assign(env, element);
+            env->DeleteLocalRef(element);
+            m_list[i] = m_strings[i] ? m_strings[i].c_str() : "";
+        }
+        m_list[m_size] = "";
+    }
+    JniUtf8Array(const JniUtf8Array&) = delete;
+    JniUtf8Array& operator=(const JniUtf8Array&) = delete;
+
+    const char** data() { return m_list; }
+    std::size_t size() const { return m_size; }
+
+private:
+    std::size_t m_size;
+    JniUtf8* m_strings;
+    const char** m_list;
+    std::unique_ptr<JniUtf8[]> m_heap_strings;
+    std::unique_ptr<const char*[]> m_heap_list;
+    JniUtf8 m_inline_strings[inline_capacity];
+    const char* m_inline_list[inline_capacity + 1];
+};
@@ -0,0 +1,93 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "load_generator.h"
+
+#include <pthread.h>
+#include <cerrno>
+#include <ctime>
+
+static void sleep_until(uint64_t deadline_ns) {
+    timespec deadline;
+    deadline.tv_sec = static_cast<time_t>(deadline_ns / 1000000000u);
+    deadline.tv_nsec = static_cast<long>(deadline_ns % 1000000000u);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+}
+
+bool LoadGenerator::start(Invoke invoke, const std::vector<Workload>& workloads, int threads, uint64_t connection, int connections, int duration_ms) {
+    if (is_running() || !invoke || workloads.empty() || threads <= 0 || threads > max_threads || duration_ms < 0 ||
+        connections <= 0 || connections > max_connections)
+        return false;
+    for (const auto& workload : workloads) {
+        if (workload.type >= EventType_Count || workload.rate <= 0 || workload.rate > max_rate)
+            return false;
+    }
+    stop();
+
+    for (auto& type : m_types) {
+        type.generated.store(0, std::memory_order_relaxed);
+        type.late.store(0, std::memory_order_relaxed);
+        type.call.reset();
+    }
+    m_invoke = invoke;
+    m_connection = connection;
+    m_connections = static_cast<uint64_t>(connections);
+    m_start_ns = monotonic_ns();
+    m_end_ns = duration_ms > 0 ? m_start_ns + static_cast<uint64_t>(duration_ms) * 1000000u : 0;
+    m_finished_ns.store(0, std::memory_order_relaxed);
+    m_stopping.store(false);
+    m_active.store(static_cast<int>(workloads.size()) * threads);
+    for (const auto& workload : workloads) {
+        for (int thread = 0; thread < threads; ++thread)
+            m_threads.emplace_back(&LoadGenerator::run, this, workload, thread, threads);
+    }
+    return true;
+}
+
+void LoadGenerator::stop() {
+    m_stopping.store(true);
+    for (auto& thread : m_threads)
+        thread.join();
+    m_threads.clear();
+}
+
+LoadGenerator::Counters LoadGenerator::counters(EventType type) const {
+    Counters result;
+    result.generated = m_types[type].generated.load(std::memory_order_relaxed);
+    result.late = m_types[type].late.load(std::memory_order_relaxed);
+    const auto finished = m_finished_ns.load(std::memory_order_relaxed);
+    result.elapsed_ns = m_start_ns == 0 ? 0 : (finished != 0 ? finished : monotonic_ns()) - m_start_ns;
+    return result;
+}
+
+void LoadGenerator::run(Workload workload, int thread, int threads) {
+    pthread_setname_np(pthread_self(), "ts3 load");
+    auto& counters = m_types[workload.type];
+    const auto interval_ns = 1000000000u * static_cast<uint64_t>(threads) / static_cast<uint64_t>(workload.rate);
+
+    // Threads of a workload take turns, each one offset by its share of the interval
+    auto slot = m_start_ns + interval_ns * static_cast<uint64_t>(thread) / static_cast<uint64_t>(threads);
+    for (uint64_t sequence = static_cast<uint64_t>(thread); !m_stopping.load(std::memory_order_relaxed); sequence += static_cast<uint64_t>(threads)) {
+        if (m_end_ns != 0 && slot >= m_end_ns)
+            break;
+        auto now = monotonic_ns();
+        if (now < slot) {
+            sleep_until(slot);
+            now = monotonic_ns();
+        } else if (now > slot + interval_ns) {
+            // Behind by more than a slot, give up on catching up instead of bursting
+            counters.late.fetch_add(1, std::memory_order_relaxed);
+            slot = now;
+        }
+        m_invoke(workload.type, m_connection + sequence % m_connections, sequence);
+        counters.call.record(monotonic_ns() - now);
+        counters.generated.fetch_add(1, std::memory_order_relaxed);
+        slot += interval_ns;
+    }
+
+    if (m_active.fetch_sub(1) == 1)
+        m_finished_ns.store(monotonic_ns(), std::memory_order_relaxed);
+}
@@ -0,0 +1,104 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Stand-in for the clientlib callback threads: raises synthetic events at fixed rates, so event throughput
+ * and latency can be measured without a server. Each workload is one event type, spread over threads of
+ * its own.
+ */
+#pragma once
+
+#include "jni_event.h"
+#include "audio_latency.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T>
+T synthetic_argument(std::size_t index, uint64_t connection, uint64_t sequence) {
+    if constexpr (std::is_same<T, const char*>::value)
+        return "synthetic load";
+    else
+        return static_cast<T>(index == 0 ? connection : sequence + index);
+}
+
+template <typename... Args, std::size_t... I>
+void invoke_synthetic(void (*callback)(Args...), uint64_t connection, uint64_t sequence, std::index_sequence<I...>) {
+    callback(synthetic_argument<Args>(I, connection, sequence)...);
+}
+
+/*
+ * Calls a clientlib callback with synthetic arguments: an integral first argument is the connection,
+ * the other integers are derived from sequence, strings are a fixed text
+ */
+template <typename... Args>
+void invoke_synthetic(void (*callback)(Args...), uint64_t connection, uint64_t sequence) {
+    if (callback)
+        invoke_synthetic(callback, connection, sequence, std::index_sequence_for<Args...>{});
+}
+
+class LoadGenerator {
+public:
+    /* Raises one event of type, see invoke_synthetic */
+    using Invoke = void (*)(EventType type, uint64_t connection, uint64_t sequence);
+
+    static constexpr int max_threads = 16;     // per workload
+    static constexpr int max_rate = 1000000;   // events per second and workload
+    static constexpr int max_connections = 16;
+
+    struct Workload {
+        EventType type;
+        int rate;  // events per second over all threads of the workload
+    };
+
+    struct Counters {
+        uint64_t generated;
+        uint64_t late;        // events raised more than one interval after their slot, the rate was not kept
+        uint64_t elapsed_ns;  // since start, until the last thread finished
+    };
+
+    LoadGenerator() = default;
+    LoadGenerator(const LoadGenerator&) = delete;
+    LoadGenerator& operator=(const LoadGenerator&) = delete;
+    ~LoadGenerator() { stop(); }
+
+    /*
+     * Runs threads threads per workload for duration_ms, or until stop if 0. The events take turns
+     * over connections consecutive server connection handler IDs from connection on. Fails while the
+     * previous run is still generating. Must not be called from an event listener.
+     */
+    bool start(Invoke invoke, const std::vector<Workload>& workloads, int threads, uint64_t connection, int connections, int duration_ms);
+    void stop();
+    bool is_running() const { return m_active.load(std::memory_order_relaxed) != 0; }
+
+    Counters counters(EventType type) const;
+
+    /* How long the callbacks blocked the generating threads */
+    const LatencyHistogram& call_latency(EventType type) const { return m_types[type].call; }
+
+private:
+    struct TypeCounters {
+        std::atomic<uint64_t> generated{0};
+        std::atomic<uint64_t> late{0};
+        LatencyHistogram call;
+    };
+
+    void run(Workload workload, int thread, int threads);
+
+    Invoke m_invoke = nullptr;
+    uint64_t m_connection = 0;
+    uint64_t m_connections = 1;
+    uint64_t m_start_ns = 0;
+    uint64_t m_end_ns = 0;  // 0 for no end
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_stopping{false};
+    std::atomic<int> m_active{0};
+    std::atomic<uint64_t> m_finished_ns{0};
+    TypeCounters m_types[EventType_Count];
+};
@@ -0,0 +1,272 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "native_log.h"
+#include "teamspeak/clientlib.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <thread>
+
+static_assert(sizeof(LogSlot) == 256, "log records are 256 bytes");
+
+/* Start of a ring file, the slots follow */
+struct LogFileHeader {
+    static constexpr uint64_t magic_value = 0x31474f4c33535400;  // "\0TS3LOG1"
+    static constexpr uint32_t version_value = 1;
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    std::atomic<uint64_t> head;
+    uint64_t reserved[4];
+};
+
+static_assert(sizeof(LogFileHeader) == 64, "slots start cache line aligned");
+
+struct NativeLog::File {
+    void* mapping;
+    std::size_t size;
+    LogRing ring;
+};
+
+template <typename T>
+static void append(std::vector<uint8_t>& out, T value) {
+    const auto size = out.size();
+    out.resize(size + sizeof(T));
+    std::memcpy(out.data() + size, &value, sizeof(T));
+}
+
+/* Length of text cut to available bytes, without cutting a UTF-8 sequence in half */
+static std::size_t fitted_length(const char* text, std::size_t available) {
+    std::size_t length = text ? std::strlen(text) : 0;
+    if (length > available) {
+        length = available;
+        while (length > 0 && (static_cast<unsigned char>(text[length]) & 0xC0) == 0x80)
+            --length;
+    }
+    return length;
+}
+
+static std::size_t round_up_power_of_two(std::size_t value) {
+    std::size_t result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+/* Reserves the batch header, finish_batch fills it in */
+static void begin_batch(std::vector<uint8_t>& out) {
+    out.assign(sizeof(uint32_t) * 2 + sizeof(uint64_t), 0);
+}
+
+static void finish_batch(std::vector<uint8_t>& out, std::size_t count, uint64_t lost) {
+    const auto records = static_cast<uint32_t>(count);
+    std::memcpy(out.data(), &records, sizeof(records));
+    std::memcpy(out.data() + sizeof(uint32_t) * 2, &lost, sizeof(lost));
+}
+
+LogRing::LogRing(std::atomic<uint64_t>* head, LogSlot* slots, std::size_t capacity)
+    : m_head(head), m_slots(slots), m_capacity(capacity) {}
+
+void LogRing::write(uint64_t time_ns, uint64_t connection, int level, const char* channel, const char* message) {
+    const auto position = m_head->fetch_add(1, std::memory_order_relaxed);
+    auto& slot = m_slots[position & (m_capacity - 1)];
+    const uint64_t writing = 2 * position + 1;
+    auto current = slot.word[0].load(std::memory_order_relaxed);
+    for (;;) {
+        // A producer a whole lap ahead took the slot already, readers count this record as lost
+        if (current >= writing)
+            return;
+        // The previous lap is still copying into the slot
+        if (current & 1) {
+            std::this_thread::yield();
+            current = slot.word[0].load(std::memory_order_relaxed);
+            continue;
+        }
+        if (slot.word[0].compare_exchange_weak(current, writing, std::memory_order_relaxed))
+            break;
+    }
+
+    char text[text_capacity];
+    const auto channel_length = fitted_length(channel, text_capacity);
+    const auto message_length = fitted_length(message, text_capacity - channel_length);
+    if (channel_length)
+        std::memcpy(text, channel, channel_length);
+    if (message_length)
+        std::memcpy(text + channel_length, message, message_length);
+    const auto text_length = channel_length + message_length;
+
+    // Release stores: a reader that loads any of these words also sees the odd sequence stored above
+    slot.word[1].store(time_ns, std::memory_order_release);
+    slot.word[2].store(connection, std::memory_order_release);
+    slot.word[3].store(static_cast<uint32_t>(level) | static_cast<uint64_t>(channel_length) << 32 | static_cast<uint64_t>(message_length) << 48,
+                       std::memory_order_release);
+    for (std::size_t offset = 0; offset < text_length; offset += sizeof(uint64_t)) {
+        uint64_t word = 0;
+        std::memcpy(&word, text + offset, std::min(sizeof(uint64_t), text_length - offset));
+        slot.word[header_words + offset / sizeof(uint64_t)].store(word, std::memory_order_release);
+    }
+    slot.word[0].store(writing + 1, std::memory_order_release);
+}
+
+std::size_t LogRing::read(uint64_t& cursor, std::size_t max, bool final, std::vector<uint8_t>& out, uint64_t& lost) const {
+    const auto head = m_head->load(std::memory_order_acquire);
+    if (cursor > head)
+        cursor = head;
+    if (head - cursor > m_capacity) {
+        lost += head - m_capacity - cursor;
+        cursor = head - m_capacity;
+    }
+
+    std::size_t count = 0;
+    uint64_t words[LogSlot::words];
+    for (; cursor < head && count < max; ++cursor) {
+        const auto& slot = m_slots[cursor & (m_capacity - 1)];
+        const uint64_t complete = 2 * cursor + 2;
+        const auto sequence = slot.word[0].load(std::memory_order_acquire);
+        if (sequence < complete && !final)
+            break;
+        if (sequence != complete) {
+            ++lost;
+            continue;
+        }
+        // Acquire loads pair with the release stores of write, the sequence loaded after them then shows
+        // any writer whose words were copied
+        for (std::size_t i = 1; i < LogSlot::words; ++i)
+            words[i] = slot.word[i].load(std::memory_order_acquire);
+        // Overwritten while it was copied
+        if (slot.word[0].load(std::memory_order_acquire) != complete) {
+            ++lost;
+            continue;
+        }
+
+        const auto channel_length = static_cast<uint16_t>(words[3] >> 32);
+        const auto message_length = static_cast<uint16_t>(words[3] >> 48);
+        const auto* text = reinterpret_cast<const uint8_t*>(words + header_words);
+        append(out, cursor);
+        append(out, static_cast<int64_t>(words[1]));
+        append(out, words[2]);
+        append(out, static_cast<int32_t>(static_cast<uint32_t>(words[3])));
+        append(out, channel_length);
+        append(out, message_length);
+        out.insert(out.end(), text, text + channel_length + message_length);
+        ++count;
+    }
+    return count;
+}
+
+NativeLog::NativeLog()
+    : m_level(LogLevel_DEVEL),
+      m_slots(new LogSlot[memory_records]()),
+      m_ring(&m_head, m_slots.get(), memory_records) {}
+
+bool NativeLog::write(int level, const char* channel, uint64_t connection, const char* message) {
+    if (level > m_level.load(std::memory_order_relaxed))
+        return false;
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    const auto time_ns = static_cast<uint64_t>(now.tv_sec) * 1000000000u + static_cast<uint64_t>(now.tv_nsec);
+
+    m_ring.write(time_ns, connection, level, channel, message);
+    m_file_writers.fetch_add(1);
+    if (auto* file = m_file.load())
+        file->ring.write(time_ns, connection, level, channel, message);
+    m_file_writers.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+bool NativeLog::open_file(const char* path, std::size_t records) {
+    if (!path || records == 0 || records > max_file_records)
+        return false;
+    records = round_up_power_of_two(records);
+
+    std::lock_guard<std::mutex> lock(m_file_mutex);
+    release_file();
+
+    const int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return false;
+    const auto size = sizeof(LogFileHeader) + records * sizeof(LogSlot);
+    void* mapping = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+        mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    // The file is zero filled, the magic goes in last so a file torn while opening is never read
+    auto* header = static_cast<LogFileHeader*>(mapping);
+    header->version = LogFileHeader::version_value;
+    header->record_size = sizeof(LogSlot);
+    header->capacity = records;
+    header->magic = LogFileHeader::magic_value;
+    m_file.store(new File{mapping, size, LogRing(&header->head, reinterpret_cast<LogSlot*>(header + 1), records)});
+    return true;
+}
+
+void NativeLog::close_file() {
+    std::lock_guard<std::mutex> lock(m_file_mutex);
+    release_file();
+}
+
+void NativeLog::release_file() {
+    auto* file = m_file.exchange(nullptr);
+    if (!file)
+        return;
+    while (m_file_writers.load(std::memory_order_acquire) != 0)
+        std::this_thread::yield();
+    munmap(file->mapping, file->size);
+    delete file;
+}
+
+void NativeLog::drain(std::size_t max, std::vector<uint8_t>& out) {
+    std::lock_guard<std::mutex> lock(m_drain_mutex);
+    uint64_t lost = 0;
+    begin_batch(out);
+    const auto count = m_ring.read(m_cursor, max, false, out, lost);
+    finish_batch(out, count, lost);
+}
+
+bool NativeLog::read_file(const char* path, std::vector<uint8_t>& out) {
+    const int fd = path ? ::open(path, O_RDONLY | O_CLOEXEC) : -1;
+    if (fd < 0)
+        return false;
+    struct stat info;
+    std::size_t size = 0;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(LogFileHeader)) {
+        size = static_cast<std::size_t>(info.st_size);
+        // Private and writable only because the ring reads through atomics, nothing is written back
+        mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    auto* header = static_cast<LogFileHeader*>(mapping);
+    const auto capacity = header->capacity;
+    const bool valid = header->magic == LogFileHeader::magic_value && header->version == LogFileHeader::version_value &&
+                       header->record_size == sizeof(LogSlot) && capacity != 0 && capacity <= max_file_records &&
+                       (capacity & (capacity - 1)) == 0 && size >= sizeof(LogFileHeader) + capacity * sizeof(LogSlot);
+    if (valid) {
+        const LogRing ring(&header->head, reinterpret_cast<LogSlot*>(header + 1), capacity);
+        uint64_t cursor = 0;
+        uint64_t lost = 0;
+        begin_batch(out);
+        const auto count = ring.read(cursor, std::numeric_limits<std::size_t>::max(), true, out, lost);
+        finish_batch(out, count, lost);
+    }
+    munmap(mapping, size);
+    return valid;
+}
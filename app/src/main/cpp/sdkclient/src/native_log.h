@@ -0,0 +1,108 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Clientlib log lines below a runtime level go into a fixed-size ring of records that Java drains in
+ * batches, and optionally into a second ring in a memory mapped file. The file is written by the logging
+ * thread itself, so whatever was logged before a crash is on disk and can be read by the next run.
+ *
+ * A record is one 256 byte slot of 64 bit words. Word 0 is the sequence of the slot: odd while a
+ * producer writes position (sequence - 1) / 2, even once it is complete. Producers never take a lock,
+ * the oldest records are overwritten and readers count them as lost.
+ *
+ * Drain and file layout, native byte order, not padded:
+ *   u32 record count
+ *   u32 reserved
+ *   u64 records lost          overwritten before they were read, or torn by a crash
+ *   per record:
+ *     u64 sequence            position in the log, consecutive unless records were lost
+ *     i64 time                ns since the epoch
+ *     u64 log ID              server connection handler, 0 for the clientlib itself
+ *     i32 level               LogLevel
+ *     u16 channel length, u16 message length
+ *     UTF-8 channel bytes, UTF-8 message bytes, truncated to 224 bytes together
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct LogSlot {
+    static constexpr std::size_t words = 32;
+    std::atomic<uint64_t> word[words];
+};
+
+/* Ring over storage it does not own, the NativeLog memory or a mapped file */
+class LogRing {
+public:
+    static constexpr std::size_t header_words = 4;
+    static constexpr std::size_t text_capacity = (LogSlot::words - header_words) * sizeof(uint64_t);
+
+    /* capacity must be a power of two */
+    LogRing(std::atomic<uint64_t>* head, LogSlot* slots, std::size_t capacity);
+
+    void write(uint64_t time_ns, uint64_t connection, int level, const char* channel, const char* message);
+
+    /*
+     * Appends up to max records from cursor on to out and advances cursor. Stops at a record that is
+     * still written unless final, then it counts as lost like one that was overwritten.
+     */
+    std::size_t read(uint64_t& cursor, std::size_t max, bool final, std::vector<uint8_t>& out, uint64_t& lost) const;
+
+private:
+    std::atomic<uint64_t>* m_head;
+    LogSlot* m_slots;
+    std::size_t m_capacity;
+};
+
+class NativeLog {
+public:
+    static constexpr std::size_t memory_records = 1024;
+    static constexpr std::size_t max_file_records = 1 << 20;
+
+    NativeLog();
+    NativeLog(const NativeLog&) = delete;
+    NativeLog& operator=(const NativeLog&) = delete;
+    ~NativeLog() { close_file(); }
+
+    /* Lines above level are dropped, LogLevel_DEVEL keeps everything */
+    void set_level(int level) { m_level.store(level, std::memory_order_relaxed); }
+    int level() const { return m_level.load(std::memory_order_relaxed); }
+
+    /* Records a clientlib log line, false if it is above the level */
+    bool write(int level, const char* channel, uint64_t connection, const char* message);
+
+    /* Starts a new ring file of records slots at path, replacing the one written so far */
+    bool open_file(const char* path, std::size_t records);
+    void close_file();
+
+    /* Serializes up to max records logged since the last drain, see the layout above */
+    void drain(std::size_t max, std::vector<uint8_t>& out);
+
+    /* Serializes everything in a ring file, typically the one of a previous run */
+    static bool read_file(const char* path, std::vector<uint8_t>& out);
+
+private:
+    struct File;
+
+    /* Unmaps the file once no writer uses it, m_file_mutex must be held */
+    void release_file();
+
+    std::atomic<int> m_level;
+    std::atomic<uint64_t> m_head{0};
+    std::unique_ptr<LogSlot[]> m_slots;
+    LogRing m_ring;
+
+    std::mutex m_drain_mutex;
+    uint64_t m_cursor = 0;
+
+    // Writers announce themselves before loading m_file, close waits for them before unmapping
+    std::mutex m_file_mutex;
+    std::atomic<File*> m_file{nullptr};
+    std::atomic<int> m_file_writers{0};
+};
@@ -0,0 +1,167 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Wait-free single producer / single consumer ring of interleaved 16 bit PCM. Counts are in frames, the
+ * producer may write any number of frames, the consumer reads at its own cadence.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+
+class PcmRing {
+public:
+    struct Counters {
+        uint64_t fill;            // frames
+        uint64_t capacity;        // frames
+        uint64_t high_water;      // frames
+        uint64_t overrun_frames;  // discarded by write because the ring was full
+        uint64_t underruns;       // reads that got fewer frames than requested
+    };
+
+    /*
+     * Allocates room for at least capacity samples on the first call, later calls only check that capacity
+     * fits. Storage is never released or resized, so a producer racing with a reconfiguration can at worst
+     * write stale frames, never out of bounds. Size it for the largest format the ring will carry.
+     */
+    bool allocate(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        if (size <= m_size.load(std::memory_order_acquire))
+            return true;
+        if (m_storage.load(std::memory_order_relaxed))
+            return false;
+        auto* storage = new (std::nothrow) short[size]();
+        if (!storage)
+            return false;
+        m_owner.reset(storage);
+        m_size.store(size, std::memory_order_relaxed);
+        m_storage.store(storage, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * Empties the ring and resets the counters while neither side is active. A call racing with it stays in
+     * bounds, it loads the channel count once.
+     */
+    void configure(int channels) {
+        m_channels.store(channels > 0 ? static_cast<std::size_t>(channels) : 1, std::memory_order_release);
+        m_read.store(0, std::memory_order_relaxed);
+        m_write.store(0, std::memory_order_relaxed);
+        m_high_water.store(0, std::memory_order_relaxed);
+        m_overrun_frames.store(0, std::memory_order_relaxed);
+        m_underruns.store(0, std::memory_order_relaxed);
+    }
+
+    bool is_allocated() const { return m_storage.load(std::memory_order_acquire) != nullptr; }
+
+    /* Producer side. Returns the number of frames stored, the rest is counted as overrun. */
+    std::size_t write(const short* samples, std::size_t frames) {
+        short* storage = m_storage.load(std::memory_order_acquire);
+        if (!storage)
+            return 0;
+        const auto channels = m_channels.load(std::memory_order_acquire);
+        const auto write = m_write.load(std::memory_order_relaxed);
+        const auto read = m_read.load(std::memory_order_acquire);
+        const auto capacity = capacity_samples(channels);
+        const auto used = write - read;
+        const auto free_frames = used < capacity ? (capacity - used) / channels : 0;
+        const auto count = std::min(frames, free_frames);
+        if (count < frames)
+            m_overrun_frames.fetch_add(frames - count, std::memory_order_relaxed);
+
+        copy_in(storage, write, samples, count * channels);
+        m_write.store(write + count * channels, std::memory_order_release);
+
+        const uint64_t fill = (used + count * channels) / channels;
+        if (fill > m_high_water.load(std::memory_order_relaxed))
+            m_high_water.store(fill, std::memory_order_relaxed);
+        return count;
+    }
+
+    /* Consumer side. Returns the number of frames read. */
+    std::size_t read(short* samples, std::size_t frames) {
+        const short* storage = m_storage.load(std::memory_order_acquire);
+        if (!storage)
+            return 0;
+        const auto channels = m_channels.load(std::memory_order_acquire);
+        const auto read = m_read.load(std::memory_order_relaxed);
+        const auto write = m_write.load(std::memory_order_acquire);
+        const auto count = std::min(frames, std::min(write - read, capacity_samples(channels)) / channels);
+        if (count < frames)
+            m_underruns.fetch_add(1, std::memory_order_relaxed);
+
+        copy_out(storage, read, samples, count * channels);
+        m_read.store(read + count * channels, std::memory_order_release);
+        return count;
+    }
+
+    /* Frames currently stored, exact on the consumer side, a lower bound for the producer */
+    std::size_t fill() const {
+        const auto channels = m_channels.load(std::memory_order_acquire);
+        const auto used = m_write.load(std::memory_order_acquire) - m_read.load(std::memory_order_acquire);
+        return std::min(used, capacity_samples(channels)) / channels;
+    }
+
+    std::size_t capacity() const {
+        const auto channels = m_channels.load(std::memory_order_acquire);
+        return capacity_samples(channels) / channels;
+    }
+
+    /* Samples written and read since configure, e.g. to follow chunks through the ring */
+    std::size_t write_position() const { return m_write.load(std::memory_order_acquire); }
+    std::size_t read_position() const { return m_read.load(std::memory_order_acquire); }
+
+    Counters counters() const {
+        Counters result;
+        result.fill = fill();
+        result.capacity = capacity();
+        result.high_water = m_high_water.load(std::memory_order_relaxed);
+        result.overrun_frames = m_overrun_frames.load(std::memory_order_relaxed);
+        result.underruns = m_underruns.load(std::memory_order_relaxed);
+        return result;
+    }
+
+private:
+    /* The usable capacity is a whole number of frames */
+    std::size_t capacity_samples(std::size_t channels) const {
+        const auto size = m_size.load(std::memory_order_relaxed);
+        return size - size % channels;
+    }
+
+    void copy_in(short* storage, std::size_t position, const short* samples, std::size_t count) {
+        const auto size = m_size.load(std::memory_order_relaxed);
+        const auto offset = position & (size - 1);
+        const auto first = std::min(count, size - offset);
+        std::memcpy(storage + offset, samples, first * sizeof(short));
+        std::memcpy(storage, samples + first, (count - first) * sizeof(short));
+    }
+
+    void copy_out(const short* storage, std::size_t position, short* samples, std::size_t count) const {
+        const auto size = m_size.load(std::memory_order_relaxed);
+        const auto offset = position & (size - 1);
+        const auto first = std::min(count, size - offset);
+        std::memcpy(samples, storage + offset, first * sizeof(short));
+        std::memcpy(samples + first, storage, (count - first) * sizeof(short));
+    }
+
+    std::atomic<short*> m_storage{nullptr};
+    std::unique_ptr<short[]> m_owner;
+    std::atomic<std::size_t> m_size{0};
+    std::atomic<std::size_t> m_channels{1};
+
+    alignas(64) std::atomic<std::size_t> m_write{0};
+    alignas(64) std::atomic<std::size_t> m_read{0};
+
+    std::atomic<uint64_t> m_high_water{0};
+    std::atomic<uint64_t> m_overrun_frames{0};
+    std::atomic<uint64_t> m_underruns{0};
+};
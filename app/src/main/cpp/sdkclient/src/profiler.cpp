@@ -0,0 +1,242 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "profiler.h"
+#include "audio_latency.h"
+
+/* Bucket b counts calls of at least 2^(b-1) and below 2^b ns, as in LatencyHistogram */
+static std::string csv_header(ProfileFormat format) {
+    if (format != ProfileFormat_Csv)
+        return {};
+    std::string header = "function,calls,total_ns,p50_ns,p99_ns,max_ns";
+    for (int b = 0; b < LatencyHistogram::buckets; ++b)
+        header += ",bucket" + std::to_string(b);
+    return header + "\n";
+}
+
+#if defined(PROFILE_BUILD)
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/* Only the owning thread writes, readers merge with relaxed loads */
+struct PointCounters {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+    std::atomic<uint64_t> buckets[LatencyHistogram::buckets] = {};
+};
+
+struct ThreadProfile {
+    PointCounters points[ProfilePoint::max_points];
+    std::atomic<uint64_t> generation{0};
+};
+
+struct PointTotals {
+    uint64_t calls = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    uint64_t buckets[LatencyHistogram::buckets] = {};
+};
+
+struct PointName {
+    const char* name;
+    const char* category;
+};
+
+std::mutex gPointMutex;
+PointName gPointNames[ProfilePoint::max_points];
+std::atomic<int> gPointCount{0};
+
+/* Bumped by profile_reset, each thread clears its own table when it sees a new generation */
+std::atomic<uint64_t> gGeneration{1};
+
+std::mutex gThreadMutex;
+std::vector<ThreadProfile*> gThreads;
+PointTotals gRetired[ProfilePoint::max_points];  // threads that exited, guarded by gThreadMutex
+
+inline void increment(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void clear(ThreadProfile& profile) {
+    for (auto& point : profile.points) {
+        point.calls.store(0, std::memory_order_relaxed);
+        point.total_ns.store(0, std::memory_order_relaxed);
+        point.max_ns.store(0, std::memory_order_relaxed);
+        for (auto& bucket : point.buckets)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+/* Caller holds gThreadMutex */
+void merge(const ThreadProfile& profile, PointTotals* totals, int count) {
+    if (profile.generation.load(std::memory_order_relaxed) != gGeneration.load(std::memory_order_relaxed))
+        return;
+    for (int i = 0; i < count; ++i) {
+        const auto& point = profile.points[i];
+        auto& total = totals[i];
+        total.calls += point.calls.load(std::memory_order_relaxed);
+        total.total_ns += point.total_ns.load(std::memory_order_relaxed);
+        total.max_ns = std::max(total.max_ns, point.max_ns.load(std::memory_order_relaxed));
+        for (int b = 0; b < LatencyHistogram::buckets; ++b)
+            total.buckets[b] += point.buckets[b].load(std::memory_order_relaxed);
+    }
+}
+
+/* Registers the table of the calling thread on first use and folds it into the retired totals on thread exit */
+class ThreadSlot {
+public:
+    ~ThreadSlot() {
+        if (!m_profile)
+            return;
+        std::lock_guard<std::mutex> lock(gThreadMutex);
+        merge(*m_profile, gRetired, gPointCount.load(std::memory_order_acquire));
+        gThreads.erase(std::find(gThreads.begin(), gThreads.end(), m_profile));
+        delete m_profile;
+    }
+
+    ThreadProfile& get() {
+        if (!m_profile) {
+            m_profile = new ThreadProfile;
+            m_profile->generation.store(gGeneration.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(gThreadMutex);
+            gThreads.push_back(m_profile);
+        }
+        return *m_profile;
+    }
+
+private:
+    ThreadProfile* m_profile = nullptr;
+};
+
+thread_local ThreadSlot tProfile;
+
+void record(int index, uint64_t ns) {
+    auto& profile = tProfile.get();
+    const auto generation = gGeneration.load(std::memory_order_relaxed);
+    if (profile.generation.load(std::memory_order_relaxed) != generation) {
+        clear(profile);
+        profile.generation.store(generation, std::memory_order_relaxed);
+    }
+    auto& point = profile.points[index];
+    increment(point.calls, 1);
+    increment(point.total_ns, ns);
+    if (ns > point.max_ns.load(std::memory_order_relaxed))
+        point.max_ns.store(ns, std::memory_order_relaxed);
+    increment(point.buckets[LatencyHistogram::bucket_of(ns)], 1);
+}
+
+/* Java_..._Native_ts3client_1startInit becomes ts3client_startInit, an event class path its class name */
+std::string display_name(const PointName& point) {
+    std::string name = point.name ? point.name : "(unnamed)";
+    const auto native = name.find("_Native_");
+    if (name.compare(0, 5, "Java_") == 0 && native != std::string::npos) {
+        name.erase(0, native + 8);
+        for (auto escape = name.find("_1"); escape != std::string::npos; escape = name.find("_1", escape + 1))
+            name.erase(escape + 1, 1);
+    }
+    const auto slash = name.rfind('/');
+    if (slash != std::string::npos)
+        name.erase(0, slash + 1);
+    return point.category ? std::string(point.category) + " " + name : name;
+}
+
+}  // namespace
+
+ProfilePoint::ProfilePoint(const char* name, const char* category) : m_index(-1) {
+    std::lock_guard<std::mutex> lock(gPointMutex);
+    const auto count = gPointCount.load(std::memory_order_relaxed);
+    if (count >= max_points)
+        return;
+    gPointNames[count] = {name, category};
+    gPointCount.store(count + 1, std::memory_order_release);
+    m_index = count;
+}
+
+ProfileScope::ProfileScope(const ProfilePoint& point) : m_index(point.index()), m_start(monotonic_ns()) {}
+
+ProfileScope::~ProfileScope() {
+    if (m_index >= 0)
+        record(m_index, monotonic_ns() - m_start);
+}
+
+std::string profile_report(ProfileFormat format) {
+    const auto count = gPointCount.load(std::memory_order_acquire);
+    std::vector<PointTotals> totals;
+    {
+        std::lock_guard<std::mutex> lock(gThreadMutex);
+        totals.assign(gRetired, gRetired + count);
+        for (const auto* profile : gThreads)
+            merge(*profile, totals.data(), count);
+    }
+
+    std::vector<int> order;
+    std::size_t width = 8;
+    for (int i = 0; i < count; ++i) {
+        if (totals[i].calls == 0)
+            continue;
+        order.push_back(i);
+        width = std::max(width, display_name(gPointNames[i]).size());
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return totals[a].total_ns > totals[b].total_ns; });
+
+    std::string report = csv_header(format);
+    char line[512];
+    if (format == ProfileFormat_Table) {
+        std::snprintf(line, sizeof(line), "%-*s %10s %12s %10s %10s %10s %10s\n", static_cast<int>(width), "function",
+                      "calls", "total ms", "mean us", "p50 us", "p99 us", "max us");
+        report += line;
+    }
+    for (const int i : order) {
+        const auto& total = totals[i];
+        const auto p50 = LatencyHistogram::percentile(total.buckets, total.calls, total.max_ns, 500);
+        const auto p99 = LatencyHistogram::percentile(total.buckets, total.calls, total.max_ns, 990);
+        if (format == ProfileFormat_Csv) {
+            std::snprintf(line, sizeof(line), "%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64,
+                          display_name(gPointNames[i]).c_str(), total.calls, total.total_ns, p50, p99, total.max_ns);
+            report += line;
+            for (const auto bucket : total.buckets)
+                report += "," + std::to_string(bucket);
+            report += "\n";
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "%-*s %10" PRIu64 " %12.3f %10.2f %10.2f %10.2f %10.2f\n",
+                      static_cast<int>(width), display_name(gPointNames[i]).c_str(), total.calls,
+                      static_cast<double>(total.total_ns) / 1e6,
+                      static_cast<double>(total.total_ns) / static_cast<double>(total.calls) / 1e3,
+                      static_cast<double>(p50) / 1e3, static_cast<double>(p99) / 1e3,
+                      static_cast<double>(total.max_ns) / 1e3);
+        report += line;
+    }
+    return report;
+}
+
+void profile_reset() {
+    std::lock_guard<std::mutex> lock(gThreadMutex);
+    gGeneration.fetch_add(1, std::memory_order_relaxed);
+    for (auto& retired : gRetired)
+        retired = PointTotals{};
+}
+
+#else
+
+std::string profile_report(ProfileFormat format) {
+    if (format == ProfileFormat_Csv)
+        return csv_header(format);
+    return "Profiling is not compiled in, configure with -DPROFILE_BUILD=ON\n";
+}
+
+void profile_reset() {}
+
+#endif
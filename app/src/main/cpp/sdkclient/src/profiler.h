@@ -0,0 +1,74 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Per entry point call profiler, compiled in with -DPROFILE_BUILD=ON. Every thread counts into its own
+ * table, so timing a call costs two clock reads and a few uncontended stores. The tables are merged when a
+ * report is requested. Without PROFILE_BUILD the scopes compile to nothing.
+ */
+#pragma once
+
+#include <string>
+
+#if defined(PROFILE_BUILD)
+
+#include <cstdint>
+
+class ProfilePoint {
+public:
+    /* Points beyond max_points are not counted */
+    static constexpr int max_points = 128;
+
+    /* The report shows the category, then the last path component of name. Both must outlive the process. */
+    explicit ProfilePoint(const char* name, const char* category = nullptr);
+    int index() const { return m_index; }
+
+private:
+    int m_index;
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const ProfilePoint& point);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    int m_index;
+    uint64_t m_start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+/*
+ * Times the rest of the enclosing block. The point is registered on the first call, once per template
+ * instantiation, so event templates can name it after their event.
+ */
+#define PROFILE_SCOPE_NAMED(...) \
+    static const ProfilePoint PROFILE_CONCAT(profile_point_, __LINE__)(__VA_ARGS__); \
+    const ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(PROFILE_CONCAT(profile_point_, __LINE__))
+
+#define PROFILE_SCOPE() PROFILE_SCOPE_NAMED(__FUNCTION__)
+
+#else
+
+#define PROFILE_SCOPE_NAMED(...) do {} while (false)
+#define PROFILE_SCOPE() do {} while (false)
+
+#endif
+
+/* Values of Native.PROFILE_REPORT_* */
+enum ProfileFormat {
+    ProfileFormat_Table = 0,  // aligned columns for reading, in us
+    ProfileFormat_Csv = 1     // header line, then one line per point in ns followed by the histogram buckets
+};
+
+/* All points by total time spent. Without PROFILE_BUILD a table is a note, a csv only the header. */
+std::string profile_report(ProfileFormat format);
+
+/* Clears the counters of all threads. Calls in flight may still be counted. */
+void profile_reset();
@@ -0,0 +1,191 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "resampler.h"
+#include "sample_convert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RESAMPLER_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define RESAMPLER_SSE2 1
+#endif
+
+static constexpr double pi = 3.14159265358979323846;
+
+struct QualityPreset {
+    std::size_t taps;
+    double kaiser_beta;
+    double passband;  // fraction of the lower Nyquist frequency that is kept
+};
+
+static constexpr QualityPreset quality_presets[ResamplerQuality_Count] = {
+        {8, 5.7, 0.80},
+        {24, 8.0, 0.90},
+        {48, 10.0, 0.94}
+};
+
+static std::size_t greatest_common_divisor(std::size_t a, std::size_t b) {
+    while (b != 0) {
+        const auto rest = a % b;
+        a = b;
+        b = rest;
+    }
+    return a;
+}
+
+/* Zeroth order modified Bessel function of the first kind */
+static double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+/* Taps are a multiple of 4, so the vector loops need no tail */
+static inline float dot_product(const float* a, const float* b, std::size_t count) {
+#if defined(RESAMPLER_NEON)
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    for (std::size_t i = 0; i < count; i += 4)
+        sum = vmlaq_f32(sum, vld1q_f32(a + i), vld1q_f32(b + i));
+    const float32x2_t pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+    return vget_lane_f32(vpadd_f32(pair, pair), 0);
+#elif defined(RESAMPLER_SSE2)
+    __m128 sum = _mm_setzero_ps();
+    for (std::size_t i = 0; i < count; i += 4)
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#else
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < count; ++i)
+        sum += a[i] * b[i];
+    return sum;
+#endif
+}
+
+bool PolyphaseResampler::configure(int in_rate, int out_rate, int channels, int quality) {
+    if (in_rate <= 0 || out_rate <= 0 || channels <= 0 || quality < 0 || quality >= ResamplerQuality_Count)
+        return false;
+    const auto divisor = greatest_common_divisor(static_cast<std::size_t>(in_rate), static_cast<std::size_t>(out_rate));
+    const auto interpolation = static_cast<std::size_t>(out_rate) / divisor;
+    const auto decimation = static_cast<std::size_t>(in_rate) / divisor;
+    if (interpolation > max_phases)
+        return false;
+
+    const auto& preset = quality_presets[quality];
+    m_interpolation = interpolation;
+    m_decimation = decimation;
+    m_taps = preset.taps;
+
+    // Prototype low pass at the upsampled rate, cut off below the lower of both Nyquist frequencies
+    const std::size_t length = m_interpolation * m_taps;
+    const double cutoff = preset.passband * 0.5 / static_cast<double>(std::max(m_interpolation, m_decimation));
+    const double center = (static_cast<double>(length) - 1.0) / 2.0;
+    const double window_scale = 1.0 / bessel_i0(preset.kaiser_beta);
+    m_coefficients.assign(length, 0.0f);
+    for (std::size_t phase = 0; phase < m_interpolation; ++phase) {
+        double sum = 0.0;
+        std::vector<double> taps(m_taps);
+        for (std::size_t k = 0; k < m_taps; ++k) {
+            const double n = static_cast<double>(phase + k * m_interpolation) - center;
+            const double x = 2.0 * cutoff * n;
+            const double sinc = std::fabs(x) < 1e-12 ? 1.0 : std::sin(pi * x) / (pi * x);
+            const double r = n / (center + 1.0);
+            const double window = bessel_i0(preset.kaiser_beta * std::sqrt(std::max(0.0, 1.0 - r * r))) * window_scale;
+            taps[k] = sinc * window;
+            sum += taps[k];
+        }
+        // Unity gain per phase, reversed so the dot product runs forward over the input
+        for (std::size_t k = 0; k < m_taps; ++k)
+            m_coefficients[phase * m_taps + (m_taps - 1 - k)] = static_cast<float>(taps[k] / sum);
+    }
+
+    m_in_rate = in_rate;
+    m_out_rate = out_rate;
+    m_channels = channels;
+    m_quality = quality;
+    m_buffer_stride = 0;
+    m_buffer.clear();
+    reset();
+    return true;
+}
+
+void PolyphaseResampler::reset() {
+    std::fill(m_buffer.begin(), m_buffer.end(), 0.0f);
+    m_pending = 0;
+    m_position = 0;
+    m_phase = 0;
+}
+
+std::size_t PolyphaseResampler::max_output_frames(std::size_t in_frames) const {
+    return ((m_pending + in_frames) * m_interpolation + m_interpolation - 1) / m_decimation + 1;
+}
+
+std::size_t PolyphaseResampler::input_frames_needed(std::size_t out_frames) const {
+    if (out_frames == 0)
+        return 0;
+    const auto last = m_position + (m_phase + (out_frames - 1) * m_decimation) / m_interpolation;
+    return last + 1 > m_pending ? last + 1 - m_pending : 0;
+}
+
+std::size_t PolyphaseResampler::process(const short* in, std::size_t in_frames, short* out, std::size_t out_capacity) {
+    const auto channels = static_cast<std::size_t>(m_channels);
+    const auto history = m_taps - 1;
+    const auto available = m_pending + in_frames;
+
+    if (m_buffer_stride < history + available) {
+        // Grow and keep the history and pending frames of every channel
+        const auto stride = history + available;
+        std::vector<float> buffer(stride * channels, 0.0f);
+        for (std::size_t c = 0; c < channels && m_buffer_stride != 0; ++c)
+            std::copy_n(m_buffer.data() + c * m_buffer_stride, history + m_pending, buffer.data() + c * stride);
+        m_buffer.swap(buffer);
+        m_buffer_stride = stride;
+    }
+    for (std::size_t c = 0; c < channels; ++c) {
+        float* channel = m_buffer.data() + c * m_buffer_stride + history + m_pending;
+        for (std::size_t i = 0; i < in_frames; ++i)
+            channel[i] = static_cast<float>(in[i * channels + c]) * (1.0f / 32768.0f);
+    }
+
+    if (m_output.size() < out_capacity * channels)
+        m_output.resize(out_capacity * channels);
+    std::size_t produced = 0;
+    while (produced < out_capacity && m_position < available) {
+        const float* coefficients = m_coefficients.data() + m_phase * m_taps;
+        for (std::size_t c = 0; c < channels; ++c)
+            m_output[produced * channels + c] = dot_product(coefficients, m_buffer.data() + c * m_buffer_stride + m_position, m_taps);
+        ++produced;
+        m_phase += m_decimation;
+        m_position += m_phase / m_interpolation;
+        m_phase %= m_interpolation;
+    }
+    float_to_int16(m_output.data(), out, produced * channels, nullptr);
+
+    // Drop the frames no future output can reach
+    const auto consumed = std::min(m_position, available);
+    if (consumed != 0) {
+        for (std::size_t c = 0; c < channels; ++c) {
+            float* channel = m_buffer.data() + c * m_buffer_stride;
+            std::memmove(channel, channel + consumed, (history + available - consumed) * sizeof(float));
+        }
+    }
+    m_pending = available - consumed;
+    m_position -= consumed;
+    return produced;
+}
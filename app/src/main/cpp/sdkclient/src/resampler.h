@@ -0,0 +1,67 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Polyphase windowed-sinc sample rate converter for interleaved 16 bit PCM, used between the rate a custom
+ * device runs at and the rate registered with the clientlib. The ratio is reduced to out/in = L/M, the
+ * filter has L phases of a preset dependent number of taps.
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/* Values of Native.RESAMPLER_QUALITY_* */
+enum ResamplerQuality {
+    ResamplerQuality_Fast = 0,    // 8 taps per phase, about 67 dB stop band
+    ResamplerQuality_Medium = 1,  // 24 taps, about 84 dB
+    ResamplerQuality_High = 2,    // 48 taps, about 85 dB but a wider pass band than Medium
+    ResamplerQuality_Count
+};
+
+class PolyphaseResampler {
+public:
+    /* Phases are interpolation * taps floats, this bounds the coefficient table for odd ratios */
+    static constexpr std::size_t max_phases = 4096;
+
+    /* Returns false for invalid rates or a ratio that needs more than max_phases phases. Allocates. */
+    bool configure(int in_rate, int out_rate, int channels, int quality);
+    bool is_configured(int in_rate, int out_rate, int channels, int quality) const {
+        return m_in_rate == in_rate && m_out_rate == out_rate && m_channels == channels && m_quality == quality;
+    }
+
+    /* Clears the filter history */
+    void reset();
+
+    /* Upper bound of the frames process produces from in_frames */
+    std::size_t max_output_frames(std::size_t in_frames) const;
+
+    /* Input frames process needs to produce exactly out_frames */
+    std::size_t input_frames_needed(std::size_t out_frames) const;
+
+    /*
+     * Consumes all in_frames and writes at most out_capacity frames, returns the frames written. Input
+     * that did not fit is kept for the next call. Grows internal buffers on the first call of a new block size.
+     */
+    std::size_t process(const short* in, std::size_t in_frames, short* out, std::size_t out_capacity);
+
+private:
+    int m_in_rate = 0;
+    int m_out_rate = 0;
+    int m_channels = 0;
+    int m_quality = -1;
+
+    std::size_t m_interpolation = 1;  // L
+    std::size_t m_decimation = 1;     // M
+    std::size_t m_taps = 0;
+    std::vector<float> m_coefficients;  // per phase, in reverse tap order
+
+    /* Per channel: taps - 1 frames of history, then pending input not yet consumed */
+    std::vector<float> m_buffer;
+    std::size_t m_buffer_stride = 0;
+    std::size_t m_pending = 0;
+    std::size_t m_position = 0;  // input frame of the next output, relative to the first pending frame
+    std::size_t m_phase = 0;
+    std::vector<float> m_output;
+};
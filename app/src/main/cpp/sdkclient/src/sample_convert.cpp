@@ -0,0 +1,225 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "sample_convert.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SAMPLE_CONVERT_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SAMPLE_CONVERT_SSE2 1
+#endif
+
+static constexpr float int16_scale = 32768.0f;
+
+static inline uint32_t next_random(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/* Uniform in [-0.5, 0.5) from the upper mantissa bits */
+static inline float uniform(uint32_t random) {
+    uint32_t bits = (random >> 9) | 0x3f800000u;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value - 1.5f;
+}
+
+static void float_to_int16_scalar(const float* in, short* out, std::size_t count, DitherState* dither) {
+    for (std::size_t i = 0; i < count; ++i) {
+        float value = in[i] * int16_scale;
+        if (dither) {
+            auto& state = dither->lanes[i & 3];
+            value += uniform(next_random(state)) + uniform(next_random(state));
+        }
+        value = std::fmin(std::fmax(value, -32768.0f), 32767.0f);
+        out[i] = static_cast<short>(std::lrintf(value));
+    }
+}
+
+static void int16_to_float_scalar(const short* in, float* out, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = static_cast<float>(in[i]) * (1.0f / int16_scale);
+}
+
+void float_to_int16(const float* in, short* out, std::size_t count, DitherState* dither) {
+    std::size_t i = 0;
+#if defined(SAMPLE_CONVERT_NEON)
+    const float32x4_t scale = vdupq_n_f32(int16_scale);
+    uint32x4_t state = dither ? vld1q_u32(dither->lanes) : vdupq_n_u32(0);
+    const uint32x4_t one = vdupq_n_u32(0x3f800000u);
+    const float32x4_t three_halves = vdupq_n_f32(1.5f);
+    auto noise = [&]() {
+        state = veorq_u32(state, vshlq_n_u32(state, 13));
+        state = veorq_u32(state, vshrq_n_u32(state, 17));
+        state = veorq_u32(state, vshlq_n_u32(state, 5));
+        return vsubq_f32(vreinterpretq_f32_u32(vorrq_u32(vshrq_n_u32(state, 9), one)), three_halves);
+    };
+    auto convert = [&](float32x4_t value) {
+        value = vmulq_f32(value, scale);
+        if (dither) {
+            const auto first = noise();
+            value = vaddq_f32(value, vaddq_f32(first, noise()));
+        }
+#if defined(__aarch64__)
+        return vcvtnq_s32_f32(value);
+#else
+        // vcvtq truncates. Round half to even like vcvtnq and lrintf instead: adding 1.5 * 2^23 to the
+        // clamped value leaves it rounded in the low mantissa bits, the bits of 1.5 * 2^23 are subtracted.
+        value = vminq_f32(vmaxq_f32(value, vdupq_n_f32(-32768.0f)), vdupq_n_f32(32767.0f));
+        const int32x4_t rounded = vreinterpretq_s32_f32(vaddq_f32(value, vdupq_n_f32(12582912.0f)));
+        return vsubq_s32(rounded, vdupq_n_s32(0x4B400000));
+#endif
+    };
+    for (; i + 8 <= count; i += 8) {
+        const int32x4_t low = convert(vld1q_f32(in + i));
+        const int32x4_t high = convert(vld1q_f32(in + i + 4));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+    }
+    if (dither)
+        vst1q_u32(dither->lanes, state);
+#elif defined(SAMPLE_CONVERT_SSE2)
+    const __m128 scale = _mm_set1_ps(int16_scale);
+    const __m128 minimum = _mm_set1_ps(-32768.0f);
+    const __m128 maximum = _mm_set1_ps(32767.0f);
+    __m128i state = dither ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(dither->lanes)) : _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(0x3f800000);
+    const __m128 three_halves = _mm_set1_ps(1.5f);
+    auto noise = [&]() {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+        return _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(state, 9), one)), three_halves);
+    };
+    auto convert = [&](__m128 value) {
+        value = _mm_mul_ps(value, scale);
+        if (dither) {
+            const auto first = noise();
+            value = _mm_add_ps(value, _mm_add_ps(first, noise()));
+        }
+        // Clamp before the conversion, out of range values would turn into INT32_MIN
+        return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(value, minimum), maximum));
+    };
+    for (; i + 8 <= count; i += 8) {
+        const __m128i low = convert(_mm_loadu_ps(in + i));
+        const __m128i high = convert(_mm_loadu_ps(in + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(low, high));
+    }
+    if (dither)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dither->lanes), state);
+#endif
+    float_to_int16_scalar(in + i, out + i, count - i, dither);
+}
+
+void int16_to_float(const short* in, float* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(SAMPLE_CONVERT_NEON)
+    const float32x4_t scale = vdupq_n_f32(1.0f / int16_scale);
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t value = vld1q_s16(in + i);
+        vst1q_f32(out + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(value))), scale));
+        vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(value))), scale));
+    }
+#elif defined(SAMPLE_CONVERT_SSE2)
+    const __m128 scale = _mm_set1_ps(1.0f / int16_scale);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // Sign extend by placing each sample in the upper half and shifting back down
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(value, value), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+#endif
+    int16_to_float_scalar(in + i, out + i, count - i);
+}
+
+void mono_to_stereo(const short* in, short* out, std::size_t frames) {
+    std::size_t i = 0;
+#if defined(SAMPLE_CONVERT_NEON)
+    for (; i + 8 <= frames; i += 8) {
+        const int16x8_t value = vld1q_s16(in + i);
+        int16x8x2_t pair;
+        pair.val[0] = value;
+        pair.val[1] = value;
+        vst2q_s16(out + 2 * i, pair);
+    }
+#elif defined(SAMPLE_CONVERT_SSE2)
+    for (; i + 8 <= frames; i += 8) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi16(value, value));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 8), _mm_unpackhi_epi16(value, value));
+    }
+#endif
+    for (; i < frames; ++i)
+        out[2 * i] = out[2 * i + 1] = in[i];
+}
+
+void stereo_to_mono(const short* in, short* out, std::size_t frames) {
+    std::size_t i = 0;
+#if defined(SAMPLE_CONVERT_NEON)
+    for (; i + 8 <= frames; i += 8) {
+        const int16x8x2_t pair = vld2q_s16(in + 2 * i);
+        vst1q_s16(out + i, vhaddq_s16(pair.val[0], pair.val[1]));
+    }
+#elif defined(SAMPLE_CONVERT_SSE2)
+    const __m128i ones = _mm_set1_epi16(1);
+    for (; i + 8 <= frames; i += 8) {
+        // madd sums each left/right pair into 32 bit, no overflow
+        const __m128i low = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i)), ones);
+        const __m128i high = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i + 8)), ones);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(_mm_srai_epi32(low, 1), _mm_srai_epi32(high, 1)));
+    }
+#endif
+    for (; i < frames; ++i)
+        out[i] = static_cast<short>((in[2 * i] + in[2 * i + 1]) >> 1);
+}
+
+static void convert_channels(const short* in, int in_channels, short* out, int out_channels, std::size_t frames) {
+    if (in_channels == out_channels)
+        std::memmove(out, in, frames * in_channels * sizeof(short));
+    else if (in_channels == 1)
+        mono_to_stereo(in, out, frames);
+    else
+        stereo_to_mono(in, out, frames);
+}
+
+void convert_to_int16(const void* in, int encoding, int in_channels, short* out, int out_channels, std::size_t frames,
+                      std::vector<short>& scratch, DitherState* dither) {
+    const short* samples = static_cast<const short*>(in);
+    if (encoding == SampleEncoding_Float) {
+        if (in_channels == out_channels) {
+            float_to_int16(static_cast<const float*>(in), out, frames * in_channels, dither);
+            return;
+        }
+        if (scratch.size() < frames * in_channels)
+            scratch.resize(frames * in_channels);
+        float_to_int16(static_cast<const float*>(in), scratch.data(), frames * in_channels, dither);
+        samples = scratch.data();
+    }
+    convert_channels(samples, in_channels, out, out_channels, frames);
+}
+
+void convert_from_int16(const short* in, int in_channels, void* out, int encoding, int out_channels, std::size_t frames,
+                        std::vector<short>& scratch) {
+    if (encoding != SampleEncoding_Float) {
+        convert_channels(in, in_channels, static_cast<short*>(out), out_channels, frames);
+        return;
+    }
+    if (in_channels != out_channels) {
+        if (scratch.size() < frames * out_channels)
+            scratch.resize(frames * out_channels);
+        convert_channels(in, in_channels, scratch.data(), out_channels, frames);
+        in = scratch.data();
+    }
+    int16_to_float(in, static_cast<float*>(out), frames * out_channels);
+}
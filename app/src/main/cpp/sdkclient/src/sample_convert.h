@@ -0,0 +1,54 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Sample format and channel layout conversion between the buffers Java registers for a custom device and
+ * the interleaved 16 bit PCM the clientlib works with. The kernels use NEON or SSE2 when the target has
+ * them and plain C++ otherwise.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Values of android.media.AudioFormat.ENCODING_PCM_16BIT / ENCODING_PCM_FLOAT */
+enum SampleEncoding {
+    SampleEncoding_Int16 = 2,
+    SampleEncoding_Float = 4
+};
+
+inline std::size_t bytes_per_sample(int encoding) {
+    return encoding == SampleEncoding_Float ? sizeof(float) : sizeof(short);
+}
+
+/* Triangular dither noise of +-1 LSB for float to int16 conversion */
+struct DitherState {
+    uint32_t lanes[4] = {0x9e3779b9u, 0x7f4a7c15u, 0x85ebca6bu, 0xc2b2ae35u};
+};
+
+/* Scales [-1, 1) to int16 with rounding half to even and clipping, on every path. dither may be nullptr. */
+void float_to_int16(const float* in, short* out, std::size_t count, DitherState* dither);
+void int16_to_float(const short* in, float* out, std::size_t count);
+
+/* Duplicates each sample into both channels */
+void mono_to_stereo(const short* in, short* out, std::size_t frames);
+/* Averages left and right */
+void stereo_to_mono(const short* in, short* out, std::size_t frames);
+
+/* Only mono and stereo layouts can be converted into each other */
+inline bool can_convert_channels(int from, int to) {
+    return from == to || ((from == 1 || from == 2) && (to == 1 || to == 2));
+}
+
+/*
+ * Converts frames from a Java buffer of the given encoding and channel count into int16 at out_channels.
+ * scratch is grown as needed, keep it per thread so the audio path does not allocate after warm-up.
+ */
+void convert_to_int16(const void* in, int encoding, int in_channels, short* out, int out_channels, std::size_t frames,
+                      std::vector<short>& scratch, DitherState* dither);
+
+/* The reverse of convert_to_int16 */
+void convert_from_int16(const short* in, int in_channels, void* out, int encoding, int out_channels, std::size_t frames,
+                        std::vector<short>& scratch);
@@ -0,0 +1,225 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "server_tree.h"
+
+#include <atomic>
+#include <cstring>
+
+/* Shared by all trees, so a tree created again for a connection never reuses a generation */
+static std::atomic<uint64_t> gGenerations{0};
+
+static uint64_t next_generation() {
+    return gGenerations.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+template <typename T>
+static void append(std::vector<uint8_t>& out, T value) {
+    const auto size = out.size();
+    out.resize(size + sizeof(T));
+    std::memcpy(out.data() + size, &value, sizeof(T));
+}
+
+static void append(std::vector<uint8_t>& out, const std::string& text) {
+    append(out, static_cast<uint32_t>(text.size()));
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+template <typename Entry, typename Id>
+static void erase(std::vector<Entry>& entries, std::unordered_map<Id, std::size_t>& index, Id id) {
+    const auto it = index.find(id);
+    if (it == index.end())
+        return;
+    const auto position = it->second;
+    index.erase(it);
+    if (position + 1 != entries.size()) {
+        entries[position] = std::move(entries.back());
+        index[entries[position].id] = position;
+    }
+    entries.pop_back();
+}
+
+ServerTree::ServerTree() : m_generation(next_generation()), m_delta_base(m_generation) {}
+
+ServerTree::Channel* ServerTree::channel(uint64_t id) {
+    const auto it = m_channel_index.find(id);
+    return it == m_channel_index.end() ? nullptr : &m_channels[it->second];
+}
+
+ServerTree::Client* ServerTree::client(uint16_t id) {
+    const auto it = m_client_index.find(id);
+    return it == m_client_index.end() ? nullptr : &m_clients[it->second];
+}
+
+void ServerTree::removed(uint64_t id, bool client) {
+    m_removals.push_back({m_generation, id, client});
+    if (m_removals.size() > max_removals) {
+        m_delta_base = m_removals.front().generation;
+        m_removals.pop_front();
+    }
+}
+
+void ServerTree::add_channel(uint64_t id, uint64_t parent, const char* name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_generation = next_generation();
+    if (auto* existing = channel(id)) {
+        existing->parent = parent;
+        existing->name = name ? name : "";
+        existing->generation = m_generation;
+        return;
+    }
+    m_channel_index.emplace(id, m_channels.size());
+    m_channels.push_back({id, parent, m_generation, name ? name : ""});
+}
+
+void ServerTree::move_channel(uint64_t id, uint64_t parent) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (auto* existing = channel(id)) {
+        existing->parent = parent;
+        existing->generation = m_generation = next_generation();
+    }
+}
+
+void ServerTree::rename_channel(uint64_t id, const char* name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto* existing = channel(id);
+    if (existing && existing->name != (name ? name : "")) {
+        existing->name = name ? name : "";
+        existing->generation = m_generation = next_generation();
+    }
+}
+
+void ServerTree::remove_channel(uint64_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!channel(id))
+        return;
+    m_generation = next_generation();
+    erase(m_channels, m_channel_index, id);
+    removed(id, false);
+}
+
+void ServerTree::move_client(uint16_t id, uint64_t channel, const char* nickname) {
+    if (channel == 0) {
+        remove_client(id);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_generation = next_generation();
+    if (auto* existing = client(id)) {
+        existing->channel = channel;
+        if (nickname)
+            existing->nickname = nickname;
+        existing->generation = m_generation;
+        return;
+    }
+    m_client_index.emplace(id, m_clients.size());
+    m_clients.push_back({id, channel, m_generation, nickname ? nickname : ""});
+}
+
+void ServerTree::rename_client(uint16_t id, const char* nickname) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto* existing = client(id);
+    if (existing && existing->nickname != (nickname ? nickname : "")) {
+        existing->nickname = nickname ? nickname : "";
+        existing->generation = m_generation = next_generation();
+    }
+}
+
+void ServerTree::remove_client(uint16_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!client(id))
+        return;
+    m_generation = next_generation();
+    erase(m_clients, m_client_index, id);
+    removed(id, true);
+}
+
+void ServerTree::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_generation = next_generation();
+    m_channels.clear();
+    m_channel_index.clear();
+    m_clients.clear();
+    m_client_index.clear();
+    m_removals.clear();
+    m_delta_base = m_generation;
+}
+
+uint64_t ServerTree::generation() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_generation;
+}
+
+void ServerTree::serialize(uint64_t since, std::vector<uint8_t>& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool full = since == 0 || since < m_delta_base || since > m_generation;
+    if (full)
+        since = 0;
+
+    uint32_t channels = 0, clients = 0, removed_channels = 0, removed_clients = 0;
+    for (const auto& entry : m_channels)
+        channels += entry.generation > since;
+    for (const auto& entry : m_clients)
+        clients += entry.generation > since;
+    if (!full) {
+        for (const auto& removal : m_removals) {
+            if (removal.generation > since)
+                ++(removal.client ? removed_clients : removed_channels);
+        }
+    }
+
+    out.clear();
+    append(out, static_cast<int64_t>(m_generation));
+    append(out, full ? flag_full : 0u);
+    append(out, channels);
+    append(out, clients);
+    append(out, removed_channels);
+    append(out, removed_clients);
+    for (const auto& entry : m_channels) {
+        if (entry.generation <= since)
+            continue;
+        append(out, static_cast<int64_t>(entry.id));
+        append(out, static_cast<int64_t>(entry.parent));
+        append(out, entry.name);
+    }
+    for (const auto& entry : m_clients) {
+        if (entry.generation <= since)
+            continue;
+        append(out, entry.id);
+        append(out, uint16_t{0});
+        append(out, static_cast<int64_t>(entry.channel));
+        append(out, entry.nickname);
+    }
+    if (full)
+        return;
+    for (const auto& removal : m_removals) {
+        if (removal.generation > since && !removal.client)
+            append(out, static_cast<int64_t>(removal.id));
+    }
+    for (const auto& removal : m_removals) {
+        if (removal.generation > since && removal.client)
+            append(out, static_cast<uint16_t>(removal.id));
+    }
+}
+
+std::shared_ptr<ServerTree> ServerTrees::get(uint64_t connection) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& tree = m_trees[connection];
+    if (!tree)
+        tree = std::make_shared<ServerTree>();
+    return tree;
+}
+
+std::shared_ptr<ServerTree> ServerTrees::find(uint64_t connection) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_trees.find(connection);
+    return it == m_trees.end() ? nullptr : it->second;
+}
+
+void ServerTrees::remove(uint64_t connection) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trees.erase(connection);
+}
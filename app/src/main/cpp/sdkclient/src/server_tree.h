@@ -0,0 +1,107 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Channel tree and client placement of each server connection, kept current by the clientlib callbacks.
+ * Every change takes a new generation, so Java can fetch everything once and afterwards only what changed
+ * since the generation it has, instead of requerying the clientlib after every event.
+ *
+ * Serialized layout, native byte order, not padded:
+ *   i64 generation        of the newest change included
+ *   u32 flags             bit 0: full snapshot, drop everything known before applying
+ *   u32 channel count, client count, removed channel count, removed client count
+ *   per channel:          i64 id, i64 parent id, u32 name length, UTF-8 name bytes
+ *   per client:           u16 id, u16 reserved, i64 channel id, u32 nickname length, UTF-8 nickname bytes
+ *   removed channels:     i64 id each
+ *   removed clients:      u16 id each
+ * Removals are applied before the channels and clients, an entry removed and added again is in both.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ServerTree {
+public:
+    static constexpr uint32_t flag_full = 1;
+    /* Removals remembered for deltas, older generations get a full snapshot */
+    static constexpr std::size_t max_removals = 4096;
+
+    ServerTree();
+
+    void add_channel(uint64_t id, uint64_t parent, const char* name);
+    void move_channel(uint64_t id, uint64_t parent);
+    /* Renames only count as a change if the name differs */
+    void rename_channel(uint64_t id, const char* name);
+    void remove_channel(uint64_t id);
+
+    /* channel 0 means the client left the view */
+    void move_client(uint16_t id, uint64_t channel, const char* nickname);
+    void rename_client(uint16_t id, const char* nickname);
+    void remove_client(uint16_t id);
+
+    /* Disconnected, everything is gone */
+    void clear();
+
+    uint64_t generation() const;
+
+    /* Writes the changes after generation since, or a full snapshot if since is 0 or too old */
+    void serialize(uint64_t since, std::vector<uint8_t>& out) const;
+
+private:
+    struct Channel {
+        uint64_t id;
+        uint64_t parent;
+        uint64_t generation;
+        std::string name;
+    };
+
+    struct Client {
+        uint16_t id;
+        uint64_t channel;
+        uint64_t generation;
+        std::string nickname;
+    };
+
+    struct Removal {
+        uint64_t generation;
+        uint64_t id;
+        bool client;
+    };
+
+    Channel* channel(uint64_t id);
+    Client* client(uint16_t id);
+    void removed(uint64_t id, bool client);
+
+    mutable std::mutex m_mutex;
+    uint64_t m_generation;
+    uint64_t m_delta_base;  // deltas since an older generation would miss removals
+
+    // Dense arrays, removal swaps the last entry into the gap
+    std::vector<Channel> m_channels;
+    std::unordered_map<uint64_t, std::size_t> m_channel_index;
+    std::vector<Client> m_clients;
+    std::unordered_map<uint16_t, std::size_t> m_client_index;
+    std::deque<Removal> m_removals;
+};
+
+/* The trees of all server connection handlers */
+class ServerTrees {
+public:
+    /* Creates the tree on first use */
+    std::shared_ptr<ServerTree> get(uint64_t connection);
+    /* nullptr if the connection has no tree */
+    std::shared_ptr<ServerTree> find(uint64_t connection) const;
+    void remove(uint64_t connection);
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<ServerTree>> m_trees;
+};
@@ -0,0 +1,108 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ */
+#include "string_intern.h"
+
+#include <cstring>
+
+StringIntern& event_strings() {
+    static StringIntern table;
+    return table;
+}
+
+/* Key bytes, the String object with at most two bytes per UTF-8 byte, and the table bookkeeping */
+std::size_t StringIntern::cost_of(std::size_t length) {
+    return 3 * length + 96;
+}
+
+jstring StringIntern::get(JNIEnv* env, const char* utf8) {
+    if (!utf8)
+        return nullptr;
+    const auto length = std::strlen(utf8);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto cost = cost_of(length);
+    if (length > max_length || cost > m_capacity) {
+        ++m_bypassed;
+        return env->NewStringUTF(utf8);
+    }
+    m_key.assign(utf8, length);
+    const auto it = m_index.find(m_key);
+    if (it != m_index.end()) {
+        auto& entry = m_entries[it->second];
+        entry.referenced = true;
+        ++m_hits;
+        return static_cast<jstring>(env->NewLocalRef(entry.string));
+    }
+
+    jstring string = env->NewStringUTF(utf8);
+    auto global = string ? static_cast<jstring>(env->NewGlobalRef(string)) : nullptr;
+    if (!global)
+        return string;
+    evict(env, m_capacity - cost);
+    const auto inserted = m_index.emplace(m_key, m_entries.size()).first;
+    m_entries.push_back({&inserted->first, global, cost, false});
+    m_bytes += cost;
+    ++m_misses;
+    return string;
+}
+
+void StringIntern::set_capacity(JNIEnv* env, std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = bytes;
+    evict(env, bytes);
+}
+
+void StringIntern::clear(JNIEnv* env) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& entry : m_entries)
+        env->DeleteGlobalRef(entry.string);
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+    m_hand = 0;
+}
+
+StringIntern::Counters StringIntern::counters() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Counters result;
+    result.hits = m_hits;
+    result.misses = m_misses;
+    result.bypassed = m_bypassed;
+    result.evictions = m_evictions;
+    result.entries = m_entries.size();
+    result.bytes = m_bytes;
+    return result;
+}
+
+/* CLOCK: a referenced entry gets its bit cleared and survives until the hand comes around again */
+void StringIntern::evict(JNIEnv* env, std::size_t bytes) {
+    while (m_bytes > bytes && !m_entries.empty()) {
+        if (m_hand >= m_entries.size())
+            m_hand = 0;
+        auto& entry = m_entries[m_hand];
+        if (entry.referenced) {
+            entry.referenced = false;
+            ++m_hand;
+            continue;
+        }
+        // The last entry moves into the slot and is looked at next
+        erase(env, m_hand);
+        ++m_evictions;
+    }
+}
+
+void StringIntern::erase(JNIEnv* env, std::size_t slot) {
+    const auto& entry = m_entries[slot];
+    env->DeleteGlobalRef(entry.string);
+    m_bytes -= entry.cost;
+    m_index.erase(m_index.find(*entry.key));
+    if (slot + 1 != m_entries.size()) {
+        m_entries[slot] = m_entries.back();
+        m_index.find(*m_entries[slot].key)->second = slot;
+    }
+    m_entries.pop_back();
+}
@@ -0,0 +1,77 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Bounded table of Java Strings for UTF-8 text that events carry again and again, such as invoker names,
+ * unique identifiers and return codes. A hit costs a hash lookup and a local reference instead of a UTF-8
+ * decode and an allocation. Entries are evicted with CLOCK once the estimated size exceeds the capacity.
+ */
+#pragma once
+
+#include <jni.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class StringIntern {
+public:
+    static constexpr std::size_t default_capacity = 256 * 1024;
+    /* Longer text, e.g. log messages, is rarely repeated and always gets a new String */
+    static constexpr std::size_t max_length = 128;
+
+    struct Counters {
+        uint64_t hits;
+        uint64_t misses;     // interned on this lookup
+        uint64_t bypassed;   // too long or interning disabled
+        uint64_t evictions;
+        uint64_t entries;
+        uint64_t bytes;      // estimated, native key plus Java String
+    };
+
+    StringIntern() = default;
+    StringIntern(const StringIntern&) = delete;
+    StringIntern& operator=(const StringIntern&) = delete;
+
+    /* A new local reference to the String for utf8, nullptr for nullptr */
+    jstring get(JNIEnv* env, const char* utf8);
+
+    /* Evicts down to bytes, 0 disables interning */
+    void set_capacity(JNIEnv* env, std::size_t bytes);
+    /* Releases all global references */
+    void clear(JNIEnv* env);
+
+    Counters counters() const;
+
+private:
+    struct Entry {
+        const std::string* key;  // owned by m_index
+        jstring string;          // global reference
+        std::size_t cost;
+        bool referenced;
+    };
+
+    static std::size_t cost_of(std::size_t length);
+    void evict(JNIEnv* env, std::size_t bytes);
+    void erase(JNIEnv* env, std::size_t slot);
+
+    mutable std::mutex m_mutex;
+    std::size_t m_capacity = default_capacity;
+    std::size_t m_bytes = 0;
+    std::size_t m_hand = 0;
+    std::vector<Entry> m_entries;
+    std::unordered_map<std::string, std::size_t> m_index;
+    std::string m_key;  // lookup scratch, keeps its allocation
+
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_bypassed = 0;
+    uint64_t m_evictions = 0;
+};
+
+/* The table the event strings of JniEvent go through */
+StringIntern& event_strings();
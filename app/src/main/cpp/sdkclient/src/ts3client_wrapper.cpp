@@ -1,64 +1,153 @@
 #include "ts3client_wrapper.h"
+#include "jni_event.h"
+#include "jni_string.h"
+#include "event_dispatch.h"
+#include "event_mask.h"
+#include "custom_device.h"
+#include "audio_pump.h"
+#include "sample_convert.h"
+#include "resampler.h"
+#include "profiler.h"
+#ifdef LOAD_GENERATOR
+#include "load_generator.h"
+#endif
+#include "server_tree.h"
+#include "connection_sampler.h"
+#include "string_intern.h"
+#include "native_log.h"
+#include "wrapper_log.h"
 #include "teamspeak/clientlib.h"
 #include "teamspeak/public_errors.h"
 
-#include <android/log.h>
+#include <pthread.h>
+#include <atomic>
 #include <cstdio>
+#include <cstring>
 #include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <utility>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
-#define LOGV(...) __android_log_print(ANDROID_LOG_VERBOSE, "TS3 LIB",__VA_ARGS__)
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG  , "TS3 LIB",__VA_ARGS__)
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO   , "TS3 LIB",__VA_ARGS__)
-#define LOGW(...) __android_log_print(ANDROID_LOG_WARN   , "TS3 LIB",__VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR  , "TS3 LIB",__VA_ARGS__)
 
 static JavaVM *gJavaVM;
-static std::pair<jobject, jmethodID> Android_Event_ConnectStatusChange;
-static std::pair<jobject, jmethodID> Android_Event_NewChannel;
-static std::pair<jobject, jmethodID> Android_Event_NewChannelCreated;
-static std::pair<jobject, jmethodID> Android_Event_DelChannel;
-static std::pair<jobject, jmethodID> Android_Event_ClientMove;
-static std::pair<jobject, jmethodID> Android_Event_ClientMoveSubscription;
-static std::pair<jobject, jmethodID> Android_Event_ClientMoveTimeout;
-static std::pair<jobject, jmethodID> Android_Event_ClientMoveMoved;
-static std::pair<jobject, jmethodID> Android_Event_TalkStatusChange;
-static std::pair<jobject, jmethodID> Android_Event_ServerError;
-static std::pair<jobject, jmethodID> Android_Event_UserLoggingMessage;
+
+#define NATIVE_CLASS "com/teamspeak/ts3sdkclient/ts3sdk/Native"
+#define EVENT_CLASS(name) "com/teamspeak/ts3sdkclient/ts3sdk/events/" name
+
+static JniEvent<decltype(ClientUIFunctions::onConnectStatusChangeEvent)> Android_Event_ConnectStatusChange{EventType_ConnectStatusChange, EVENT_CLASS("ConnectStatusChange")};
+static JniEvent<decltype(ClientUIFunctions::onNewChannelEvent)> Android_Event_NewChannel{EventType_NewChannel, EVENT_CLASS("NewChannel")};
+static JniEvent<decltype(ClientUIFunctions::onNewChannelCreatedEvent)> Android_Event_NewChannelCreated{EventType_NewChannelCreated, EVENT_CLASS("NewChannelCreated")};
+static JniEvent<decltype(ClientUIFunctions::onDelChannelEvent)> Android_Event_DelChannel{EventType_DelChannel, EVENT_CLASS("DelChannel")};
+static JniEvent<decltype(ClientUIFunctions::onClientMoveEvent)> Android_Event_ClientMove{EventType_ClientMove, EVENT_CLASS("ClientMove")};
+static JniEvent<decltype(ClientUIFunctions::onClientMoveSubscriptionEvent)> Android_Event_ClientMoveSubscription{EventType_ClientMoveSubscription, EVENT_CLASS("ClientMoveSubscription")};
+static JniEvent<decltype(ClientUIFunctions::onClientMoveTimeoutEvent)> Android_Event_ClientMoveTimeout{EventType_ClientMoveTimeout, EVENT_CLASS("ClientMoveTimeout")};
+static JniEvent<decltype(ClientUIFunctions::onClientMoveMovedEvent)> Android_Event_ClientMoveMoved{EventType_ClientMoveMoved, EVENT_CLASS("ClientMoveMoved")};
+static JniEvent<decltype(ClientUIFunctions::onTalkStatusChangeEvent)> Android_Event_TalkStatusChange{EventType_TalkStatusChange, EVENT_CLASS("TalkStatusChange")};
+static JniEvent<decltype(ClientUIFunctions::onServerErrorEvent)> Android_Event_ServerError{EventType_ServerError, EVENT_CLASS("ServerError")};
+static JniEvent<decltype(ClientUIFunctions::onUserLoggingMessageEvent)> Android_Event_UserLoggingMessage{EventType_UserLoggingMessage, EVENT_CLASS("UserLoggingMessage")};
+
+/* By EventType, for resolving the classes of the subscribed types ahead of the first event */
+static JniEventClass* const gEventClasses[EventType_Count] = {
+        &Android_Event_ConnectStatusChange,
+        &Android_Event_NewChannel,
+        &Android_Event_NewChannelCreated,
+        &Android_Event_DelChannel,
+        &Android_Event_ClientMove,
+        &Android_Event_ClientMoveSubscription,
+        &Android_Event_ClientMoveTimeout,
+        &Android_Event_ClientMoveMoved,
+        &Android_Event_TalkStatusChange,
+        &Android_Event_ServerError,
+        &Android_Event_UserLoggingMessage
+};
 
 //static std::pair<jobject, jmethodID> byte_buffer_limit_function;
 
-static jobject StringClass;
+/* CLOCK_MONOTONIC ns (System.nanoTime) of each StartupMark, 0 until reached, see ts3client_getStartupTimes */
+enum StartupMark {
+    StartupMark_OnLoad = 0,
+    StartupMark_OnLoadDone,
+    StartupMark_InitDone,
+    StartupMark_Connect,
+    StartupMark_Connected,
+    StartupMark_Count
+};
+static std::atomic<uint64_t> gStartupMarks[StartupMark_Count];
+
+static void markStartup(StartupMark mark) {
+    uint64_t unset = 0;
+    gStartupMarks[mark].compare_exchange_strong(unset, monotonic_ns(), std::memory_order_relaxed);
+}
 
-static std::unordered_map<std::string, std::pair<std::size_t, void*>> playByteBufferCache;
-static std::unordered_map<std::string, std::pair<std::size_t, void*>> capByteBufferCache;
+/* Decouples the clientlib threads from the Java listeners, see ts3client_configureEventQueue */
+static EventDispatch gEventDispatch;
+static std::atomic<std::size_t> gEventQueueCapacity{EventQueue::default_capacity};
+static EventMask gEventMask;
 
-bool connectVM(JNIEnv *&env) {
-    int status;
-    bool isAttached = false;
+static CustomDeviceTable gCustomDevices;
+static AudioPump gAudioPumps[CustomDeviceTable::max_devices];
+static JavaAudioStream gJavaStreams[CustomDeviceTable::max_devices];
+static AudioLatency gAudioLatency[CustomDeviceTable::max_devices];
+/* Serializes pump start and stop against each other and against unregistering the device */
+static std::mutex gAudioPumpMutex;
 
-    status = gJavaVM->GetEnv((void **) &env, JNI_VERSION_1_6);
-    if (status < 0) {
+/* Channel tree and client placement per connection, see ts3client_getServerTree */
+static ServerTrees gServerTrees;
 
-        JavaVMAttachArgs args = { JNI_VERSION_1_6, "sdkclient.src.teamspeak", NULL };
-        status = gJavaVM->AttachCurrentThread(&env, &args);
-        if (status < 0) {
-            LOGE("callback_handler: failed to attach "
-                         "current thread");
-            return isAttached;
-        }
-        isAttached = true;
+/* Clientlib log lines, see ts3client_drainLog */
+static NativeLog gNativeLog;
+
+/* Connection variable history, see ts3client_startConnectionSampler */
+static ConnectionSampler gConnectionSampler;
+static std::mutex gConnectionSamplerMutex;
+
+#ifdef LOAD_GENERATOR
+/* Synthetic callback load, see ts3client_startLoadGenerator */
+static LoadGenerator gLoadGenerator;
+static std::mutex gLoadGeneratorMutex;
+#endif
+
+/*
+ * Clientlib threads are attached to the VM on their first callback and stay attached until they exit,
+ * the pthread key destructor detaches them.
+ */
+static pthread_key_t gThreadDetachKey;
+static std::atomic<uint64_t> gThreadAttachCount{0};
+static std::atomic<uint64_t> gThreadDetachCount{0};
+
+static void detachThread(void* /*env*/) {
+    gJavaVM->DetachCurrentThread();
+    gThreadDetachCount.fetch_add(1, std::memory_order_relaxed);
+#ifdef DEBUG_BUILD
+    LOGD("Detached clientlib thread");
+#endif
+}
+
+/* Returns the JNIEnv of the calling thread, or nullptr if it could not be attached */
+JNIEnv* connectVM() {
+    JNIEnv *env = nullptr;
+    const auto status = gJavaVM->GetEnv((void **) &env, JNI_VERSION_1_6);
+    if (status == JNI_OK)
+        return env;
+    if (status != JNI_EDETACHED)
+        return nullptr;
+
+    JavaVMAttachArgs args = { JNI_VERSION_1_6, "sdkclient.src.teamspeak", NULL };
+    if (gJavaVM->AttachCurrentThread(&env, &args) < 0) {
+        LOGE("callback_handler: failed to attach "
+                     "current thread");
+        return nullptr;
     }
+    gThreadAttachCount.fetch_add(1, std::memory_order_relaxed);
+    if (pthread_setspecific(gThreadDetachKey, env) != 0)
+        LOGW("connectVM: thread will not be detached on exit");
 #ifdef DEBUG_BUILD
-    if(isAttached)
-		LOGD("isAttached true");
-	else
-		LOGD("isAttached false");
+    LOGD("Attached clientlib thread");
 #endif
-    return isAttached;
+    return env;
 }
 
 
@@ -66,7 +155,10 @@ bool connectVM(JNIEnv *&env) {
 // JNI Methods
 ///////////////////////////////////////////////////////////////////////////
 
-int init(const char*/*, const std::vector<std::string>& events_to_register*/);
+int init(const char*);
+#ifdef LOAD_GENERATOR
+static void raiseSyntheticEvent(EventType type, uint64_t connection, uint64_t sequence);
+#endif
 
 jstring get_native_library_dir(JNIEnv* env, jobject application_context)
 {
@@ -78,57 +170,66 @@ jstring get_native_library_dir(JNIEnv* env, jobject application_context)
     return (jstring)env->GetObjectField(app_info_object, native_lib_field_id);
 }
 
-/*namespace {
-    std::vector<std::string> parseEventRegister(JNIEnv *env, jobjectArray object_array)
-    {
-        decltype(parseEventRegister(nullptr, {})) result;
-        const auto object_array_size = env->GetArrayLength(object_array);
-
-        for (auto i = decltype(object_array_size){0}; i < object_array_size; ++i)
-        {
-            const auto j_string = (jstring) (env->GetObjectArrayElement(object_array, i));
-            const auto* raw_string = env->GetStringUTFChars(j_string, 0);
-            result.emplace_back(raw_string);
-            // Don't forget to call `ReleaseStringUTFChars` when you're done.
-            env->ReleaseStringUTFChars(j_string, raw_string);
-        }
-        return result;
-    }
-}*/
-
-JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startInit(JNIEnv *env, jobject /*obj*/, jobject application_context/*, jobjectArray events*/) {
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startInit(JNIEnv *env, jobject /*obj*/, jobject application_context) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
 
     ts3client_android_initJni(gJavaVM, application_context);
 
-    //const auto events_to_register = parseEventRegister(env, events);
-
     jstring nativeLibPath = get_native_library_dir(env, application_context);
-    const auto* native_lib_path = env->GetStringUTFChars(nativeLibPath, 0);
-    LOGV("Sound backend path: %s\n", native_lib_path);
-    int err = init(native_lib_path/*, events_to_register*/);
-    env->ReleaseStringUTFChars(nativeLibPath, native_lib_path);
+    const JniUtf8 native_lib_path(env, nativeLibPath);
+    env->DeleteLocalRef(nativeLibPath);
+    if (!native_lib_path)
+        return ERROR_parameter_invalid;
+    LOGV("Sound backend path: %s\n", native_lib_path.c_str());
+    if (!gEventDispatch.start(gEventQueueCapacity.load(), connectVM))
+        LOGE("Failed to start the event dispatcher, delivering events on the clientlib threads");
+    int err = init(native_lib_path.c_str());
+    if (err != ERROR_ok)
+        gEventDispatch.stop();
+    else
+        markStartup(StartupMark_InitDone);
     LOGD("init() returned: %u", err);
     return err;
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1destroyClientLib(JNIEnv *env, jobject obj) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
     unsigned int error;
 
+    {
+        std::lock_guard<std::mutex> lock(gAudioPumpMutex);
+        for (auto& pump : gAudioPumps)
+            pump.stop();
+    }
+#ifdef LOAD_GENERATOR
+    {
+        std::lock_guard<std::mutex> lock(gLoadGeneratorMutex);
+        gLoadGenerator.stop();
+    }
+#endif
+    {
+        std::lock_guard<std::mutex> lock(gConnectionSamplerMutex);
+        gConnectionSampler.stop();
+    }
     if ((error = ts3client_destroyClientLib()) != ERROR_ok) {
         LOGE("Failed to destroy clientlib: %d\n", error);
         return 1;
     }
+    gEventDispatch.stop();
+    event_strings().clear(env);
+    gNativeLog.close_file();
     LOGD("Clientlib Closed");
     return 0;
 }
 
 JNIEXPORT jlong JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1spawnNewServerConnectionHandler(JNIEnv * env, jobject obj) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -150,6 +251,7 @@ JNIEXPORT jlong JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1destroyServerConnectionHandler(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -158,33 +260,30 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
         LOGE("Error destroying ServerConnectionHandler: %d\n", error);
         return 1;
     }
+    gEventMask.reset((uint64)serverConnectionHandlerID);
+    gServerTrees.remove((uint64)serverConnectionHandlerID);
+    gConnectionSampler.unwatch((uint64)serverConnectionHandlerID);
     return 0;
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startConnection(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jstring identity, jstring ip, jint port, jstring nickname, jobjectArray channel, jstring defaultChannelPassword, jstring serverPassword) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
+    markStartup(StartupMark_Connect);
     unsigned int error;
 
-    int counter = env->GetArrayLength(channel);
-    const char *dchannel[counter + 1];
-    for (int i = 0; i < counter; i++) {
-        jstring string = (jstring) env->GetObjectArrayElement(channel, i);
-        const char *rawString = env->GetStringUTFChars(string, 0);
-        dchannel[i] = rawString;
-    }
-    dchannel[counter] = "";
-
-    const char* _identity = env->GetStringUTFChars(identity, 0);
-    const char* _ip = env->GetStringUTFChars(ip, 0);
-    const char* _nickname = env->GetStringUTFChars(nickname, 0);
-    const char* _serverPassword = env->GetStringUTFChars(serverPassword, 0);
-    const char* _defaultChannelPassword = env->GetStringUTFChars(defaultChannelPassword, 0);
+    JniUtf8Array dchannel(env, channel);
+    const JniUtf8 _identity(env, identity);
+    const JniUtf8 _ip(env, ip);
+    const JniUtf8 _nickname(env, nickname);
+    const JniUtf8 _serverPassword(env, serverPassword);
+    const JniUtf8 _defaultChannelPassword(env, defaultChannelPassword);
 
-    if ((error = ts3client_startConnection((uint64)serverConnectionHandlerID, _identity,
-                                          _ip, (u_int)port, _nickname, dchannel, _defaultChannelPassword,
-                                          _serverPassword)) != ERROR_ok) {
+    if ((error = ts3client_startConnection((uint64)serverConnectionHandlerID, _identity.c_str(),
+                                          _ip.c_str(), (u_int)port, _nickname.c_str(), dchannel.data(), _defaultChannelPassword.c_str(),
+                                          _serverPassword.c_str())) != ERROR_ok) {
         char* errormsg;
         if(ts3client_getErrorMessage(error, &errormsg) == ERROR_ok) {
             LOGE("Failed ts3client_startConnection: %s\n", errormsg);
@@ -192,36 +291,26 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
         }
         return error;
     }
-
-    env->ReleaseStringUTFChars(identity, _identity);
-    env->ReleaseStringUTFChars(ip, _ip);
-    env->ReleaseStringUTFChars(nickname, _nickname);
-    env->ReleaseStringUTFChars(serverPassword, _serverPassword);
-    env->ReleaseStringUTFChars(defaultChannelPassword, _defaultChannelPassword);
-
-    for (int i = 0; i < counter; i++) {
-        env->ReleaseStringUTFChars(
-                (jstring) env->GetObjectArrayElement(channel, i), dchannel[i]);
-    }
     return 0;
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1stopConnection(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jstring msg) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
     unsigned int error;
-    const char* _msg = env->GetStringUTFChars(msg, 0);
-    if ((error = ts3client_stopConnection((uint64)serverConnectionHandlerID, _msg))
+    const JniUtf8 _msg(env, msg);
+    if ((error = ts3client_stopConnection((uint64)serverConnectionHandlerID, _msg.c_str()))
         != ERROR_ok) {
         LOGE("Error stopping connection: %d\n", error);
         return 1;
     }
-    env->ReleaseStringUTFChars(msg, _msg);
     return 0;
 }
 
 JNIEXPORT jstring JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1createIdentity(JNIEnv * env, jobject obj) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -241,6 +330,7 @@ JNIEXPORT jstring JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3clien
 }
 
 JNIEXPORT jstring JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getClientLibVersion(JNIEnv * env, jobject obj) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -259,9 +349,9 @@ JNIEXPORT jstring JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3clien
     return ret;
 }
 
-JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1registerCustomDevice(
+/* Registers the device with the clientlib and the device table. Returns the device handle or -error. */
+static jint registerCustomDevice(
         JNIEnv * env,
-        jobject obj,
         jstring deviceID,
         jstring deviceDisplayName,
         jint capFrequency,
@@ -271,19 +361,41 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
         jint playChannels,
         jobject play_byte_buffer)
 {
-#ifdef DEBUG_BUILD
-    LOGD(__FUNCTION__);
-#endif
+    CustomDevice device = {};
+    const JniUtf8 id(env, deviceID);
+    if (!id || id.size() > CustomDevice::max_id_length) {
+        LOGE("Custom sound device ID missing or too long\n");
+        return -static_cast<jint>(ERROR_parameter_invalid);
+    }
+    std::memcpy(device.id, id.c_str(), id.size() + 1);
+    device.capture_frequency = capFrequency;
+    device.capture_channels = capChannels;
+    device.playback_frequency = playFrequency;
+    device.playback_channels = playChannels;
+    device.capture_buffer_encoding = SampleEncoding_Int16;
+    device.capture_buffer_channels = capChannels;
+    device.playback_buffer_encoding = SampleEncoding_Int16;
+    device.playback_buffer_channels = playChannels;
+    device.capture_buffer_frequency = capFrequency;
+    device.playback_buffer_frequency = playFrequency;
+    device.resampler_quality = ResamplerQuality_Medium;
+    if (cap_byte_buffer) {
+        device.capture_buffer = env->GetDirectBufferAddress(cap_byte_buffer);
+        device.capture_buffer_size = static_cast<std::size_t>(env->GetDirectBufferCapacity(cap_byte_buffer));
+    }
+    if (play_byte_buffer) {
+        device.playback_buffer = env->GetDirectBufferAddress(play_byte_buffer);
+        device.playback_buffer_size = static_cast<std::size_t>(env->GetDirectBufferCapacity(play_byte_buffer));
+    }
 
-    const char* _deviceID = env->GetStringUTFChars(deviceID, 0);
-    const char* _deviceDisplayName = env->GetStringUTFChars(deviceDisplayName, 0);
+    const JniUtf8 _deviceDisplayName(env, deviceDisplayName);
 
     unsigned int error;
     //
     // Register our custom sound device
     //
-    if ((error = ts3client_registerCustomDevice(_deviceID,
-                                                _deviceDisplayName,
+    if ((error = ts3client_registerCustomDevice(device.id,
+                                                _deviceDisplayName.c_str(),
                                                 capFrequency,
                                                 capChannels,
                                                 playFrequency,
@@ -296,52 +408,78 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
             LOGE("Error registering custom sound device.\n");
         }
     }
+    if (error != ERROR_ok)
+        return -static_cast<jint>(error);
 
-    /*const auto cls = env->GetObjectClass(byte_buffer);
-    const auto method_id = env->GetMethodID(cls, "limit", "(I)Ljava/nio/Buffer;");
-    byte_buffer_limit_function = std::make_pair(env->NewGlobalRef(byte_buffer), method_id);*/
-
-    if (error == ERROR_ok)
-    {
-        /*playbackFrequency = playFrequency;
-        playbackChannelCount = playChannels;*/
-        if (play_byte_buffer) {
-            playByteBufferCache.emplace(
-                    _deviceID,
-                    std::make_pair<std::size_t, void*>(
-                            static_cast<size_t>(env->GetDirectBufferCapacity(play_byte_buffer)),
-                            env->GetDirectBufferAddress(play_byte_buffer))
-            );
-        }
-        if (cap_byte_buffer) {
-            capByteBufferCache.emplace(
-                    _deviceID,
-                    std::make_pair<std::size_t, void*>(
-                            static_cast<size_t>(env->GetDirectBufferCapacity(cap_byte_buffer)),
-                            env->GetDirectBufferAddress(cap_byte_buffer))
-            );
-        }
+    const auto handle = gCustomDevices.add(device);
+    if (handle < 0) {
+        LOGE("Too many custom sound devices\n");
+        ts3client_unregisterCustomDevice(device.id);
+        return -static_cast<jint>(ERROR_undefined);
     }
+    gAudioLatency[handle].reset();
+    return handle;
+}
 
-    env->ReleaseStringUTFChars(deviceID, _deviceID);
-    env->ReleaseStringUTFChars(deviceDisplayName, _deviceDisplayName);
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1registerCustomDevice(
+        JNIEnv * env,
+        jobject obj,
+        jstring deviceID,
+        jstring deviceDisplayName,
+        jint capFrequency,
+        jint capChannels,
+        jobject cap_byte_buffer,
+        jint playFrequency,
+        jint playChannels,
+        jobject play_byte_buffer)
+{
+    PROFILE_SCOPE();
+#ifdef DEBUG_BUILD
+    LOGD(__FUNCTION__);
+#endif
+    const auto handle = registerCustomDevice(env, deviceID, deviceDisplayName, capFrequency, capChannels, cap_byte_buffer, playFrequency, playChannels, play_byte_buffer);
+    return handle < 0 ? -handle : ERROR_ok;
+}
 
-    return error;
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1registerCustomDeviceHandle(
+        JNIEnv * env,
+        jobject obj,
+        jstring deviceID,
+        jstring deviceDisplayName,
+        jint capFrequency,
+        jint capChannels,
+        jobject cap_byte_buffer,
+        jint playFrequency,
+        jint playChannels,
+        jobject play_byte_buffer)
+{
+    PROFILE_SCOPE();
+#ifdef DEBUG_BUILD
+    LOGD(__FUNCTION__);
+#endif
+    return registerCustomDevice(env, deviceID, deviceDisplayName, capFrequency, capChannels, cap_byte_buffer, playFrequency, playChannels, play_byte_buffer);
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1unregisterCustomDevice(JNIEnv * env, jobject obj, jstring deviceID) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
 
-    const char* _deviceID = env->GetStringUTFChars(deviceID, 0);
+    const JniUtf8 _deviceID(env, deviceID);
+    if (!_deviceID)
+        return ERROR_parameter_invalid;
+    std::lock_guard<std::mutex> lock(gAudioPumpMutex);
+    const auto handle = gCustomDevices.find(_deviceID.c_str());
+    if (handle >= 0)
+        gAudioPumps[handle].stop();
 
     unsigned int error;
     LOGD("Unregistering custom sound device\n");
     //
     // Unregister our custom sound device
     //
-    if ((error = ts3client_unregisterCustomDevice(_deviceID)) != ERROR_ok) {
+    if ((error = ts3client_unregisterCustomDevice(_deviceID.c_str())) != ERROR_ok) {
         char* errormsg;
         if (ts3client_getErrorMessage(error, &errormsg) == ERROR_ok) {
             LOGE("Error unregistering custom sound device: %s\n", errormsg);
@@ -351,58 +489,144 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
         }
     }
 
-    {
-        auto it = playByteBufferCache.find(_deviceID);
-        if (it != playByteBufferCache.end())
-            playByteBufferCache.erase(it);
+    gCustomDevices.remove(handle);
+    return error;
+}
+
+/* Per audio thread conversion buffers, grown on first use */
+static thread_local std::vector<short> tDeviceSamples;  // clientlib channel count, Java buffer rate
+static thread_local std::vector<short> tClientSamples;  // clientlib channel count and rate
+static thread_local std::vector<short> tConvertScratch;
+static thread_local DitherState tDither;
+
+/* Rate conversion state per device and direction, each direction is driven by one audio thread at a time */
+static PolyphaseResampler gCaptureResamplers[CustomDeviceTable::max_devices];
+static PolyphaseResampler gPlaybackResamplers[CustomDeviceTable::max_devices];
+
+static short* scratchSamples(std::vector<short>& buffer, std::size_t samples)
+{
+    if (buffer.size() < samples)
+        buffer.resize(samples);
+    return buffer.data();
+}
+
+/* Reconfigures on the audio thread after the buffer rate was changed, so no other thread touches the state */
+static PolyphaseResampler* deviceResampler(PolyphaseResampler& resampler, int in_rate, int out_rate, int channels, int quality)
+{
+    if (resampler.is_configured(in_rate, out_rate, channels, quality) || resampler.configure(in_rate, out_rate, channels, quality))
+        return &resampler;
+    return nullptr;
+}
+
+/*
+ * The capture buffer in the clientlib format, converted and resampled if Java registered another layout
+ * or rate. frames is the number of buffer frames, on return the number of clientlib frames.
+ */
+static const short* captureSamples(jint handle, const CustomDevice& device, std::size_t& frames)
+{
+    const short* samples = static_cast<const short*>(device.capture_buffer);
+    if (device.converts_capture()) {
+        short* converted = scratchSamples(tDeviceSamples, frames * device.capture_channels);
+        convert_to_int16(device.capture_buffer, device.capture_buffer_encoding, device.capture_buffer_channels,
+                         converted, device.capture_channels, frames, tConvertScratch, &tDither);
+        samples = converted;
     }
-    {
-        auto it = capByteBufferCache.find(_deviceID);
-        if (it != capByteBufferCache.end())
-            capByteBufferCache.erase(it);
+    if (device.resamples_capture()) {
+        auto* resampler = deviceResampler(gCaptureResamplers[handle], device.capture_buffer_frequency, device.capture_frequency,
+                                          device.capture_channels, device.resampler_quality);
+        if (!resampler) {
+            frames = 0;
+            return samples;
+        }
+        const auto capacity = resampler->max_output_frames(frames);
+        short* resampled = scratchSamples(tClientSamples, capacity * device.capture_channels);
+        frames = resampler->process(samples, frames, resampled, capacity);
+        samples = resampled;
     }
+    return samples;
+}
 
-    env->ReleaseStringUTFChars(deviceID, _deviceID);
-    /*env->DeleteGlobalRef(byte_buffer_limit_function.first);
-    byte_buffer_limit_function.second = 0;*/
-    return error;
+/*
+ * Fills frames frames of the playback buffer. fetch(short* samples, std::size_t count) provides count frames
+ * in the clientlib format, those are resampled and converted to the layout Java registered.
+ */
+template <typename Fetch>
+static auto fillPlaybackSamples(jint handle, const CustomDevice& device, std::size_t frames, Fetch&& fetch)
+{
+    short* samples = device.converts_playback() ? scratchSamples(tDeviceSamples, frames * device.playback_channels)
+                                                : static_cast<short*>(device.playback_buffer);
+    PolyphaseResampler* resampler = nullptr;
+    std::size_t client_frames = frames;
+    short* client_samples = samples;
+    if (device.resamples_playback()) {
+        resampler = deviceResampler(gPlaybackResamplers[handle], device.playback_frequency, device.playback_buffer_frequency,
+                                    device.playback_channels, device.resampler_quality);
+        if (resampler) {
+            client_frames = resampler->input_frames_needed(frames);
+            client_samples = scratchSamples(tClientSamples, client_frames * device.playback_channels);
+        }
+    }
+
+    const auto result = fetch(client_samples, client_frames);
+    if (resampler)
+        resampler->process(client_samples, client_frames, samples, frames);
+    if (device.converts_playback())
+        convert_from_int16(samples, device.playback_channels, device.playback_buffer, device.playback_buffer_encoding,
+                           device.playback_buffer_channels, frames, tConvertScratch);
+    return result;
 }
 
-JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1acquireCustomPlaybackData(JNIEnv * env, jobject obj, jstring deviceID, jint samples)
+/*
+ * Per-frame entry points. They take no JNIEnv and only primitives so they can be registered as
+ * @CriticalNative, the Java_ functions below forward to them for regular JNI linkage.
+ */
+static jint acquireCustomPlaybackData(jint handle, jint samples)
 {
-    const auto* _deviceID = env->GetStringUTFChars(deviceID, 0);
-    auto it = playByteBufferCache.find(_deviceID);
-    if (it == playByteBufferCache.end())
+    CustomDeviceTable::Reader devices(gCustomDevices);
+    const auto* device = devices.get(handle);
+    if (!device || !device->playback_buffer)
         return ERROR_parameter_invalid;
-
-    auto* byte_buffer = (*it).second.second;
-    const auto& byte_buffer_size = (*it).second.first;
-    if (samples * sizeof(short) > byte_buffer_size)
+    if (!device->playback_buffer_fits(samples))
         return ERROR_parameter_invalid_count;
 
-    const auto error = ts3client_acquireCustomPlaybackData(_deviceID, static_cast<short*>(byte_buffer), samples);
-
-    env->ReleaseStringUTFChars(deviceID, _deviceID);
-
+    auto& latency = gAudioLatency[handle];
+    const auto start = monotonic_ns();
+    latency.record_interval(AudioLatency::PlaybackInterval, latency.last_playback_call, start);
+    const auto error = fillPlaybackSamples(handle, *device, samples, [device, &latency](short* data, std::size_t frames) {
+        const auto clientlib_start = monotonic_ns();
+        const auto error = ts3client_acquireCustomPlaybackData(device->id, data, static_cast<int>(frames));
+        latency.histograms[AudioLatency::PlaybackClientlib].record(monotonic_ns() - clientlib_start);
+        // Keep the resampler timeline continuous when the clientlib has nothing to play
+        if (error != ERROR_ok)
+            std::memset(data, 0, frames * device->playback_channels * sizeof(short));
+        return error;
+    });
+    latency.histograms[AudioLatency::PlaybackCall].record(monotonic_ns() - start);
     return error;
 }
 
-JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1processCustomCaptureData(JNIEnv* env, jobject obj, jstring deviceID, jint samples)
+static jint processCustomCaptureData(jint handle, jint samples)
 {
 #ifdef DEBUG_BUILD_AUDIO
     LOGD(__FUNCTION__);
 #endif
-    const auto* _deviceID = env->GetStringUTFChars(deviceID, 0);
-    auto it = capByteBufferCache.find(_deviceID);
-    if (it == capByteBufferCache.end())
+    CustomDeviceTable::Reader devices(gCustomDevices);
+    const auto* device = devices.get(handle);
+    if (!device || !device->capture_buffer)
         return ERROR_parameter_invalid;
-
-    auto* byte_buffer = (*it).second.second;
-    const auto& byte_buffer_size = (*it).second.first;
-    if (samples * sizeof(short) > byte_buffer_size)
+    if (!device->capture_buffer_fits(samples))
         return ERROR_parameter_invalid_count;
 
-    const auto error = ts3client_processCustomCaptureData(_deviceID, static_cast<short*>(byte_buffer), samples);
+    auto& latency = gAudioLatency[handle];
+    const auto start = monotonic_ns();
+    latency.record_interval(AudioLatency::CaptureInterval, latency.last_capture_call, start);
+    std::size_t frames = samples;
+    const short* data = captureSamples(handle, *device, frames);
+    const auto clientlib_start = monotonic_ns();
+    const auto error = ts3client_processCustomCaptureData(device->id, data, static_cast<int>(frames));
+    const auto end = monotonic_ns();
+    latency.histograms[AudioLatency::CaptureClientlib].record(end - clientlib_start);
+    latency.histograms[AudioLatency::CaptureCall].record(end - start);
     if (error != ERROR_ok)
     {
         char* errormsg;
@@ -412,23 +636,53 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
             ts3client_freeMemory(errormsg);
         }
     }
+    return error;
+}
 
-    env->ReleaseStringUTFChars(deviceID, _deviceID);
+static jint findCustomDevice(JNIEnv* env, jstring deviceID)
+{
+    const JniUtf8 id(env, deviceID);
+    if (!id || id.size() > CustomDevice::max_id_length)
+        return -1;
+    return gCustomDevices.find(id.c_str());
+}
 
-    return error;
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1acquireCustomPlaybackData(JNIEnv * env, jobject obj, jstring deviceID, jint samples)
+{
+    PROFILE_SCOPE();
+    return acquireCustomPlaybackData(findCustomDevice(env, deviceID), samples);
+}
+
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1processCustomCaptureData(JNIEnv* env, jobject obj, jstring deviceID, jint samples)
+{
+    PROFILE_SCOPE();
+    return processCustomCaptureData(findCustomDevice(env, deviceID), samples);
+}
+
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1acquireCustomPlaybackDataByHandle(JNIEnv*, jclass, jint deviceHandle, jint samples)
+{
+    PROFILE_SCOPE();
+    return acquireCustomPlaybackData(deviceHandle, samples);
+}
+
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1processCustomCaptureDataByHandle(JNIEnv*, jclass, jint deviceHandle, jint samples)
+{
+    PROFILE_SCOPE();
+    return processCustomCaptureData(deviceHandle, samples);
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1openCaptureDevice(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jstring modeID, jstring captureDevice)
 {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
-    const char* _modeID = env->GetStringUTFChars(modeID, 0);
-    const char* _captureDevice = env->GetStringUTFChars(captureDevice, 0);
+    const JniUtf8 _modeID(env, modeID);
+    const JniUtf8 _captureDevice(env, captureDevice);
 
     unsigned int error;
 
-    if ((error = ts3client_openCaptureDevice((uint64)serverConnectionHandlerID, _modeID, _captureDevice)) != ERROR_ok)
+    if ((error = ts3client_openCaptureDevice((uint64)serverConnectionHandlerID, _modeID.c_str(), _captureDevice.c_str())) != ERROR_ok)
     {
         char* errormsg;
         if (ts3client_getErrorMessage(error, &errormsg) == ERROR_ok)
@@ -439,8 +693,6 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
         else
             LOGE("Error opening capture device.\n");
     }
-    env->ReleaseStringUTFChars(modeID, _modeID);
-    env->ReleaseStringUTFChars(captureDevice, _captureDevice);
 
     // TODO return proper error (esp. on failure)
     return 0;
@@ -448,14 +700,15 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1openPlaybackDevice(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jstring modeID, jstring captureDevice)
 {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
-    const char* _modeID = env->GetStringUTFChars(modeID, 0);
-    const char* _captureDevice = env->GetStringUTFChars(captureDevice, 0);
+    const JniUtf8 _modeID(env, modeID);
+    const JniUtf8 _captureDevice(env, captureDevice);
     unsigned int error;
 
-    if ((error = ts3client_openPlaybackDevice((uint64)serverConnectionHandlerID, _modeID, _captureDevice)) != ERROR_ok)
+    if ((error = ts3client_openPlaybackDevice((uint64)serverConnectionHandlerID, _modeID.c_str(), _captureDevice.c_str())) != ERROR_ok)
     {
         char* errormsg;
         if (ts3client_getErrorMessage(error, &errormsg) == ERROR_ok)
@@ -467,15 +720,13 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
             LOGE("Error opening playback device.\n");
     }
 
-    env->ReleaseStringUTFChars(modeID, _modeID);
-    env->ReleaseStringUTFChars(captureDevice, _captureDevice);
-
     // TODO return proper error (esp. on failure)
     return 0;
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1closeCaptureDevice(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID)
 {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -499,6 +750,7 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1closePlaybackDevice(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID)
 {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -523,6 +775,7 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1activateCaptureDevice(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID)
 {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -545,6 +798,7 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setClientSelfVariableAsInt(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jint flag, jint value) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -559,90 +813,89 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1flushClientSelfUpdates(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jstring returnCode) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
     unsigned int error;
-    const char* _returnCode = env->GetStringUTFChars(returnCode, 0);
+    const JniUtf8 _returnCode(env, returnCode);
     error = ts3client_flushClientSelfUpdates(serverConnectionHandlerID,
-                                             _returnCode);
+                                             _returnCode.c_str());
     if (error != ERROR_ok && error != ERROR_ok_no_update) {
         LOGE("Error flushing client updates %d\n", error);
         return 1;
     }
-    env->ReleaseStringUTFChars(returnCode, _returnCode);
     return 0;
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setPreProcessorConfigValue(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jstring ident, jstring value) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
     unsigned int error;
 
-    const char* _ident = env->GetStringUTFChars(ident, 0);
-    const char* _value = env->GetStringUTFChars(value, 0);
+    const JniUtf8 _ident(env, ident);
+    const JniUtf8 _value(env, value);
 
-    if (((error = ts3client_setPreProcessorConfigValue((uint64)serverConnectionHandlerID, _ident, _value)) != ERROR_ok)) {
+    if (((error = ts3client_setPreProcessorConfigValue((uint64)serverConnectionHandlerID, _ident.c_str(), _value.c_str())) != ERROR_ok)) {
         LOGE("Failed ts3client_setPreProcessorConfigValue: %d\n", error);
     }
-    env->ReleaseStringUTFChars(ident, _ident);
-    env->ReleaseStringUTFChars(value, _value);
     return error;
 }
 
 JNIEXPORT jstring JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getPreProcessorConfigValue(JNIEnv * env, jobject obj, jlong serverConnectionHandlerID, jstring ident) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
     unsigned int error;
     jstring ret = 0;
-    const char* _ident = env->GetStringUTFChars(ident, 0);
+    const JniUtf8 _ident(env, ident);
     char *result;
-    if (((error = ts3client_getPreProcessorConfigValue((uint64)serverConnectionHandlerID, _ident, &result)) != ERROR_ok)) {
-        LOGE("Failed ts3client_setPreProcessorConfigValue: %d\n", error);
+    if (((error = ts3client_getPreProcessorConfigValue((uint64)serverConnectionHandlerID, _ident.c_str(), &result)) != ERROR_ok)) {
+        LOGE("Failed ts3client_getPreProcessorConfigValue: %d\n", error);
+        return ret;
     }
-    env->ReleaseStringUTFChars(ident, _ident);
     ret = env->NewStringUTF(result);
     ts3client_freeMemory(result); /* Release string */
     return ret;
 }
 
 JNIEXPORT jfloat JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getPlaybackConfigValueAsFloat(JNIEnv * env, jobject obj, jlong serverConnectionHandlerID, jstring ident) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
     unsigned int error;
     float value;
-    const char* _ident = env->GetStringUTFChars(ident, 0);
-    if ((error = ts3client_getPlaybackConfigValueAsFloat((uint64)serverConnectionHandlerID, _ident, &value)) != ERROR_ok) {
+    const JniUtf8 _ident(env, ident);
+    if ((error = ts3client_getPlaybackConfigValueAsFloat((uint64)serverConnectionHandlerID, _ident.c_str(), &value)) != ERROR_ok) {
         LOGE("Failed ts3client_getPlaybackConfigValueAsFloat: %d\n", error);
         return 0;
     }
-    env->ReleaseStringUTFChars(ident, _ident);
     return value;
 
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setPlaybackConfigValue(JNIEnv * env, jobject obj, jlong serverConnectionHandlerID, jstring ident, jstring value) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
     unsigned int error;
-    const char* _ident = env->GetStringUTFChars(ident, 0);
-    const char* _value = env->GetStringUTFChars(value, 0);
+    const JniUtf8 _ident(env, ident);
+    const JniUtf8 _value(env, value);
 
     if ((error = ts3client_setPlaybackConfigValue((uint64)serverConnectionHandlerID,
-                                                  _ident, _value)) != ERROR_ok) {
+                                                  _ident.c_str(), _value.c_str())) != ERROR_ok) {
         LOGE("Failed ts3client_setPlaybackConfigValue: %d\n", error);
     }
-
-    env->ReleaseStringUTFChars(ident, _ident);
-    env->ReleaseStringUTFChars(value, _value);
     return error;
 }
 
 JNIEXPORT jstring JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getClientVariableAsString(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jint clientID, jint flag) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -663,7 +916,146 @@ JNIEXPORT jstring JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3clien
     return ret;
 }
 
+/*
+ * The given client IDs, or all visible clients of the connection if clientIDs is null.
+ * ERROR_parameter_invalid if an ID does not fit an anyID.
+ */
+static unsigned int batchClientIds(JNIEnv* env, uint64 serverConnectionHandlerID, jintArray clientIDs, std::vector<anyID>& ids) {
+    ids.clear();
+    if (clientIDs) {
+        const auto count = env->GetArrayLength(clientIDs);
+        std::vector<jint> values(static_cast<std::size_t>(count));
+        env->GetIntArrayRegion(clientIDs, 0, count, values.data());
+        for (const auto value : values) {
+            if (value < 0 || value > std::numeric_limits<anyID>::max())
+                return ERROR_parameter_invalid;
+            ids.push_back(static_cast<anyID>(value));
+        }
+        return ERROR_ok;
+    }
+    anyID* list;
+    const auto error = ts3client_getClientList(serverConnectionHandlerID, &list);
+    if (error != ERROR_ok)
+        return error;
+    for (const anyID* id = list; *id != 0; ++id)
+        ids.push_back(*id);
+    ts3client_freeMemory(list);
+    return ERROR_ok;
+}
+
+static bool readFlags(JNIEnv* env, jintArray flags, std::vector<jint>& values) {
+    if (!flags)
+        return false;
+    values.resize(static_cast<std::size_t>(env->GetArrayLength(flags)));
+    env->GetIntArrayRegion(flags, 0, static_cast<jsize>(values.size()), values.data());
+    return !values.empty();
+}
+
+JNIEXPORT jintArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getClientList(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID) {
+    PROFILE_SCOPE();
+    std::vector<anyID> ids;
+    const auto error = batchClientIds(env, (uint64)serverConnectionHandlerID, nullptr, ids);
+    if (error != ERROR_ok) {
+        LOGE("Failed ts3client_getClientList: %d\n", error);
+        return nullptr;
+    }
+    std::vector<jint> values(ids.begin(), ids.end());
+    jintArray ret = env->NewIntArray(static_cast<jsize>(values.size()));
+    if (ret)
+        env->SetIntArrayRegion(ret, 0, static_cast<jsize>(values.size()), values.data());
+    return ret;
+}
+
+JNIEXPORT jintArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getClientVariablesAsInt(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jintArray clientIDs, jintArray flags) {
+    PROFILE_SCOPE();
+    std::vector<jint> properties;
+    if (!readFlags(env, flags, properties))
+        return nullptr;
+    std::vector<anyID> ids;
+    const auto error = batchClientIds(env, (uint64)serverConnectionHandlerID, clientIDs, ids);
+    if (error != ERROR_ok) {
+        LOGE("Failed to get the client IDs: %d\n", error);
+        return nullptr;
+    }
+
+    // One row per client: its ID, then the values in flag order
+    const auto row = properties.size() + 1;
+    std::vector<jint> values(ids.size() * row);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        values[i * row] = ids[i];
+        for (std::size_t p = 0; p < properties.size(); ++p) {
+            int value;
+            if (ts3client_getClientVariableAsInt((uint64)serverConnectionHandlerID, ids[i], static_cast<size_t>(properties[p]), &value) != ERROR_ok)
+                value = INT32_MIN;
+            values[i * row + 1 + p] = value;
+        }
+    }
+    jintArray ret = env->NewIntArray(static_cast<jsize>(values.size()));
+    if (ret)
+        env->SetIntArrayRegion(ret, 0, static_cast<jsize>(values.size()), values.data());
+    return ret;
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getClientVariablesAsString(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jintArray clientIDs, jintArray flags) {
+    PROFILE_SCOPE();
+    std::vector<jint> properties;
+    if (!readFlags(env, flags, properties))
+        return nullptr;
+    std::vector<anyID> ids;
+    const auto error = batchClientIds(env, (uint64)serverConnectionHandlerID, clientIDs, ids);
+    if (error != ERROR_ok) {
+        LOGE("Failed to get the client IDs: %d\n", error);
+        return nullptr;
+    }
+
+    // One row per client: its ID, then the values in flag order
+    jclass stringClass = env->FindClass("java/lang/String");
+    if (!stringClass)
+        return nullptr;
+    jobjectArray ret = env->NewObjectArray(static_cast<jsize>(ids.size() * (properties.size() + 1)), stringClass, nullptr);
+    env->DeleteLocalRef(stringClass);
+    if (!ret)
+        return nullptr;
+    jsize index = 0;
+    for (const auto id : ids) {
+        char id_text[8];
+        std::snprintf(id_text, sizeof(id_text), "%u", static_cast<unsigned int>(id));
+        jstring id_value = env->NewStringUTF(id_text);
+        if (!id_value)
+            return nullptr;
+        env->SetObjectArrayElement(ret, index++, id_value);
+        env->DeleteLocalRef(id_value);
+        for (const auto property : properties) {
+            char* result;
+            if (ts3client_getClientVariableAsString((uint64)serverConnectionHandlerID, id, static_cast<size_t>(property), &result) == ERROR_ok) {
+                jstring value = env->NewStringUTF(result);
+                ts3client_freeMemory(result);
+                if (!value)
+                    return nullptr;
+                env->SetObjectArrayElement(ret, index, value);
+                env->DeleteLocalRef(value);
+            }
+            ++index;
+        }
+    }
+    return ret;
+}
+
+JNIEXPORT jbyteArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getServerTree(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jlong sinceGeneration) {
+    PROFILE_SCOPE();
+    const auto tree = gServerTrees.find((uint64)serverConnectionHandlerID);
+    if (!tree)
+        return nullptr;
+    std::vector<uint8_t> data;
+    tree->serialize(static_cast<uint64_t>(sinceGeneration), data);
+    jbyteArray ret = env->NewByteArray(static_cast<jsize>(data.size()));
+    if (ret)
+        env->SetByteArrayRegion(ret, 0, static_cast<jsize>(data.size()), reinterpret_cast<const jbyte*>(data.data()));
+    return ret;
+}
+
 JNIEXPORT jstring JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getChannelVariableAsString(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jlong channelID, jint flag) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -685,6 +1077,7 @@ JNIEXPORT jstring JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3clien
 }
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getClientID(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -698,6 +1091,7 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
 
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getConnectionStatus(JNIEnv *, jobject, jlong connection_id)
 {
+    PROFILE_SCOPE();
     int connection_status;
     const auto error = ts3client_getConnectionStatus(connection_id, &connection_status);
     if (error != ERROR_ok)
@@ -709,6 +1103,7 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
 }
 
 JNIEXPORT jdouble JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getConnectionVariableAsDouble(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jint clientID, jint flag) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
@@ -722,285 +1117,765 @@ JNIEXPORT jdouble JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3clien
     return result;
 }
 
-///////////////////////////////////////////////////////////////////////////
-// Events
-///////////////////////////////////////////////////////////////////////////
+/*
+ * Reads all connection variables of clientID into values, NaN for the ones the clientlib has none of (the
+ * addresses, or variables of other clients before requestConnectionInfo). Returns how many were read.
+ */
+static int readConnectionVariables(uint64 serverConnectionHandlerID, anyID clientID, double* values) {
+    int read = 0;
+    for (std::size_t flag = 0; flag < CONNECTION_ENDMARKER; ++flag) {
+        uint64 counter;
+        if (ts3client_getConnectionVariableAsDouble(serverConnectionHandlerID, clientID, flag, &values[flag]) == ERROR_ok) {
+            ++read;
+        } else if (ts3client_getConnectionVariableAsUInt64(serverConnectionHandlerID, clientID, flag, &counter) == ERROR_ok) {
+            values[flag] = static_cast<double>(counter);
+            ++read;
+        } else {
+            values[flag] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    return read;
+}
 
-void onConnectStatusChangeEvent(uint64 serverConnectionHandlerID, int newStatus, unsigned int errorNumber) {
-#ifdef DEBUG_BUILD
-    LOGD(__FUNCTION__);
-#endif
-    JNIEnv *env;
-    bool isAttached = connectVM(env);
-    LOGI("ConnectStatusChange");
-    const auto& cache = Android_Event_ConnectStatusChange;
-    jclass interfaceClass = env->GetObjectClass(cache.first);
-    jmethodID method = env->GetMethodID(interfaceClass, "<init>", "(JII)V");
-    const auto new_object = env->NewObject(interfaceClass, method,
-                   serverConnectionHandlerID, newStatus, errorNumber);
+/* ConnectionSampler::Read, the variables of other clients are requested again for the next sample */
+static bool sampleConnectionVariables(uint64_t connection, uint16_t client, double* values) {
+    if (readConnectionVariables(connection, client, values) == 0)
+        return false;
+    anyID own;
+    if (ts3client_getClientID(connection, &own) == ERROR_ok && own != client)
+        ts3client_requestConnectionInfo(connection, client, nullptr);
+    return true;
+}
 
-    env->CallVoidMethod(new_object, cache.second);
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getConnectionVariables(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jint clientID, jobject values) {
+    PROFILE_SCOPE();
+    auto* out = values ? static_cast<double*>(env->GetDirectBufferAddress(values)) : nullptr;
+    if (!out || env->GetDirectBufferCapacity(values) < CONNECTION_ENDMARKER)
+        return -1;
+    return readConnectionVariables((uint64)serverConnectionHandlerID, (anyID)clientID, out);
+}
 
-    if (isAttached)
-        gJavaVM->DetachCurrentThread();
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startConnectionSampler(JNIEnv *env, jobject obj, jint intervalMs, jint historySize) {
+    PROFILE_SCOPE();
+    if (historySize <= 0)
+        return ERROR_parameter_invalid;
+    std::lock_guard<std::mutex> lock(gConnectionSamplerMutex);
+    gConnectionSampler.stop();
+    if (!gConnectionSampler.start(sampleConnectionVariables, CONNECTION_ENDMARKER, intervalMs, static_cast<std::size_t>(historySize))) {
+        LOGE("Failed to start the connection sampler");
+        return ERROR_parameter_invalid;
+    }
+    return ERROR_ok;
 }
 
-void onNewChannelEvent(uint64 serverConnectionHandlerID, uint64 channelID, uint64 channelParentID) {
-#ifdef DEBUG_BUILD
-    LOGD(__FUNCTION__);
-#endif
-    // Connect //
-    JNIEnv *env;
-    bool isAttached = connectVM(env);
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1stopConnectionSampler(JNIEnv *env, jobject obj) {
+    PROFILE_SCOPE();
+    std::lock_guard<std::mutex> lock(gConnectionSamplerMutex);
+    gConnectionSampler.stop();
+    return ERROR_ok;
+}
+
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1watchConnection(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jint clientID) {
+    PROFILE_SCOPE();
+    if (clientID < 0) {
+        gConnectionSampler.unwatch((uint64)serverConnectionHandlerID);
+        return ERROR_ok;
+    }
+    if (clientID > 0xFFFF)
+        return ERROR_parameter_invalid;
+    gConnectionSampler.watch((uint64)serverConnectionHandlerID, (anyID)clientID);
+    return ERROR_ok;
+}
 
-    const auto& cache = Android_Event_NewChannel;
+JNIEXPORT jdoubleArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getConnectionHistory(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jdouble sinceMs) {
+    PROFILE_SCOPE();
+    std::vector<double> samples;
+    if (!gConnectionSampler.history((uint64)serverConnectionHandlerID, sinceMs, samples))
+        return nullptr;
+    const auto count = static_cast<jsize>(samples.size());
+    jdoubleArray ret = env->NewDoubleArray(count);
+    if (ret)
+        env->SetDoubleArrayRegion(ret, 0, count, samples.data());
+    return ret;
+}
 
-    jclass interfaceClass = env->GetObjectClass(cache.first);
-    jmethodID method = env->GetMethodID(interfaceClass, "<init>", "(JJJ)V");
-    const auto new_object = env->NewObject(interfaceClass, method, serverConnectionHandlerID, channelID, channelParentID);
+JNIEXPORT jdoubleArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getConnectionPercentiles(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jint flag, jintArray permilles) {
+    PROFILE_SCOPE();
+    std::vector<jint> ranks;
+    if (flag < 0 || !readFlags(env, permilles, ranks))
+        return nullptr;
+    std::vector<double> values(ranks.size());
+    if (!gConnectionSampler.percentiles((uint64)serverConnectionHandlerID, static_cast<std::size_t>(flag), ranks.data(), ranks.size(), values.data()))
+        return nullptr;
+    const auto count = static_cast<jsize>(values.size());
+    jdoubleArray ret = env->NewDoubleArray(count);
+    if (ret)
+        env->SetDoubleArrayRegion(ret, 0, count, values.data());
+    return ret;
+}
 
-    env->CallVoidMethod(new_object, cache.second);
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getThreadAttachCounters(JNIEnv *env, jobject obj) {
+    PROFILE_SCOPE();
+    const jlong counters[] = {
+            static_cast<jlong>(gThreadAttachCount.load(std::memory_order_relaxed)),
+            static_cast<jlong>(gThreadDetachCount.load(std::memory_order_relaxed))
+    };
+    jlongArray ret = env->NewLongArray(2);
+    if (ret)
+        env->SetLongArrayRegion(ret, 0, 2, counters);
+    return ret;
+}
 
-    if (isAttached)
-        gJavaVM->DetachCurrentThread();
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getStartupTimes(JNIEnv *env, jclass cls) {
+    PROFILE_SCOPE();
+    jlong times[StartupMark_Count];
+    for (int mark = 0; mark < StartupMark_Count; ++mark)
+        times[mark] = static_cast<jlong>(gStartupMarks[mark].load(std::memory_order_relaxed));
+    jlongArray ret = env->NewLongArray(StartupMark_Count);
+    if (ret)
+        env->SetLongArrayRegion(ret, 0, StartupMark_Count, times);
+    return ret;
 }
 
-void onNewChannelCreatedEvent(uint64 serverConnectionHandlerID, uint64 channelID, uint64 channelParentID, anyID invokerID, const char* invokerName, const char* invokerUniqueIdentifier) {
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1configureEventQueue(JNIEnv *env, jclass cls, jint capacity, jint overflowPolicy) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
-    // Connect //
-    JNIEnv *env;
-    bool isAttached = connectVM(env);
-
-    const auto& cache = Android_Event_NewChannelCreated;
-    jclass interfaceClass = env->GetObjectClass(cache.first);
-    jmethodID method = env->GetMethodID(interfaceClass, "<init>",
-                                        "(JJJILjava/lang/String;Ljava/lang/String;)V");
-    jobject temp1 = env->NewLocalRef(env->NewStringUTF(invokerName));
-    jobject temp2 = env->NewLocalRef(
-            env->NewStringUTF(invokerUniqueIdentifier));
-    const auto new_object = env->NewObject(interfaceClass, method,
-                   serverConnectionHandlerID, channelID, channelParentID, invokerID,
-                   temp1, temp2);
-
-    env->CallVoidMethod(new_object, cache.second);
-
-    if (isAttached)
-        gJavaVM->DetachCurrentThread();
-
+    if (capacity < 2 || overflowPolicy < 0 || overflowPolicy >= EventQueueOverflow_Count)
+        return ERROR_parameter_invalid;
+    gEventQueueCapacity.store(static_cast<std::size_t>(capacity));
+    gEventDispatch.set_overflow(static_cast<EventQueueOverflow>(overflowPolicy));
+    return ERROR_ok;
 }
 
-void onDelChannelEvent(uint64 serverConnectionHandlerID, uint64 channelID, anyID invokerID, const char* invokerName, const char* invokerUniqueIdentifier) {
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setEventDispatchThreads(JNIEnv *env, jclass cls, jint threads) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
-    // Connect //
-    JNIEnv *env;
-    bool isAttached = connectVM(env);
-
-    const auto& cache = Android_Event_DelChannel;
-    jclass interfaceClass = env->GetObjectClass(cache.first);
-    jmethodID method = env->GetMethodID(interfaceClass, "<init>", "(JJILjava/lang/String;Ljava/lang/String;)V");
-    jobject temp1 = env->NewLocalRef(env->NewStringUTF(invokerName));
-    jobject temp2 = env->NewLocalRef(
-            env->NewStringUTF(invokerUniqueIdentifier));
-    const auto new_object = env->NewObject(interfaceClass, method,
-                   serverConnectionHandlerID, channelID, invokerID, temp1, temp2);
+    if (threads <= 0 || !gEventDispatch.set_shards(static_cast<std::size_t>(threads)))
+        return ERROR_parameter_invalid;
+    return ERROR_ok;
+}
 
-    env->CallVoidMethod(new_object, cache.second);
-    if (isAttached)
-        gJavaVM->DetachCurrentThread();
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setEventMask(JNIEnv *env, jclass cls, jlong serverConnectionHandlerID, jint mask) {
+    PROFILE_SCOPE();
+#ifdef DEBUG_BUILD
+    LOGD(__FUNCTION__);
+#endif
+    if (mask != -1) {
+        for (int type = 0; type < EventType_Count; ++type) {
+            if (static_cast<uint32_t>(mask) & (1u << type))
+                gEventClasses[type]->resolve(env);
+        }
+    }
+    if (serverConnectionHandlerID == 0) {
+        gEventMask.set_default(static_cast<uint32_t>(mask));
+    } else if (mask == -1) {
+        gEventMask.reset(static_cast<uint64>(serverConnectionHandlerID));
+    } else if (!gEventMask.set(static_cast<uint64>(serverConnectionHandlerID), static_cast<uint32_t>(mask))) {
+        LOGE("Too many event mask overrides\n");
+        return ERROR_undefined;
+    }
+    return ERROR_ok;
+}
 
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setEventBatchDelivery(JNIEnv *env, jobject obj, jobject batch) {
+    PROFILE_SCOPE();
+#ifdef DEBUG_BUILD
+    LOGD(__FUNCTION__);
+#endif
+    gEventDispatch.set_batch(env, batch);
+    return ERROR_ok;
 }
 
-void onClientMoveEvent(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, const char* moveMessage) {
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setEventCoalescingWindow(JNIEnv *env, jobject obj, jint eventType, jint windowMs) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
-    // Connect //
-    JNIEnv *env;
-    bool isAttached = connectVM(env);
+    if (eventType < 0 || eventType >= EventType_Count)
+        return ERROR_parameter_invalid;
+    if (!gEventDispatch.set_coalescing_window(static_cast<EventType>(eventType), std::chrono::milliseconds(windowMs)))
+        return ERROR_parameter_invalid;
+    return ERROR_ok;
+}
 
-    const auto& cache = Android_Event_ClientMove;
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getEventQueueCounters(JNIEnv *env, jobject obj) {
+    PROFILE_SCOPE();
+    const auto counters = gEventDispatch.counters();
+    const jlong values[] = {
+            static_cast<jlong>(counters.depth),
+            static_cast<jlong>(counters.high_water),
+            static_cast<jlong>(counters.dispatched),
+            static_cast<jlong>(counters.dropped),
+            static_cast<jlong>(counters.coalesced),
+            static_cast<jlong>(gEventDispatch.coalescing_pending()),
+            static_cast<jlong>(gEventDispatch.coalescing_eliminated())
+    };
+    const auto count = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    jlongArray ret = env->NewLongArray(count);
+    if (ret)
+        env->SetLongArrayRegion(ret, 0, count, values);
+    return ret;
+}
 
-    jclass interfaceClass = env->GetObjectClass(cache.first);
-    jmethodID method = env->GetMethodID(interfaceClass, "<init>",
-                                        "(JIJJILjava/lang/String;)V");
-    jobject temp1 = env->NewLocalRef(env->NewStringUTF(moveMessage));
-    const auto new_object = env->NewObject(interfaceClass, method,
-                   serverConnectionHandlerID, clientID, oldChannelID, newChannelID,
-                   visibility, temp1);
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getEventShardCounters(JNIEnv *env, jobject obj, jint shard) {
+    PROFILE_SCOPE();
+    if (shard < 0 || static_cast<std::size_t>(shard) >= gEventDispatch.shards())
+        return nullptr;
+    const auto& queue = gEventDispatch.shard(static_cast<std::size_t>(shard));
+    const auto counters = queue.counters();
+    const jlong values[] = {
+            static_cast<jlong>(counters.depth),
+            static_cast<jlong>(counters.high_water),
+            static_cast<jlong>(counters.dispatched),
+            static_cast<jlong>(counters.dropped),
+            static_cast<jlong>(counters.coalesced),
+            static_cast<jlong>(queue.coalescer().pending()),
+            static_cast<jlong>(queue.coalescer().eliminated())
+    };
+    const auto count = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    jlongArray ret = env->NewLongArray(count);
+    if (ret)
+        env->SetLongArrayRegion(ret, 0, count, values);
+    return ret;
+}
 
-    env->CallVoidMethod(new_object, cache.second);
-    if (isAttached)
-        gJavaVM->DetachCurrentThread();
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setEventStringCacheCapacity(JNIEnv *env, jobject obj, jint bytes) {
+    PROFILE_SCOPE();
+    if (bytes < 0)
+        return ERROR_parameter_invalid;
+    event_strings().set_capacity(env, static_cast<std::size_t>(bytes));
+    return ERROR_ok;
+}
 
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getEventStringCacheCounters(JNIEnv *env, jobject obj) {
+    PROFILE_SCOPE();
+    const auto counters = event_strings().counters();
+    const jlong values[] = {
+            static_cast<jlong>(counters.hits),
+            static_cast<jlong>(counters.misses),
+            static_cast<jlong>(counters.bypassed),
+            static_cast<jlong>(counters.evictions),
+            static_cast<jlong>(counters.entries),
+            static_cast<jlong>(counters.bytes)
+    };
+    const auto count = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    jlongArray ret = env->NewLongArray(count);
+    if (ret)
+        env->SetLongArrayRegion(ret, 0, count, values);
+    return ret;
 }
 
-void onClientMoveSubscriptionEvent(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility) {
-#ifdef DEBUG_BUILD
-    LOGD(__FUNCTION__);
-#endif
-    // Connect //
-    JNIEnv *env;
-    bool isAttached = connectVM(env);
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setLogLevel(JNIEnv *env, jobject obj, jint level) {
+    PROFILE_SCOPE();
+    if (level < LogLevel_CRITICAL || level > LogLevel_DEVEL)
+        return ERROR_parameter_invalid;
+    gNativeLog.set_level(level);
+    // The clientlib does not even format the lines that would be dropped
+    unsigned int error;
+    if ((error = ts3client_setLogVerbosity(static_cast<LogLevel>(level))) != ERROR_ok) {
+        LOGE("Failed ts3client_setLogVerbosity: %d\n", error);
+        return static_cast<jint>(error);
+    }
+    return ERROR_ok;
+}
 
-    const auto& cache = Android_Event_ClientMoveSubscription;
+JNIEXPORT jbyteArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1drainLog(JNIEnv *env, jobject obj, jint maxRecords) {
+    PROFILE_SCOPE();
+    if (maxRecords <= 0)
+        return nullptr;
+    std::vector<uint8_t> data;
+    gNativeLog.drain(static_cast<std::size_t>(maxRecords), data);
+    const auto size = static_cast<jsize>(data.size());
+    jbyteArray ret = env->NewByteArray(size);
+    if (ret)
+        env->SetByteArrayRegion(ret, 0, size, reinterpret_cast<const jbyte*>(data.data()));
+    return ret;
+}
 
-    jclass interfaceClass = env->GetObjectClass(cache.first);
-    jmethodID method = env->GetMethodID(interfaceClass, "<init>", "(JIJJI)V");
-    const auto new_object = env->NewObject(interfaceClass, method,
-                   serverConnectionHandlerID, clientID, oldChannelID, newChannelID,
-                   visibility);
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1openLogFile(JNIEnv *env, jobject obj, jstring path, jint records) {
+    PROFILE_SCOPE();
+    if (!path || records <= 0)
+        return ERROR_parameter_invalid;
+    const JniUtf8 file_path(env, path);
+    const bool opened = gNativeLog.open_file(file_path.c_str(), static_cast<std::size_t>(records));
+    if (!opened)
+        LOGE("Failed to open the log file %s", file_path.c_str());
+    return opened ? ERROR_ok : ERROR_undefined;
+}
 
-    env->CallVoidMethod(new_object, cache.second);
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1closeLogFile(JNIEnv *env, jobject obj) {
+    PROFILE_SCOPE();
+    gNativeLog.close_file();
+    return ERROR_ok;
+}
 
-    if (isAttached)
-        gJavaVM->DetachCurrentThread();
+JNIEXPORT jbyteArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1readLogFile(JNIEnv *env, jobject obj, jstring path) {
+    PROFILE_SCOPE();
+    if (!path)
+        return nullptr;
+    std::vector<uint8_t> data;
+    const JniUtf8 file_path(env, path);
+    const bool read = NativeLog::read_file(file_path.c_str(), data);
+    if (!read)
+        return nullptr;
+    const auto size = static_cast<jsize>(data.size());
+    jbyteArray ret = env->NewByteArray(size);
+    if (ret)
+        env->SetByteArrayRegion(ret, 0, size, reinterpret_cast<const jbyte*>(data.data()));
+    return ret;
 }
 
-void onClientMoveTimeoutEvent(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, const char* timeoutMessage) {
-#ifdef DEBUG_BUILD
-    LOGD(__FUNCTION__);
-#endif
-    // Connect //
-    JNIEnv *env;
-    bool isAttached = connectVM(env);
+JNIEXPORT jstring JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getProfileReport(JNIEnv *env, jobject obj, jint format) {
+    PROFILE_SCOPE();
+    if (format != ProfileFormat_Table && format != ProfileFormat_Csv)
+        return nullptr;
+    return env->NewStringUTF(profile_report(static_cast<ProfileFormat>(format)).c_str());
+}
 
-    const auto& cache = Android_Event_ClientMoveTimeout;
+JNIEXPORT void JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1resetProfile(JNIEnv *env, jobject obj) {
+    profile_reset();
+}
 
-    jclass interfaceClass = env->GetObjectClass(cache.first);
-    jmethodID method = env->GetMethodID(interfaceClass, "<init>",
-                                        "(JIJJILjava/lang/String;)V");
-    jobject temp1 = env->NewLocalRef(env->NewStringUTF(timeoutMessage));
-    const auto new_object = env->NewObject(interfaceClass, method,
-                   serverConnectionHandlerID, clientID, oldChannelID, newChannelID,
-                   visibility, temp1);
+#ifdef LOAD_GENERATOR
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startLoadGenerator(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jintArray eventTypes, jintArray eventsPerSecond, jint threadsPerType, jint connections, jint durationMs) {
+    PROFILE_SCOPE();
+    if (!eventTypes || !eventsPerSecond)
+        return ERROR_parameter_invalid;
+    const auto count = env->GetArrayLength(eventTypes);
+    if (count == 0 || count != env->GetArrayLength(eventsPerSecond))
+        return ERROR_parameter_invalid;
+    std::vector<jint> types(static_cast<std::size_t>(count));
+    std::vector<jint> rates(static_cast<std::size_t>(count));
+    env->GetIntArrayRegion(eventTypes, 0, count, types.data());
+    env->GetIntArrayRegion(eventsPerSecond, 0, count, rates.data());
+
+    std::vector<LoadGenerator::Workload> workloads;
+    for (jsize i = 0; i < count; ++i) {
+        if (types[i] < 0 || types[i] >= EventType_Count)
+            return ERROR_parameter_invalid;
+        workloads.push_back({static_cast<EventType>(types[i]), rates[i]});
+    }
+    std::lock_guard<std::mutex> lock(gLoadGeneratorMutex);
+    if (!gLoadGenerator.start(raiseSyntheticEvent, workloads, threadsPerType, static_cast<uint64>(serverConnectionHandlerID), connections, durationMs)) {
+        LOGE("Failed to start the load generator");
+        return ERROR_parameter_invalid;
+    }
+    return ERROR_ok;
+}
 
-    env->CallVoidMethod(new_object, cache.second);
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1stopLoadGenerator(JNIEnv *env, jobject obj) {
+    PROFILE_SCOPE();
+    std::lock_guard<std::mutex> lock(gLoadGeneratorMutex);
+    gLoadGenerator.stop();
+    return ERROR_ok;
+}
 
-    if (isAttached)
-        gJavaVM->DetachCurrentThread();
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getLoadGeneratorCounters(JNIEnv *env, jobject obj, jint eventType) {
+    PROFILE_SCOPE();
+    if (eventType < 0 || eventType >= EventType_Count)
+        return nullptr;
+    const auto type = static_cast<EventType>(eventType);
+    jlong values[3 + LatencyHistogram::snapshot_size];
+    {
+        std::lock_guard<std::mutex> lock(gLoadGeneratorMutex);
+        const auto counters = gLoadGenerator.counters(type);
+        values[0] = static_cast<jlong>(counters.generated);
+        values[1] = static_cast<jlong>(counters.late);
+        values[2] = static_cast<jlong>(counters.elapsed_ns);
+        gLoadGenerator.call_latency(type).snapshot(reinterpret_cast<int64_t*>(values + 3));
+    }
+    const auto count = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    jlongArray ret = env->NewLongArray(count);
+    if (ret)
+        env->SetLongArrayRegion(ret, 0, count, values);
+    return ret;
+}
+#endif
 
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getEventLatencySnapshot(JNIEnv *env, jobject obj, jint eventType, jboolean reset) {
+    PROFILE_SCOPE();
+    if (eventType < 0 || eventType >= EventType_Count)
+        return nullptr;
+    jlong values[LatencyHistogram::snapshot_size];
+    gEventDispatch.latency_snapshot(static_cast<EventType>(eventType), reinterpret_cast<int64_t*>(values), reset);
+    jlongArray ret = env->NewLongArray(LatencyHistogram::snapshot_size);
+    if (ret)
+        env->SetLongArrayRegion(ret, 0, LatencyHistogram::snapshot_size, values);
+    return ret;
 }
 
-void onClientMoveMovedEvent(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, anyID moverID, const char* moverName, const char* moverUniqueIdentifier, const char* moveMessage) {
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startAudioPump(JNIEnv *env, jobject obj, jint deviceHandle, jint backendType, jstring capturePath, jstring playbackPath, jint periodMs) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
-    // Connect //
-    JNIEnv *env;
-    bool isAttached = connectVM(env);
+    std::lock_guard<std::mutex> lock(gAudioPumpMutex);
+    CustomDeviceTable::Reader devices(gCustomDevices);
+    const auto* device = devices.get(deviceHandle);
+    if (!device || periodMs <= 0)
+        return ERROR_parameter_invalid;
 
-    const auto& cache = Android_Event_ClientMoveMoved;
+    std::unique_ptr<AudioBackend> backend;
+    switch (backendType) {
+        case AudioPumpBackend_Null:
+            backend.reset(new NullAudioBackend());
+            break;
+        case AudioPumpBackend_File: {
+            const JniUtf8 _capturePath(env, capturePath);
+            const JniUtf8 _playbackPath(env, playbackPath);
+            backend.reset(new FileAudioBackend(_capturePath.c_str(), _playbackPath.c_str()));
+            break;
+        }
+        case AudioPumpBackend_Java:
+            backend.reset(new JavaStreamBackend(gJavaStreams[deviceHandle], gAudioLatency[deviceHandle]));
+            break;
+        default:
+            return ERROR_parameter_invalid;
+    }
 
-    jclass interfaceClass = env->GetObjectClass(cache.first);
-    jmethodID method = env->GetMethodID(interfaceClass, "<init>",
-                                        "(JIJJIILjava/lang/String;Ljava/lang/String;Ljava/lang/String;)V");
-    jobject temp1 = env->NewLocalRef(env->NewStringUTF(moverName));
-    jobject temp2 = env->NewLocalRef(env->NewStringUTF(moverUniqueIdentifier));
-    jobject temp3 = env->NewLocalRef(env->NewStringUTF(moveMessage));
-    const auto new_object = env->NewObject(interfaceClass, method,
-                   serverConnectionHandlerID, clientID, oldChannelID, newChannelID,
-                   visibility, moverID, temp1, temp2, temp3);
+    auto& pump = gAudioPumps[deviceHandle];
+    pump.stop();
+    if (!pump.start(*device, std::move(backend), periodMs, &gAudioLatency[deviceHandle])) {
+        LOGE("Failed to start the audio pump of %s\n", device->id);
+        return ERROR_undefined;
+    }
+    return ERROR_ok;
+}
 
-    env->CallVoidMethod(new_object, cache.second);
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1stopAudioPump(JNIEnv *env, jobject obj, jint deviceHandle) {
+    PROFILE_SCOPE();
+#ifdef DEBUG_BUILD
+    LOGD(__FUNCTION__);
+#endif
+    std::lock_guard<std::mutex> lock(gAudioPumpMutex);
+    if (!gCustomDevices.contains(deviceHandle))
+        return ERROR_parameter_invalid;
+    gAudioPumps[deviceHandle].stop();
+    return ERROR_ok;
+}
 
-    if (isAttached)
-        gJavaVM->DetachCurrentThread();
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setCustomDeviceBufferFormat(JNIEnv *env, jobject obj, jint deviceHandle, jint captureEncoding, jint captureChannels, jint playbackEncoding, jint playbackChannels) {
+    PROFILE_SCOPE();
+#ifdef DEBUG_BUILD
+    LOGD(__FUNCTION__);
+#endif
+    auto isEncoding = [](jint encoding) { return encoding == SampleEncoding_Int16 || encoding == SampleEncoding_Float; };
+    if (!isEncoding(captureEncoding) || !isEncoding(playbackEncoding))
+        return ERROR_parameter_invalid;
 
+    CustomDevice device;
+    {
+        CustomDeviceTable::Reader devices(gCustomDevices);
+        const auto* current = devices.get(deviceHandle);
+        if (!current)
+            return ERROR_parameter_invalid;
+        device = *current;
+    }
+    if ((device.capture_channels > 0 && !can_convert_channels(captureChannels, device.capture_channels)) ||
+        (device.playback_channels > 0 && !can_convert_channels(device.playback_channels, playbackChannels))) {
+        LOGE("Unsupported channel conversion for %s\n", device.id);
+        return ERROR_parameter_invalid;
+    }
+    device.capture_buffer_encoding = captureEncoding;
+    device.capture_buffer_channels = captureChannels;
+    device.playback_buffer_encoding = playbackEncoding;
+    device.playback_buffer_channels = playbackChannels;
+    return gCustomDevices.add(device) == deviceHandle ? ERROR_ok : ERROR_parameter_invalid;
 }
 
-void onTalkStatusChangeEvent(uint64 serverConnectionHandlerID, int status, int isReceivedWhisper, anyID clientID) {
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setCustomDeviceBufferRate(JNIEnv *env, jobject obj, jint deviceHandle, jint captureFrequency, jint playbackFrequency, jint quality) {
+    PROFILE_SCOPE();
 #ifdef DEBUG_BUILD
     LOGD(__FUNCTION__);
 #endif
-    // Connect //
-    JNIEnv *env;
-    bool isAttached = connectVM(env);
+    CustomDevice device;
+    {
+        CustomDeviceTable::Reader devices(gCustomDevices);
+        const auto* current = devices.get(deviceHandle);
+        if (!current)
+            return ERROR_parameter_invalid;
+        device = *current;
+    }
+    // Reject ratios the resampler cannot handle now rather than on the audio thread
+    PolyphaseResampler probe;
+    if ((device.capture_channels > 0 && captureFrequency != device.capture_frequency &&
+         !probe.configure(captureFrequency, device.capture_frequency, 1, quality)) ||
+        (device.playback_channels > 0 && playbackFrequency != device.playback_frequency &&
+         !probe.configure(device.playback_frequency, playbackFrequency, 1, quality))) {
+        LOGE("Unsupported sample rate conversion for %s\n", device.id);
+        return ERROR_parameter_invalid;
+    }
+    device.capture_buffer_frequency = captureFrequency;
+    device.playback_buffer_frequency = playbackFrequency;
+    device.resampler_quality = quality;
+    return gCustomDevices.add(device) == deviceHandle ? ERROR_ok : ERROR_parameter_invalid;
+}
 
-    const auto& cache = Android_Event_TalkStatusChange;
-    jclass interfaceClass = env->GetObjectClass(cache.first);
-    jmethodID method = env->GetMethodID(interfaceClass, "<init>", "(JIII)V");
-    const auto new_object = env->NewObject(interfaceClass, method,
-                   serverConnectionHandlerID, status, isReceivedWhisper, clientID);
+/* Copies samples frames from the registered capture buffer into the capture ring. Returns the frames accepted or -error. */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1writeCustomCaptureDataByHandle(JNIEnv*, jclass, jint deviceHandle, jint samples) {
+    PROFILE_SCOPE();
+    CustomDeviceTable::Reader devices(gCustomDevices);
+    const auto* device = devices.get(deviceHandle);
+    if (!device || !device->capture_buffer)
+        return -static_cast<jint>(ERROR_parameter_invalid);
+    if (!device->capture_buffer_fits(samples))
+        return -static_cast<jint>(ERROR_parameter_invalid_count);
+
+    auto& latency = gAudioLatency[deviceHandle];
+    const auto start = monotonic_ns();
+    latency.record_interval(AudioLatency::CaptureInterval, latency.last_capture_call, start);
+    std::size_t frames = samples;
+    const short* data = captureSamples(deviceHandle, *device, frames);
+    auto& capture = gJavaStreams[deviceHandle].capture;
+    const auto written = capture.write(data, frames);
+    const auto end = monotonic_ns();
+    latency.capture_chunks.push(capture.write_position(), end);
+    latency.histograms[AudioLatency::CaptureCall].record(end - start);
+    // Report in buffer frames, the ring counts clientlib frames
+    return written == frames ? samples : static_cast<jint>(written * samples / std::max<std::size_t>(frames, 1));
+}
 
-    env->CallVoidMethod(new_object, cache.second);
+/* Fills the registered playback buffer with samples frames from the jitter buffer. Returns the frames that were buffered or -error. */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1readCustomPlaybackDataByHandle(JNIEnv*, jclass, jint deviceHandle, jint samples) {
+    PROFILE_SCOPE();
+    CustomDeviceTable::Reader devices(gCustomDevices);
+    const auto* device = devices.get(deviceHandle);
+    if (!device || !device->playback_buffer)
+        return -static_cast<jint>(ERROR_parameter_invalid);
+    if (!device->playback_buffer_fits(samples))
+        return -static_cast<jint>(ERROR_parameter_invalid_count);
+
+    auto& latency = gAudioLatency[deviceHandle];
+    const auto start = monotonic_ns();
+    latency.record_interval(AudioLatency::PlaybackInterval, latency.last_playback_call, start);
+    auto& playback = gJavaStreams[deviceHandle].playback;
+    const auto result = fillPlaybackSamples(deviceHandle, *device, samples, [&playback, samples](short* data, std::size_t frames) {
+        const auto buffered = playback.read(data, frames);
+        return buffered == frames ? samples : static_cast<jint>(buffered * samples / std::max<std::size_t>(frames, 1));
+    });
+    const auto end = monotonic_ns();
+    latency.playback_chunks.pop(playback.read_position(), end, latency.histograms[AudioLatency::PlaybackQueueing]);
+    latency.histograms[AudioLatency::PlaybackCall].record(end - start);
+    return result;
+}
 
-    if (isAttached)
-        gJavaVM->DetachCurrentThread();
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getPlaybackBufferCounters(JNIEnv *env, jobject obj, jint deviceHandle) {
+    PROFILE_SCOPE();
+    if (!gCustomDevices.contains(deviceHandle))
+        return nullptr;
+    const auto counters = gJavaStreams[deviceHandle].playback.counters();
+    jlong values[3 + PlaybackJitterBuffer::histogram_buckets] = {
+            static_cast<jlong>(counters.depth),
+            static_cast<jlong>(counters.target),
+            static_cast<jlong>(counters.underruns)
+    };
+    for (int i = 0; i < PlaybackJitterBuffer::histogram_buckets; ++i)
+        values[3 + i] = static_cast<jlong>(counters.histogram[i]);
+    const auto count = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    jlongArray ret = env->NewLongArray(count);
+    if (ret)
+        env->SetLongArrayRegion(ret, 0, count, values);
+    return ret;
 }
 
-void onServerErrorEvent(uint64 serverConnectionHandlerID, const char* errorMessage, unsigned int error, const char* returnCode, const char* extraMessage) {
-#ifdef DEBUG_BUILD
-    LOGD(__FUNCTION__);
-#endif
-    // Connect //
-    JNIEnv *env;
-    bool isAttached = connectVM(env);
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getCaptureRingCounters(JNIEnv *env, jobject obj, jint deviceHandle) {
+    PROFILE_SCOPE();
+    if (!gCustomDevices.contains(deviceHandle))
+        return nullptr;
+    const auto counters = gJavaStreams[deviceHandle].capture.counters();
+    const jlong values[] = {
+            static_cast<jlong>(counters.fill),
+            static_cast<jlong>(counters.capacity),
+            static_cast<jlong>(counters.high_water),
+            static_cast<jlong>(counters.overrun_frames),
+            static_cast<jlong>(counters.underruns)
+    };
+    const auto count = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    jlongArray ret = env->NewLongArray(count);
+    if (ret)
+        env->SetLongArrayRegion(ret, 0, count, values);
+    return ret;
+}
 
-    const auto& cache = Android_Event_ServerError;
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getAudioLatencySnapshot(JNIEnv *env, jobject obj, jint deviceHandle, jboolean reset) {
+    PROFILE_SCOPE();
+    if (!gCustomDevices.contains(deviceHandle))
+        return nullptr;
+    auto& latency = gAudioLatency[deviceHandle];
+    jlong values[AudioLatency::HistogramCount * LatencyHistogram::snapshot_size];
+    for (int i = 0; i < AudioLatency::HistogramCount; ++i) {
+        latency.histograms[i].snapshot(reinterpret_cast<int64_t*>(values + i * LatencyHistogram::snapshot_size));
+        if (reset)
+            latency.histograms[i].reset();
+    }
+    const auto count = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    jlongArray ret = env->NewLongArray(count);
+    if (ret)
+        env->SetLongArrayRegion(ret, 0, count, values);
+    return ret;
+}
 
-    jclass interfaceClass = env->GetObjectClass(cache.first);
-    jmethodID method = env->GetMethodID(interfaceClass, "<init>",
-                                        "(JLjava/lang/String;ILjava/lang/String;Ljava/lang/String;)V");
-    jobject temp1 = env->NewLocalRef(env->NewStringUTF(errorMessage));
-    jobject temp2 = env->NewLocalRef(env->NewStringUTF(returnCode));
-    jobject temp3 = env->NewLocalRef(env->NewStringUTF(extraMessage));
-    const auto new_object = env->NewObject(interfaceClass, method,
-                   serverConnectionHandlerID, temp1, error, temp2, temp3);
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getAudioPumpCounters(JNIEnv *env, jobject obj, jint deviceHandle) {
+    PROFILE_SCOPE();
+    if (!gCustomDevices.contains(deviceHandle))
+        return nullptr;
+    const auto counters = gAudioPumps[deviceHandle].counters();
+    const jlong values[] = {
+            static_cast<jlong>(counters.periods),
+            static_cast<jlong>(counters.playback_underruns),
+            static_cast<jlong>(counters.capture_errors),
+            static_cast<jlong>(counters.late_periods)
+    };
+    const auto count = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    jlongArray ret = env->NewLongArray(count);
+    if (ret)
+        env->SetLongArrayRegion(ret, 0, count, values);
+    return ret;
+}
 
-    env->CallVoidMethod(new_object, cache.second);
+///////////////////////////////////////////////////////////////////////////
+// Events
+///////////////////////////////////////////////////////////////////////////
 
-    if (isAttached)
-        gJavaVM->DetachCurrentThread();
+/*
+ * Generic handler for all forwarded callbacks. Args are deduced from the ClientUIFunctions member
+ * the instantiation is assigned to, e.g. clUIFuncs.onClientMoveEvent = forwardEvent<Android_Event_ClientMove>
+ */
+template <auto& event, typename... Args>
+void dispatchEvent(JNIEnv* env, const EventRecord& record) {
+    PROFILE_SCOPE_NAMED(event.path(), "dispatch");
+    std::apply([env](Args... args) { event.post(env, args...); }, record.unpack<Args...>());
+}
 
+/* Server connection handler an event belongs to, for the per connection event masks */
+template <typename... Args>
+uint64 connectionOf(uint64 serverConnectionHandlerID, Args...) {
+    return serverConnectionHandlerID;
 }
 
-void onUserLoggingMessageEvent(const char* logMessage, int logLevel, const char* logChannel, uint64 logID, const char* logTime, const char* completeLogString) {
+uint64 connectionOf(const char* /*logMessage*/, int /*logLevel*/, const char* /*logChannel*/, uint64 logID, const char* /*logTime*/, const char* /*completeLogString*/) {
+    return logID;
+}
+
+template <auto& event, typename... Args>
+void forwardEvent(Args... args) {
+    PROFILE_SCOPE_NAMED(event.path(), "event");
+    if (!gEventMask.is_enabled(event.type(), connectionOf(args...)))
+        return;
 #ifdef DEBUG_BUILD
-    LOGD(__FUNCTION__);
+    LOGD("%s", event.path());
 #endif
+    const auto queued = gEventDispatch.push(event.type(), connectionOf(args...), [&](EventRecord& record) {
+        record.pack(dispatchEvent<event, Args...>, event.type(), args...);
+    });
+    if (queued)
+        return;
+
+    // Connect //
+    JNIEnv *env = connectVM();
+    if (!env)
+        return;
+
+    event.post(env, args...);
+}
+
+void onUserLoggingMessageEvent(const char* logMessage, int logLevel, const char* logChannel, uint64 logID, const char* logTime, const char* completeLogString) {
+    if (!gNativeLog.write(logLevel, logChannel, logID, logMessage))
+        return;
 #ifdef DEBUG_CLIENTLIB
-    __android_log_print(ANDROID_LOG_DEBUG, "DEBUG", "%s",completeLogString);
+    LOG_PRINT(DEBUG, "DEBUG", "%s", completeLogString);
 #endif
-    // Connect //
-    JNIEnv *env;
-    bool isAttached = connectVM(env);
+    forwardEvent<Android_Event_UserLoggingMessage>(logMessage, logLevel, logChannel, logID, logTime, completeLogString);
+}
+
+///////////////////////////////////////////////////////////////////////////
+// Server tree
+///////////////////////////////////////////////////////////////////////////
+
+static std::string channelName(uint64 serverConnectionHandlerID, uint64 channelID) {
+    char* name;
+    if (ts3client_getChannelVariableAsString(serverConnectionHandlerID, channelID, CHANNEL_NAME, &name) != ERROR_ok)
+        return {};
+    std::string result(name);
+    ts3client_freeMemory(name);
+    return result;
+}
+
+static std::string clientNickname(uint64 serverConnectionHandlerID, anyID clientID) {
+    char* nickname;
+    if (ts3client_getClientVariableAsString(serverConnectionHandlerID, clientID, CLIENT_NICKNAME, &nickname) != ERROR_ok)
+        return {};
+    std::string result(nickname);
+    ts3client_freeMemory(nickname);
+    return result;
+}
 
-    const auto& cache = Android_Event_UserLoggingMessage;
+/*
+ * The handlers below update gServerTrees before forwarding, independent of the event mask. Args are the
+ * trailing callback arguments, deduced like those of forwardEvent.
+ */
+template <auto& event, typename... Args>
+void trackConnectStatus(uint64 serverConnectionHandlerID, int newStatus, Args... args) {
+    if (newStatus == STATUS_DISCONNECTED) {
+        if (auto tree = gServerTrees.find(serverConnectionHandlerID))
+            tree->clear();
+    } else if (newStatus == STATUS_CONNECTION_ESTABLISHED) {
+        markStartup(StartupMark_Connected);
+    }
+    forwardEvent<event>(serverConnectionHandlerID, newStatus, args...);
+}
+
+template <auto& event, typename... Args>
+void trackNewChannel(uint64 serverConnectionHandlerID, uint64 channelID, uint64 channelParentID, Args... args) {
+    gServerTrees.get(serverConnectionHandlerID)->add_channel(channelID, channelParentID, channelName(serverConnectionHandlerID, channelID).c_str());
+    forwardEvent<event>(serverConnectionHandlerID, channelID, channelParentID, args...);
+}
 
-    jclass interfaceClass = env->GetObjectClass(cache.first);
-    jmethodID method =
-            env->GetMethodID(interfaceClass, "<init>",
-                             "(Ljava/lang/String;ILjava/lang/String;JLjava/lang/String;Ljava/lang/String;)V");
-    jobject temp1 = env->NewLocalRef(env->NewStringUTF(logMessage));
-    jobject temp2 = env->NewLocalRef(env->NewStringUTF(logChannel));
-    jobject temp3 = env->NewLocalRef(env->NewStringUTF(logTime));
-    jobject temp4 = env->NewLocalRef(env->NewStringUTF(completeLogString));
+template <auto& event, typename... Args>
+void trackDelChannel(uint64 serverConnectionHandlerID, uint64 channelID, Args... args) {
+    if (auto tree = gServerTrees.find(serverConnectionHandlerID))
+        tree->remove_channel(channelID);
+    forwardEvent<event>(serverConnectionHandlerID, channelID, args...);
+}
 
-    const auto new_object = env->NewObject(interfaceClass, method, temp1, logLevel, temp2,
-                   logID, temp3, temp4);
+template <auto& event, typename... Args>
+void trackClientMove(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, Args... args) {
+    auto tree = gServerTrees.get(serverConnectionHandlerID);
+    if (visibility == LEAVE_VISIBILITY || newChannelID == 0)
+        tree->remove_client(clientID);
+    else if (visibility == ENTER_VISIBILITY || oldChannelID == 0)
+        tree->move_client(clientID, newChannelID, clientNickname(serverConnectionHandlerID, clientID).c_str());
+    else
+        tree->move_client(clientID, newChannelID, nullptr);
+    forwardEvent<event>(serverConnectionHandlerID, clientID, oldChannelID, newChannelID, visibility, args...);
+}
 
-    env->CallVoidMethod(new_object, cache.second);
+/* Not forwarded to Java, they only keep the tree current */
+void onUpdateChannelEditedEvent(uint64 serverConnectionHandlerID, uint64 channelID, anyID /*invokerID*/, const char* /*invokerName*/, const char* /*invokerUniqueIdentifier*/) {
+    if (auto tree = gServerTrees.find(serverConnectionHandlerID))
+        tree->rename_channel(channelID, channelName(serverConnectionHandlerID, channelID).c_str());
+}
 
-    if (isAttached)
-        gJavaVM->DetachCurrentThread();
+void onChannelMoveEvent(uint64 serverConnectionHandlerID, uint64 channelID, uint64 newChannelParentID, anyID /*invokerID*/, const char* /*invokerName*/, const char* /*invokerUniqueIdentifier*/) {
+    if (auto tree = gServerTrees.find(serverConnectionHandlerID))
+        tree->move_channel(channelID, newChannelParentID);
+}
 
+void onUpdateClientEvent(uint64 serverConnectionHandlerID, anyID clientID, anyID /*invokerID*/, const char* /*invokerName*/, const char* /*invokerUniqueIdentifier*/) {
+    if (auto tree = gServerTrees.find(serverConnectionHandlerID))
+        tree->rename_client(clientID, clientNickname(serverConnectionHandlerID, clientID).c_str());
 }
 
 ///////////////////////////////////////////////////////////////////////////
 // Internals
 ///////////////////////////////////////////////////////////////////////////
 
-/* Initialize client lib with callbacks */
-int init(const char* native_lib_path/*, const std::vector<std::string>& events_to_register*/) {
-#ifdef DEBUG_BUILD
-    LOGD(__FUNCTION__);
-#endif
-    unsigned int error;
-
+/* Callback function pointers */
+static ClientUIFunctions clientCallbacks() {
     /* Create struct for callback function pointers */
     struct ClientUIFunctions clUIFuncs;
 
@@ -1009,17 +1884,61 @@ int init(const char* native_lib_path/*, const std::vector<std::string>& events_t
 
     /* Callback function pointers */
     /* It is sufficient to only assign those callback functions you are using. When adding more callbacks, add those function pointers here. */
-    clUIFuncs.onConnectStatusChangeEvent    = onConnectStatusChangeEvent;
-    clUIFuncs.onNewChannelEvent             = onNewChannelEvent;
-    clUIFuncs.onNewChannelCreatedEvent      = onNewChannelCreatedEvent;
-    clUIFuncs.onDelChannelEvent             = onDelChannelEvent;
-    clUIFuncs.onClientMoveEvent             = onClientMoveEvent;
-    clUIFuncs.onClientMoveSubscriptionEvent = onClientMoveSubscriptionEvent;
-    clUIFuncs.onClientMoveTimeoutEvent      = onClientMoveTimeoutEvent;
-    clUIFuncs.onClientMoveMovedEvent        = onClientMoveMovedEvent;
-    clUIFuncs.onTalkStatusChangeEvent       = onTalkStatusChangeEvent;
-    clUIFuncs.onServerErrorEvent            = onServerErrorEvent;
+    clUIFuncs.onConnectStatusChangeEvent    = trackConnectStatus<Android_Event_ConnectStatusChange>;
+    clUIFuncs.onNewChannelEvent             = trackNewChannel<Android_Event_NewChannel>;
+    clUIFuncs.onNewChannelCreatedEvent      = trackNewChannel<Android_Event_NewChannelCreated>;
+    clUIFuncs.onDelChannelEvent             = trackDelChannel<Android_Event_DelChannel>;
+    clUIFuncs.onClientMoveEvent             = trackClientMove<Android_Event_ClientMove>;
+    clUIFuncs.onClientMoveSubscriptionEvent = trackClientMove<Android_Event_ClientMoveSubscription>;
+    clUIFuncs.onClientMoveTimeoutEvent      = trackClientMove<Android_Event_ClientMoveTimeout>;
+    clUIFuncs.onClientMoveMovedEvent        = trackClientMove<Android_Event_ClientMoveMoved>;
+    clUIFuncs.onTalkStatusChangeEvent       = forwardEvent<Android_Event_TalkStatusChange>;
+    clUIFuncs.onServerErrorEvent            = forwardEvent<Android_Event_ServerError>;
     clUIFuncs.onUserLoggingMessageEvent     = onUserLoggingMessageEvent;
+    clUIFuncs.onUpdateChannelEditedEvent    = onUpdateChannelEditedEvent;
+    clUIFuncs.onChannelMoveEvent            = onChannelMoveEvent;
+    clUIFuncs.onUpdateClientEvent           = onUpdateClientEvent;
+    return clUIFuncs;
+}
+
+#ifdef LOAD_GENERATOR
+/*
+ * Posts a synthetic event of the type of the callback straight to forwardEvent. The tracking handlers are
+ * skipped, fake IDs must neither reach gServerTrees and the clientlib queries nor mark the startup.
+ */
+template <auto& event, typename Callback>
+static void forwardSyntheticEvent(uint64_t connection, uint64_t sequence) {
+    const Callback forward = forwardEvent<event>;
+    invoke_synthetic(forward, connection, sequence);
+}
+
+static void raiseSyntheticEvent(EventType type, uint64_t connection, uint64_t sequence) {
+    using C = ClientUIFunctions;
+    switch (type) {
+        case EventType_ConnectStatusChange:    forwardSyntheticEvent<Android_Event_ConnectStatusChange, decltype(C::onConnectStatusChangeEvent)>(connection, sequence); break;
+        case EventType_NewChannel:             forwardSyntheticEvent<Android_Event_NewChannel, decltype(C::onNewChannelEvent)>(connection, sequence); break;
+        case EventType_NewChannelCreated:      forwardSyntheticEvent<Android_Event_NewChannelCreated, decltype(C::onNewChannelCreatedEvent)>(connection, sequence); break;
+        case EventType_DelChannel:             forwardSyntheticEvent<Android_Event_DelChannel, decltype(C::onDelChannelEvent)>(connection, sequence); break;
+        case EventType_ClientMove:             forwardSyntheticEvent<Android_Event_ClientMove, decltype(C::onClientMoveEvent)>(connection, sequence); break;
+        case EventType_ClientMoveSubscription: forwardSyntheticEvent<Android_Event_ClientMoveSubscription, decltype(C::onClientMoveSubscriptionEvent)>(connection, sequence); break;
+        case EventType_ClientMoveTimeout:      forwardSyntheticEvent<Android_Event_ClientMoveTimeout, decltype(C::onClientMoveTimeoutEvent)>(connection, sequence); break;
+        case EventType_ClientMoveMoved:        forwardSyntheticEvent<Android_Event_ClientMoveMoved, decltype(C::onClientMoveMovedEvent)>(connection, sequence); break;
+        case EventType_TalkStatusChange:       forwardSyntheticEvent<Android_Event_TalkStatusChange, decltype(C::onTalkStatusChangeEvent)>(connection, sequence); break;
+        case EventType_ServerError:            forwardSyntheticEvent<Android_Event_ServerError, decltype(C::onServerErrorEvent)>(connection, sequence); break;
+        case EventType_UserLoggingMessage:     forwardSyntheticEvent<Android_Event_UserLoggingMessage, decltype(C::onUserLoggingMessageEvent)>(connection, sequence); break;
+        default: break;
+    }
+}
+#endif
+
+/* Initialize client lib with callbacks */
+int init(const char* native_lib_path) {
+#ifdef DEBUG_BUILD
+    LOGD(__FUNCTION__);
+#endif
+    unsigned int error;
+
+    struct ClientUIFunctions clUIFuncs = clientCallbacks();
 
     /* Initialize client lib with callbacks */
     error = ts3client_initClientLib(&clUIFuncs, NULL, LogType_USERLOGGING, NULL, native_lib_path);
@@ -1037,34 +1956,95 @@ int init(const char* native_lib_path/*, const std::vector<std::string>& events_t
     return error;
 }
 
-void initClassHelper(JNIEnv *env, const char *path, jobject *objptr, jmethodID* fire_method_id = nullptr) {
-    jclass cls = env->FindClass(path);
-    if (!cls) {
-        LOGE("initClassHelper: failed to get %s class reference", path);
-        return;
-    }
-    jmethodID constr = env->GetMethodID(cls, "<init>", "()V");
-    if (!constr) {
-        LOGE("initClassHelper: failed to get %s constructor", path);
-        return;
-    }
-    jobject obj = env->NewObject(cls, constr);
-    if (!obj) {
-        LOGE("initClassHelper: failed to create a %s object", path);
-        return;
-    }
-    (*objptr) = env->NewGlobalRef(obj);
-
-    if (fire_method_id)
-    {
-        (*fire_method_id) = env->GetMethodID(cls, "Post", "()V");
-        if (!(*fire_method_id)) {
-            LOGE("initClassHelper: failed to get %s post method", path);
-        }
-    }
-}
-
-jint JNI_OnLoad(JavaVM* vm, void* reserved) {
+/*
+ * Every external of the Native class. Only JNI_OnLoad is exported from the library (see
+ * ts3client_wrapper.map), so a native missing here fails with UnsatisfiedLinkError on its first call.
+ */
+#define NATIVE_METHOD(name, signature) \
+        {"ts3client_" #name, signature, reinterpret_cast<void*>(Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1##name)}
+
+static const JNINativeMethod gNativeMethods[] = {
+        NATIVE_METHOD(startInit, "(Landroid/content/Context;)I"),
+        NATIVE_METHOD(destroyClientLib, "()I"),
+        NATIVE_METHOD(spawnNewServerConnectionHandler, "()J"),
+        NATIVE_METHOD(destroyServerConnectionHandler, "(J)I"),
+        NATIVE_METHOD(startConnection, "(JLjava/lang/String;Ljava/lang/String;ILjava/lang/String;[Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)I"),
+        NATIVE_METHOD(stopConnection, "(JLjava/lang/String;)I"),
+        NATIVE_METHOD(createIdentity, "()Ljava/lang/String;"),
+        NATIVE_METHOD(getClientLibVersion, "()Ljava/lang/String;"),
+        NATIVE_METHOD(registerCustomDevice, "(Ljava/lang/String;Ljava/lang/String;IILjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;)I"),
+        NATIVE_METHOD(registerCustomDeviceHandle, "(Ljava/lang/String;Ljava/lang/String;IILjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;)I"),
+        NATIVE_METHOD(unregisterCustomDevice, "(Ljava/lang/String;)I"),
+        NATIVE_METHOD(acquireCustomPlaybackData, "(Ljava/lang/String;I)I"),
+        NATIVE_METHOD(processCustomCaptureData, "(Ljava/lang/String;I)I"),
+        NATIVE_METHOD(acquireCustomPlaybackDataByHandle, "(II)I"),
+        NATIVE_METHOD(processCustomCaptureDataByHandle, "(II)I"),
+        NATIVE_METHOD(openCaptureDevice, "(JLjava/lang/String;Ljava/lang/String;)I"),
+        NATIVE_METHOD(openPlaybackDevice, "(JLjava/lang/String;Ljava/lang/String;)I"),
+        NATIVE_METHOD(closeCaptureDevice, "(J)I"),
+        NATIVE_METHOD(closePlaybackDevice, "(J)I"),
+        NATIVE_METHOD(activateCaptureDevice, "(J)I"),
+        NATIVE_METHOD(setClientSelfVariableAsInt, "(JII)I"),
+        NATIVE_METHOD(flushClientSelfUpdates, "(JLjava/lang/String;)I"),
+        NATIVE_METHOD(setPreProcessorConfigValue, "(JLjava/lang/String;Ljava/lang/String;)I"),
+        NATIVE_METHOD(getPreProcessorConfigValue, "(JLjava/lang/String;)Ljava/lang/String;"),
+        NATIVE_METHOD(getPlaybackConfigValueAsFloat, "(JLjava/lang/String;)F"),
+        NATIVE_METHOD(setPlaybackConfigValue, "(JLjava/lang/String;Ljava/lang/String;)I"),
+        NATIVE_METHOD(getClientVariableAsString, "(JII)Ljava/lang/String;"),
+        NATIVE_METHOD(getClientList, "(J)[I"),
+        NATIVE_METHOD(getClientVariablesAsInt, "(J[I[I)[I"),
+        NATIVE_METHOD(getClientVariablesAsString, "(J[I[I)[Ljava/lang/String;"),
+        NATIVE_METHOD(getServerTree, "(JJ)[B"),
+        NATIVE_METHOD(getChannelVariableAsString, "(JJI)Ljava/lang/String;"),
+        NATIVE_METHOD(getClientID, "(J)I"),
+        NATIVE_METHOD(getConnectionStatus, "(J)I"),
+        NATIVE_METHOD(getConnectionVariableAsDouble, "(JII)D"),
+        NATIVE_METHOD(getConnectionVariables, "(JILjava/nio/DoubleBuffer;)I"),
+        NATIVE_METHOD(startConnectionSampler, "(II)I"),
+        NATIVE_METHOD(stopConnectionSampler, "()I"),
+        NATIVE_METHOD(watchConnection, "(JI)I"),
+        NATIVE_METHOD(getConnectionHistory, "(JD)[D"),
+        NATIVE_METHOD(getConnectionPercentiles, "(JI[I)[D"),
+        NATIVE_METHOD(getThreadAttachCounters, "()[J"),
+        NATIVE_METHOD(getStartupTimes, "()[J"),
+        NATIVE_METHOD(configureEventQueue, "(II)I"),
+        NATIVE_METHOD(setEventDispatchThreads, "(I)I"),
+        NATIVE_METHOD(setEventMask, "(JI)I"),
+        NATIVE_METHOD(setEventBatchDelivery, "(Lcom/teamspeak/ts3sdkclient/ts3sdk/EventBatch;)I"),
+        NATIVE_METHOD(setEventCoalescingWindow, "(II)I"),
+        NATIVE_METHOD(getEventQueueCounters, "()[J"),
+        NATIVE_METHOD(getEventShardCounters, "(I)[J"),
+        NATIVE_METHOD(setEventStringCacheCapacity, "(I)I"),
+        NATIVE_METHOD(getEventStringCacheCounters, "()[J"),
+        NATIVE_METHOD(setLogLevel, "(I)I"),
+        NATIVE_METHOD(drainLog, "(I)[B"),
+        NATIVE_METHOD(openLogFile, "(Ljava/lang/String;I)I"),
+        NATIVE_METHOD(closeLogFile, "()I"),
+        NATIVE_METHOD(readLogFile, "(Ljava/lang/String;)[B"),
+        NATIVE_METHOD(getProfileReport, "(I)Ljava/lang/String;"),
+        NATIVE_METHOD(resetProfile, "()V"),
+#ifdef LOAD_GENERATOR
+        NATIVE_METHOD(startLoadGenerator, "(J[I[IIII)I"),
+        NATIVE_METHOD(stopLoadGenerator, "()I"),
+        NATIVE_METHOD(getLoadGeneratorCounters, "(I)[J"),
+#endif
+        NATIVE_METHOD(getEventLatencySnapshot, "(IZ)[J"),
+        NATIVE_METHOD(startAudioPump, "(IILjava/lang/String;Ljava/lang/String;I)I"),
+        NATIVE_METHOD(stopAudioPump, "(I)I"),
+        NATIVE_METHOD(setCustomDeviceBufferFormat, "(IIIII)I"),
+        NATIVE_METHOD(setCustomDeviceBufferRate, "(IIII)I"),
+        NATIVE_METHOD(writeCustomCaptureDataByHandle, "(II)I"),
+        NATIVE_METHOD(readCustomPlaybackDataByHandle, "(II)I"),
+        NATIVE_METHOD(getPlaybackBufferCounters, "(I)[J"),
+        NATIVE_METHOD(getCaptureRingCounters, "(I)[J"),
+        NATIVE_METHOD(getAudioLatencySnapshot, "(IZ)[J"),
+        NATIVE_METHOD(getAudioPumpCounters, "(I)[J")
+};
+
+#undef NATIVE_METHOD
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
+    markStartup(StartupMark_OnLoad);
 #if defined(__aarch64__)
     #define ABI "arm64-v8a"
 #elif defined(__arm__)
@@ -1112,19 +2092,31 @@ jint JNI_OnLoad(JavaVM* vm, void* reserved) {
     }
     env->GetJavaVM(&gJavaVM);
 
-    initClassHelper(env, "java/lang/String", &StringClass);
-    initClassHelper(env, "com/teamspeak/ts3sdkclient/ts3sdk/events/ConnectStatusChange", &Android_Event_ConnectStatusChange.first, &Android_Event_ConnectStatusChange.second);
-    initClassHelper(env, "com/teamspeak/ts3sdkclient/ts3sdk/events/NewChannel", &Android_Event_NewChannel.first, &Android_Event_NewChannel.second);
-    initClassHelper(env, "com/teamspeak/ts3sdkclient/ts3sdk/events/NewChannelCreated", &Android_Event_NewChannelCreated.first, &Android_Event_NewChannelCreated.second);
-    initClassHelper(env, "com/teamspeak/ts3sdkclient/ts3sdk/events/DelChannel", &Android_Event_DelChannel.first, &Android_Event_DelChannel.second);
-    initClassHelper(env, "com/teamspeak/ts3sdkclient/ts3sdk/events/ClientMove", &Android_Event_ClientMove.first, &Android_Event_ClientMove.second);
-    initClassHelper(env, "com/teamspeak/ts3sdkclient/ts3sdk/events/ClientMoveSubscription", &Android_Event_ClientMoveSubscription.first, &Android_Event_ClientMoveSubscription.second);
-    initClassHelper(env, "com/teamspeak/ts3sdkclient/ts3sdk/events/ClientMoveTimeout", &Android_Event_ClientMoveTimeout.first, &Android_Event_ClientMoveTimeout.second);
-    initClassHelper(env, "com/teamspeak/ts3sdkclient/ts3sdk/events/ClientMoveMoved",&Android_Event_ClientMoveMoved.first, &Android_Event_ClientMoveMoved.second);
-    initClassHelper(env, "com/teamspeak/ts3sdkclient/ts3sdk/events/TalkStatusChange", &Android_Event_TalkStatusChange.first, &Android_Event_TalkStatusChange.second);
-    initClassHelper(env, "com/teamspeak/ts3sdkclient/ts3sdk/events/ServerError", &Android_Event_ServerError.first, &Android_Event_ServerError.second);
-    initClassHelper(env, "com/teamspeak/ts3sdkclient/ts3sdk/events/UserLoggingMessage", &Android_Event_UserLoggingMessage.first, &Android_Event_UserLoggingMessage.second);
+    if (pthread_key_create(&gThreadDetachKey, detachThread) != 0) {
+        LOGE("Failed to create the thread detach key");
+        return -1;
+    }
+
+    jclass nativeClass = env->FindClass(NATIVE_CLASS);
+    if (!nativeClass) {
+        env->ExceptionClear();
+        LOGE("Failed to find " NATIVE_CLASS);
+        return -1;
+    }
+    const auto registered = env->RegisterNatives(nativeClass, gNativeMethods, static_cast<jint>(sizeof(gNativeMethods) / sizeof(gNativeMethods[0])));
+    if (registered != JNI_OK) {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+        env->DeleteLocalRef(nativeClass);
+        LOGE("Failed to register the natives of " NATIVE_CLASS);
+        return -1;
+    }
+    // The event classes are resolved through it on first use, see JniEventClass::resolve
+    if (!init_class_loader(env, nativeClass))
+        LOGE("Failed to get the class loader, events are only delivered in batches");
+    env->DeleteLocalRef(nativeClass);
 
+    markStartup(StartupMark_OnLoadDone);
     LOGD("JNI_OnLoad done.");
 
     return JNI_VERSION_1_6;
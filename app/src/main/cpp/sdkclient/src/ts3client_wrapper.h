@@ -3,6 +3,8 @@
  *
  * Copyright (c) 2007-2020 TeamSpeak-Systems
  *
+ * The functions below are not exported. JNI_OnLoad registers them with the Native class from its
+ * gNativeMethods table, a new one has to be added there as well.
  */
 #pragma once
 
@@ -21,7 +23,7 @@ void ts3client_android_initJni(void* java_vm, void* context);
  */
 JNIEXPORT jint
 JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startInit
-        (JNIEnv *, jobject, jobject/*, jobjectArray*/);
+        (JNIEnv *, jobject, jobject);
 
 /*
  * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
@@ -88,6 +90,14 @@ JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getClientLibVer
  */
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1registerCustomDevice(JNIEnv * env, jobject obj, jstring deviceID, jstring deviceDisplayName, jint capFrequency, jint capChannels, jobject capture_byte_buffer, jint playFrequency, jint playChannels, jobject playback_byte_buffer);
 
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_registerCustomDeviceHandle
+ * Signature: (Ljava/lang/String;Ljava/lang/String;IILjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;)I;
+ * Returns the device handle for the ByHandle functions, or the negated error code
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1registerCustomDeviceHandle(JNIEnv * env, jobject obj, jstring deviceID, jstring deviceDisplayName, jint capFrequency, jint capChannels, jobject capture_byte_buffer, jint playFrequency, jint playChannels, jobject playback_byte_buffer);
+
 /*
  * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
  * Method:    ts3client_unregisterCustomDevice
@@ -109,6 +119,22 @@ JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1
  */
 JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1processCustomCaptureData(JNIEnv *, jobject, jstring, jint);
 
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_acquireCustomPlaybackDataByHandle
+ * Signature: (II)I
+ * Static
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1acquireCustomPlaybackDataByHandle(JNIEnv *, jclass, jint, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_processCustomCaptureDataByHandle
+ * Signature: (II)I
+ * Static
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1processCustomCaptureDataByHandle(JNIEnv *, jclass, jint, jint);
+
 /*
  * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
  * Method:    ts3client_openCaptureDevice
@@ -206,6 +232,42 @@ JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setPlaybackConf
 JNIEXPORT jstring
 JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getClientVariableAsString(JNIEnv *env, jobject obj, jlong serverConnectionHandlerID, jint clientID, jint flag);
 
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getClientList
+ * Signature: (J)[I
+ * IDs of all visible clients
+ */
+JNIEXPORT jintArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getClientList
+        (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getClientVariablesAsInt
+ * Signature: (J[I[I)[I
+ * Integer properties of many clients, one row of { client ID, values } per client
+ */
+JNIEXPORT jintArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getClientVariablesAsInt
+        (JNIEnv *, jobject, jlong, jintArray, jintArray);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getClientVariablesAsString
+ * Signature: (J[I[I)[Ljava/lang/String;
+ * String properties of many clients, one row of { client ID, values } per client
+ */
+JNIEXPORT jobjectArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getClientVariablesAsString
+        (JNIEnv *, jobject, jlong, jintArray, jintArray);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getServerTree
+ * Signature: (JJ)[B
+ * Channel tree and clients changed since a generation, layout in server_tree.h
+ */
+JNIEXPORT jbyteArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getServerTree
+        (JNIEnv *, jobject, jlong, jlong);
+
 /*
  * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
  * Method:    ts3client_getChannelVariableAsString
@@ -240,6 +302,344 @@ JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getConnectionSt
 JNIEXPORT jdouble JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getConnectionVariableAsDouble
         (JNIEnv *, jobject, jlong, jint, jint);
 
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getConnectionVariables
+ * Signature: (JILjava/nio/DoubleBuffer;)I
+ * All connection variables of a client into a direct buffer, indexed by ConnectionProperties
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getConnectionVariables
+        (JNIEnv *, jobject, jlong, jint, jobject);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_startConnectionSampler
+ * Signature: (II)I
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startConnectionSampler
+        (JNIEnv *, jobject, jint, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_stopConnectionSampler
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1stopConnectionSampler
+        (JNIEnv *, jobject);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_watchConnection
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1watchConnection
+        (JNIEnv *, jobject, jlong, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getConnectionHistory
+ * Signature: (JD)[D
+ * Sampled rows of { time ms, variables }, see connection_sampler.h
+ */
+JNIEXPORT jdoubleArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getConnectionHistory
+        (JNIEnv *, jobject, jlong, jdouble);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getConnectionPercentiles
+ * Signature: (JI[I)[D
+ */
+JNIEXPORT jdoubleArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getConnectionPercentiles
+        (JNIEnv *, jobject, jlong, jint, jintArray);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getStartupTimes
+ * Signature: ()[J
+ * Static. CLOCK_MONOTONIC ns of { JNI_OnLoad entered, JNI_OnLoad done, first successful ts3client_startInit,
+ *         first ts3client_startConnection, first connection established }, 0 if not reached yet
+ */
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getStartupTimes
+        (JNIEnv *, jclass);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getThreadAttachCounters
+ * Signature: ()[J
+ * Returns { threads attached to the VM, threads detached on exit } since the library was loaded
+ */
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getThreadAttachCounters
+        (JNIEnv *, jobject);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_configureEventQueue
+ * Signature: (II)I
+ * Static. The capacity is applied by the next ts3client_startInit, the overflow policy immediately.
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1configureEventQueue
+        (JNIEnv *, jclass, jint, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_setEventDispatchThreads
+ * Signature: (I)I
+ * Static. Dispatcher threads the connections are spread over, applied by the next ts3client_startInit.
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setEventDispatchThreads
+        (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_setEventMask
+ * Signature: (JI)I
+ * Static. One bit per event type, masked events are dropped in the clientlib callback. Connection 0 sets the
+ * default mask, -1 for a connection removes its override.
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setEventMask
+        (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_setEventBatchDelivery
+ * Signature: (Lcom/teamspeak/ts3sdkclient/ts3sdk/EventBatch;)I
+ * Queued events are written into the buffer of the given EventBatch, null switches back to one object per event
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setEventBatchDelivery
+        (JNIEnv *, jobject, jobject);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_setEventCoalescingWindow
+ * Signature: (II)I
+ * Collapses events of the given type per server connection and client within windowMs, 0 disables it.
+ * Supported for TalkStatusChange and ClientMoveSubscription.
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setEventCoalescingWindow
+        (JNIEnv *, jobject, jint, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getEventQueueCounters
+ * Signature: ()[J
+ * Returns { depth, high water mark, dispatched, dropped, coalesced,
+ *           events held by the coalescing stage, events eliminated by the coalescing stage }
+ */
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getEventQueueCounters
+        (JNIEnv *, jobject);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getEventShardCounters
+ * Signature: (I)[J
+ * ts3client_getEventQueueCounters of one dispatcher thread
+ */
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getEventShardCounters
+        (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_setEventStringCacheCapacity
+ * Signature: (I)I
+ * Estimated bytes of interned event strings, 0 disables interning
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setEventStringCacheCapacity
+        (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getEventStringCacheCounters
+ * Signature: ()[J
+ * Returns { hits, misses, bypassed, evictions, entries, estimated bytes }
+ */
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getEventStringCacheCounters
+        (JNIEnv *, jobject);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_setLogLevel
+ * Signature: (I)I
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setLogLevel
+        (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_drainLog
+ * Signature: (I)[B
+ * Log records since the last drain, layout in native_log.h
+ */
+JNIEXPORT jbyteArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1drainLog
+        (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_openLogFile
+ * Signature: (Ljava/lang/String;I)I
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1openLogFile
+        (JNIEnv *, jobject, jstring, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_closeLogFile
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1closeLogFile
+        (JNIEnv *, jobject);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_readLogFile
+ * Signature: (Ljava/lang/String;)[B
+ * Log records in a ring file, layout in native_log.h
+ */
+JNIEXPORT jbyteArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1readLogFile
+        (JNIEnv *, jobject, jstring);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getProfileReport
+ * Signature: (I)Ljava/lang/String;
+ * Calls and timing of every entry point and event in one of Native.PROFILE_REPORT_*, needs a PROFILE_BUILD
+ */
+JNIEXPORT jstring JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getProfileReport
+        (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_resetProfile
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1resetProfile
+        (JNIEnv *, jobject);
+
+#ifdef LOAD_GENERATOR
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_startLoadGenerator
+ * Signature: (J[I[IIII)I
+ * Raises synthetic clientlib callbacks, one workload per event type and rate. Only in a LOAD_GENERATOR build.
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startLoadGenerator
+        (JNIEnv *, jobject, jlong, jintArray, jintArray, jint, jint, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_stopLoadGenerator
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1stopLoadGenerator
+        (JNIEnv *, jobject);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getLoadGeneratorCounters
+ * Signature: (I)[J
+ * Returns { generated, late, elapsed ns, then the callback duration histogram }
+ */
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getLoadGeneratorCounters
+        (JNIEnv *, jobject, jint);
+#endif
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getEventLatencySnapshot
+ * Signature: (IZ)[J
+ * Histogram of the time events of one type spend between the callback and their delivery
+ */
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getEventLatencySnapshot
+        (JNIEnv *, jobject, jint, jboolean);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_startAudioPump
+ * Signature: (IILjava/lang/String;Ljava/lang/String;I)I
+ * Pumps the custom device from a native thread until stopped or the device is unregistered
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1startAudioPump
+        (JNIEnv *, jobject, jint, jint, jstring, jstring, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_stopAudioPump
+ * Signature: (I)I
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1stopAudioPump
+        (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getAudioPumpCounters
+ * Signature: (I)[J
+ * periods, playback underruns, capture errors, late periods
+ */
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getAudioPumpCounters
+        (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_writeCustomCaptureDataByHandle
+ * Signature: (II)I
+ * Static
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1writeCustomCaptureDataByHandle
+        (JNIEnv *, jclass, jint, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getCaptureRingCounters
+ * Signature: (I)[J
+ * fill, capacity, high water (frames), overrun frames, underruns
+ */
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getCaptureRingCounters
+        (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_readCustomPlaybackDataByHandle
+ * Signature: (II)I
+ * Static
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1readCustomPlaybackDataByHandle
+        (JNIEnv *, jclass, jint, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getPlaybackBufferCounters
+ * Signature: (I)[J
+ * depth, target depth (frames), underruns, underrun histogram
+ */
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getPlaybackBufferCounters
+        (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_setCustomDeviceBufferFormat
+ * Signature: (IIIII)I
+ * Encoding and channel count of the registered direct buffers, converted to and from the device format
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setCustomDeviceBufferFormat
+        (JNIEnv *, jobject, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_setCustomDeviceBufferRate
+ * Signature: (IIII)I
+ * Sample rates of the registered direct buffers, resampled to and from the registered device rates
+ */
+JNIEXPORT jint JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1setCustomDeviceBufferRate
+        (JNIEnv *, jobject, jint, jint, jint, jint);
+
+/*
+ * Class:     Java_com_teamspeak_ts3sdkclient_ts3sdk_Native
+ * Method:    ts3client_getAudioLatencySnapshot
+ * Signature: (IZ)[J
+ * Latency histograms of a custom device, see Native.AUDIO_LATENCY_*
+ */
+JNIEXPORT jlongArray JNICALL Java_com_teamspeak_ts3sdkclient_ts3sdk_Native_ts3client_1getAudioLatencySnapshot
+        (JNIEnv *, jobject, jint, jboolean);
+
 #ifdef __cplusplus
 }
 #endif
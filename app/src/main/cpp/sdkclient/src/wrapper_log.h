@@ -0,0 +1,26 @@
+/*
+ * TeamSpeak 3 sdk client JNI wrapper
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Log macros of the wrapper. They go to logcat on Android and to stderr elsewhere, so the sources also
+ * compile for the host.
+ */
+#pragma once
+
+#if defined(__ANDROID__)
+#include <android/log.h>
+
+#define LOG_PRINT(priority, tag, ...) __android_log_print(ANDROID_LOG_##priority, tag, __VA_ARGS__)
+#else
+#include <cstdio>
+
+#define LOG_PRINT(priority, tag, ...) \
+    (std::fprintf(stderr, "%s/%s: ", #priority, tag), std::fprintf(stderr, __VA_ARGS__), std::fputc('\n', stderr))
+#endif
+
+#define LOGV(...) LOG_PRINT(VERBOSE, "TS3 LIB", __VA_ARGS__)
+#define LOGD(...) LOG_PRINT(DEBUG  , "TS3 LIB", __VA_ARGS__)
+#define LOGI(...) LOG_PRINT(INFO   , "TS3 LIB", __VA_ARGS__)
+#define LOGW(...) LOG_PRINT(WARN   , "TS3 LIB", __VA_ARGS__)
+#define LOGE(...) LOG_PRINT(ERROR  , "TS3 LIB", __VA_ARGS__)
@@ -1,5 +1,7 @@
 package com.teamspeak.ts3sdkclient.eventsystem;
 
+import com.teamspeak.ts3sdkclient.ts3sdk.EventBatch;
+
 import java.util.Vector;
 
 /**
@@ -17,6 +19,7 @@ import java.util.Vector;
 public class Callbacks {
     private static Callbacks instance;
     private static Vector<IEventListener> eventRegister = new Vector<IEventListener>();
+    private static Vector<IEventBatchListener> batchRegister = new Vector<IEventBatchListener>();
 
     private Callbacks(){
     }
@@ -27,7 +30,11 @@ public class Callbacks {
         return instance;
     }
 
-    public synchronized static void fireEvent(IEvent e){
+    /*
+     * Called from one native dispatcher thread per shard (see Native.ts3client_setEventDispatchThreads),
+     * so there is no global lock: each listener is locked on its own and never sees two events at once
+     */
+    public static void fireEvent(IEvent e){
         Vector<IEventListener> copy;
 
         synchronized (eventRegister) {
@@ -39,8 +46,42 @@ public class Callbacks {
         }
     }
 
-    private synchronized void execute(IEventListener x, IEvent e) {
-        x.onTS3Event(e);
+    /*
+     * Batch delivery: batch listeners get the batch as is, event objects are only decoded if a listener
+     * registered with registerCallbacks does not also listen to batches
+     */
+    public static void fireEventBatch(EventBatch batch){
+        Vector<IEventBatchListener> batchCopy;
+        Vector<IEventListener> copy;
+
+        synchronized (eventRegister) {
+            batchCopy = (Vector<IEventBatchListener>) batchRegister.clone();
+            copy = (Vector<IEventListener>) eventRegister.clone();
+        }
+        for (IEventBatchListener x : batchCopy) {
+            synchronized (x) {
+                x.onTS3EventBatch(batch);
+            }
+        }
+        for (IEventBatchListener x : batchCopy) {
+            copy.remove(x);
+        }
+        if (copy.isEmpty())
+            return;
+        for (EventBatch.Record record : batch) {
+            IEvent e = record.toEvent();
+            if (e == null)
+                continue;
+            for (IEventListener x : copy) {
+                instance.execute(x, e);
+            }
+        }
+    }
+
+    private void execute(IEventListener x, IEvent e) {
+        synchronized (x) {
+            x.onTS3Event(e);
+        }
     }
 
     public void registerCallbacks(IEventListener listener){
@@ -51,4 +92,13 @@ public class Callbacks {
     public void unregisterCallbacks(IEventListener listener){
         eventRegister.remove(listener);
     }
+
+    public void registerBatchCallbacks(IEventBatchListener listener){
+        if (!batchRegister.contains(listener))
+            batchRegister.add(listener);
+    }
+
+    public void unregisterBatchCallbacks(IEventBatchListener listener){
+        batchRegister.remove(listener);
+    }
 }
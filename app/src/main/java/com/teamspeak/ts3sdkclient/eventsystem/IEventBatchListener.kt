@@ -0,0 +1,15 @@
+package com.teamspeak.ts3sdkclient.eventsystem
+
+import com.teamspeak.ts3sdkclient.ts3sdk.EventBatch
+
+/**
+ * TeamSpeak SDK client sample
+ *
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Receives ts3clientlibrary events in batches when batch delivery is enabled, see Native.ts3client_setEventBatchDelivery
+ * The batch and its records are only valid for the duration of the call
+ */
+interface IEventBatchListener {
+    fun onTS3EventBatch(batch: EventBatch)
+}
@@ -0,0 +1,113 @@
+package com.teamspeak.ts3sdkclient.ts3sdk
+
+import com.teamspeak.ts3sdkclient.eventsystem.Callbacks
+import com.teamspeak.ts3sdkclient.eventsystem.TsEvent
+import com.teamspeak.ts3sdkclient.ts3sdk.events.*
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.charset.StandardCharsets
+
+/**
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Direct buffer shared with ts3client-wrapper-lib for batched event delivery.
+ * The native dispatcher thread writes the binary event records (layout documented in event_batch.h) into buffer
+ * and calls deliver once per batch. Records are decoded lazily, event objects are only created by Record.toEvent.
+ */
+class EventBatch(capacity: Int = DEFAULT_CAPACITY) : Iterable<EventBatch.Record> {
+
+    @JvmField
+    val buffer: ByteBuffer = ByteBuffer.allocateDirect(capacity).order(ByteOrder.nativeOrder())
+
+    /** Number of records in the current batch */
+    var count = 0
+        private set
+
+    /** Number of bytes used by the current batch */
+    var size = 0
+        private set
+
+    /** Called by the native dispatcher thread */
+    @Suppress("unused")
+    private fun deliver(size: Int, count: Int) {
+        this.size = size
+        this.count = count
+        Callbacks.fireEventBatch(this)
+    }
+
+    /** Iterates the records of the current batch. The returned Record is reused for every record. */
+    override fun iterator(): Iterator<Record> = object : Iterator<Record> {
+        private val record = Record()
+        private var next = 0
+
+        override fun hasNext() = next < size
+
+        override fun next(): Record {
+            record.offset = next
+            next += buffer.getInt(next)
+            return record
+        }
+    }
+
+    inner class Record internal constructor() {
+        internal var offset = 0
+
+        /** One of the TYPE_ constants */
+        val type: Int
+            get() = buffer.get(offset + 4).toInt()
+
+        val argumentCount: Int
+            get() = buffer.get(offset + 5).toInt()
+
+        fun getLong(index: Int): Long = buffer.getLong(offset + HEADER_SIZE + index * 8)
+
+        fun getInt(index: Int): Int = getLong(index).toInt()
+
+        fun getString(index: Int): String? {
+            val slot = getLong(index)
+            if (slot == -1L)
+                return null
+            val bytes = ByteArray((slot and 0xFFFFFFFFL).toInt())
+            val source = buffer.duplicate()
+            source.position(offset + (slot ushr 32).toInt())
+            source.get(bytes)
+            return String(bytes, StandardCharsets.UTF_8)
+        }
+
+        private fun getText(index: Int) = getString(index) ?: ""
+
+        /** Creates the event object the clientlib callback would have posted */
+        fun toEvent(): TsEvent? = when (type) {
+            TYPE_CONNECT_STATUS_CHANGE -> ConnectStatusChange(getLong(0), getInt(1), getInt(2))
+            TYPE_NEW_CHANNEL -> NewChannel(getLong(0), getLong(1), getLong(2))
+            TYPE_NEW_CHANNEL_CREATED -> NewChannelCreated(getLong(0), getLong(1), getLong(2), getInt(3), getText(4), getText(5))
+            TYPE_DEL_CHANNEL -> DelChannel(getLong(0), getLong(1), getInt(2), getText(3), getText(4))
+            TYPE_CLIENT_MOVE -> ClientMove(getLong(0), getInt(1), getLong(2), getLong(3), getInt(4), getText(5))
+            TYPE_CLIENT_MOVE_SUBSCRIPTION -> ClientMoveSubscription(getLong(0), getInt(1), getLong(2), getLong(3), getInt(4))
+            TYPE_CLIENT_MOVE_TIMEOUT -> ClientMoveTimeout(getLong(0), getInt(1), getLong(2), getLong(3), getInt(4), getText(5))
+            TYPE_CLIENT_MOVE_MOVED -> ClientMoveMoved(getLong(0), getInt(1), getLong(2), getLong(3), getInt(4), getInt(5), getText(6), getText(7), getText(8))
+            TYPE_TALK_STATUS_CHANGE -> TalkStatusChange(getLong(0), getInt(1), getInt(2), getInt(3))
+            TYPE_SERVER_ERROR -> ServerError(getLong(0), getText(1), getInt(2), getString(3), getString(4))
+            TYPE_USER_LOGGING_MESSAGE -> UserLoggingMessage(getText(0), getInt(1), getText(2), getLong(3), getText(4), getText(5))
+            else -> null
+        }
+    }
+
+    companion object {
+        const val DEFAULT_CAPACITY = 64 * 1024
+        private const val HEADER_SIZE = 8
+
+        // Must match enum EventType in jni_event.h
+        const val TYPE_CONNECT_STATUS_CHANGE = 0
+        const val TYPE_NEW_CHANNEL = 1
+        const val TYPE_NEW_CHANNEL_CREATED = 2
+        const val TYPE_DEL_CHANNEL = 3
+        const val TYPE_CLIENT_MOVE = 4
+        const val TYPE_CLIENT_MOVE_SUBSCRIPTION = 5
+        const val TYPE_CLIENT_MOVE_TIMEOUT = 6
+        const val TYPE_CLIENT_MOVE_MOVED = 7
+        const val TYPE_TALK_STATUS_CHANGE = 8
+        const val TYPE_SERVER_ERROR = 9
+        const val TYPE_USER_LOGGING_MESSAGE = 10
+    }
+}
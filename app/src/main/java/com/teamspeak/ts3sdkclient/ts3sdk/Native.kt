@@ -5,6 +5,8 @@ import android.os.Build
 import android.util.Log
 import android.content.Context
 import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.DoubleBuffer
 
 /**
  * Copyright (c) 2007-2018 TeamSpeak-Systems
@@ -62,6 +64,54 @@ class Native(applicationContext: Context) : com.teamspeak.soundbackend.ICustomSo
     external  fun ts3client_unregisterCustomDevice(deviceID: String): Int
     external  fun ts3client_acquireCustomPlaybackData(deviceID: String, samples: Int): Int
     external  fun ts3client_processCustomCaptureData(deviceID: String, samples: Int): Int
+
+    /**
+     * Same as ts3client_registerCustomDevice but returns a device handle for the ByHandle functions,
+     * or the negated error code.
+     */
+    external  fun ts3client_registerCustomDeviceHandle(deviceID: String, deviceDisplayName: String, capFrequency: Int, capChannels: Int, capByteBuffer: ByteBuffer, playFrequency: Int, playChannels: Int, playByteBuffer: ByteBuffer): Int
+
+    /**
+     * Sets how the direct buffers of a device registered with ts3client_registerCustomDeviceHandle are laid
+     * out, if not as 16 bit PCM at the device channel count. Encodings are AudioFormat.ENCODING_PCM_16BIT or
+     * ENCODING_PCM_FLOAT, channels 1 or 2. Samples are converted in native code, float capture is dithered.
+     * The sample counts passed to the per-frame functions must fit the buffers in this layout.
+     */
+    external  fun ts3client_setCustomDeviceBufferFormat(deviceHandle: Int, captureEncoding: Int, captureChannels: Int, playbackEncoding: Int, playbackChannels: Int): Int
+
+    /**
+     * Sets the sample rates the direct buffers of a handle registered device run at, if not the rates
+     * given at registration. Audio is resampled in native code with one of RESAMPLER_QUALITY_*. Sample
+     * counts passed to the per-frame functions are then in frames at these rates.
+     */
+    external  fun ts3client_setCustomDeviceBufferRate(deviceHandle: Int, captureFrequency: Int, playbackFrequency: Int, quality: Int): Int
+
+    /**
+     * Exchanges periodMs of audio per period between the custom device and a native backend
+     * (one of AUDIO_PUMP_BACKEND_*) on a native thread. The file backend reads capture data from
+     * capturePath (raw 16 bit PCM, looped) and appends playback to playbackPath, either may be null.
+     * With AUDIO_PUMP_BACKEND_JAVA capture data is passed in through ts3client_writeCustomCaptureDataByHandle
+     * and playback is read with ts3client_readCustomPlaybackDataByHandle.
+     * Do not call the acquire/process functions for the device while its pump runs.
+     */
+    external  fun ts3client_startAudioPump(deviceHandle: Int, backendType: Int, capturePath: String?, playbackPath: String?, periodMs: Int): Int
+    external  fun ts3client_stopAudioPump(deviceHandle: Int): Int
+    /** periods, playback underruns, capture errors, late periods; null for an invalid handle */
+    external  fun ts3client_getAudioPumpCounters(deviceHandle: Int): LongArray?
+    /**
+     * Latency histograms of the custom device in AUDIO_LATENCY_* order, AUDIO_LATENCY_SNAPSHOT_SIZE values
+     * each: count, sum, max, p50, p90, p99 in ns, then AUDIO_LATENCY_BUCKETS counts where bucket b holds
+     * durations of at least 2^(b-1) and below 2^b ns. reset starts a new measurement interval.
+     * null for an invalid handle
+     */
+    external  fun ts3client_getAudioLatencySnapshot(deviceHandle: Int, reset: Boolean): LongArray?
+    /** fill, capacity and high water in frames, overrun frames, underruns; null for an invalid handle */
+    external  fun ts3client_getCaptureRingCounters(deviceHandle: Int): LongArray?
+    /**
+     * depth and target depth in frames, underruns, then the underrun histogram by missing audio:
+     * < 1, 2, 5, 10, 20, 50, 100 ms and longer. null for an invalid handle
+     */
+    external  fun ts3client_getPlaybackBufferCounters(deviceHandle: Int): LongArray?
     //endregion
 
     external fun ts3client_openCaptureDevice(connectionID: Long, modeID: String, captureDevice: String): Int
@@ -86,6 +136,27 @@ class Native(applicationContext: Context) : com.teamspeak.soundbackend.ICustomSo
 
     external fun ts3client_getClientVariableAsString(connectionID: Long, clientID: Int, flag: Int): String
 
+    /** IDs of all clients visible on the connection, null on error */
+    external fun ts3client_getClientList(connectionID: Long): IntArray?
+    /**
+     * Integer ClientProperties of many clients in one call. clientIDs null means all visible clients.
+     * Returns one row of flags.size + 1 values per client: the client ID, then the values in flag order,
+     * CLIENT_VARIABLE_UNAVAILABLE where the clientlib has none. null on error or a client ID outside 0..65535
+     */
+    external fun ts3client_getClientVariablesAsInt(connectionID: Long, clientIDs: IntArray?, flags: IntArray): IntArray?
+    /**
+     * String ClientProperties of many clients in one call. clientIDs null means all visible clients.
+     * Returns one row of flags.size + 1 strings per client: the client ID in decimal, then the values in
+     * flag order, null where the clientlib has none. null on error or a client ID outside 0..65535
+     */
+    external fun ts3client_getClientVariablesAsString(connectionID: Long, clientIDs: IntArray?, flags: IntArray): Array<String?>?
+
+    /**
+     * Channels and clients of the connection changed after sinceGeneration, everything for 0. Decoded and
+     * applied by ServerTree.update. null if no channel or client has been seen on the connection yet.
+     */
+    external fun ts3client_getServerTree(connectionID: Long, sinceGeneration: Long): ByteArray?
+
     external fun ts3client_getChannelVariableAsString(connectionID: Long, channelID: Long, flag: Int): String
 
     enum class ConnectionProperties private constructor(val connectionProperties: Int) {
@@ -136,20 +207,265 @@ class Native(applicationContext: Context) : com.teamspeak.soundbackend.ICustomSo
     }
     external fun ts3client_getConnectionVariableAsDouble(connectionID: Long, clientID: Int, flag: Int): Double
 
+    /**
+     * Reads all connection variables of a client in one call into values, indexed by
+     * ConnectionProperties. values must be a direct buffer in native order with room for
+     * CONNECTION_ENDMARKER entries, see connectionVariablesBuffer. Variables the clientlib has none of
+     * are NaN, for other clients than ourself they need ts3client_requestConnectionInfo first.
+     * Returns how many were read, -1 if the buffer is unusable
+     */
+    external fun ts3client_getConnectionVariables(connectionID: Long, clientID: Int, values: DoubleBuffer): Int
+
+    fun connectionVariablesBuffer(): DoubleBuffer =
+        ByteBuffer.allocateDirect(ConnectionProperties.CONNECTION_ENDMARKER.connectionProperties * 8)
+            .order(ByteOrder.nativeOrder()).asDoubleBuffer()
+
+    /**
+     * Samples the connection variables of every watched connection each intervalMs (at least 10) on a
+     * native thread, keeping the last historySize samples per connection. Restarting drops the history.
+     * Connection info of other clients than ourself is requested again after every sample.
+     */
+    external fun ts3client_startConnectionSampler(intervalMs: Int, historySize: Int): Int
+    external fun ts3client_stopConnectionSampler(): Int
+
+    /** Samples clientID on the connection, a negative clientID stops sampling the connection */
+    external fun ts3client_watchConnection(connectionID: Long, clientID: Int): Int
+
+    /**
+     * Samples taken after sinceMs, rows of [monotonic time in ms, CONNECTION_ENDMARKER variables].
+     * Pass the time of the last row seen to get only new ones. null if the connection is not watched
+     */
+    external fun ts3client_getConnectionHistory(connectionID: Long, sinceMs: Double): DoubleArray?
+
+    /**
+     * Percentiles in permille (990 for p99) of one ConnectionProperties over the recorded samples,
+     * NaN without samples. null if the connection is not watched
+     */
+    external fun ts3client_getConnectionPercentiles(connectionID: Long, flag: Int, permilles: IntArray): DoubleArray?
+
+    /**
+     * Returns [threads attached to the VM, threads detached on exit] by the native event callbacks.
+     * Once all clientlib threads delivered an event both stay constant.
+     */
+    external fun ts3client_getThreadAttachCounters(): LongArray
+
+    /**
+     * Returns [depth, high water mark, dispatched, dropped, coalesced, held by coalescing, eliminated by coalescing]
+     * of the native event queue.
+     */
+    external fun ts3client_getEventQueueCounters(): LongArray
+    /** ts3client_getEventQueueCounters of one dispatcher thread, null past ts3client_setEventDispatchThreads */
+    external fun ts3client_getEventShardCounters(shard: Int): LongArray?
+
+    /**
+     * Strings of forwarded events up to 128 bytes (nicknames, unique identifiers, return codes) are
+     * shared Java Strings from a native table of at most bytes estimated size, evicting the least
+     * recently hit ones. 0 disables it. The default is 256 KiB.
+     */
+    external fun ts3client_setEventStringCacheCapacity(bytes: Int): Int
+
+    /**
+     * Returns [hits, misses, bypassed (too long or disabled), evictions, entries, estimated bytes] of
+     * the event string table.
+     */
+    external fun ts3client_getEventStringCacheCounters(): LongArray
+
+    /**
+     * Clientlib log lines above level (LogLevel_CRITICAL 0 to LogLevel_DEVEL 5) are dropped natively and
+     * no longer formatted by the clientlib. Everything is kept by default.
+     */
+    external fun ts3client_setLogLevel(level: Int): Int
+
+    /**
+     * Up to maxRecords log lines since the last drain from the native ring of the last 1024 lines,
+     * decode with NativeLog.decode. Lines overwritten before they were drained are counted as lost.
+     */
+    external fun ts3client_drainLog(maxRecords: Int): ByteArray?
+
+    /**
+     * Additionally keeps the last records (rounded up to a power of two, 256 bytes each) log lines in a
+     * memory mapped file at path, replacing its previous content. The lines are on disk even if the
+     * process crashes, read the file of the previous run with ts3client_readLogFile before opening it.
+     */
+    external fun ts3client_openLogFile(path: String, records: Int): Int
+    external fun ts3client_closeLogFile(): Int
+
+    /** The log lines in a file written by ts3client_openLogFile, null if it is not one */
+    external fun ts3client_readLogFile(path: String): ByteArray?
+
+    /**
+     * Calls, total, mean, p50, p99 and max time of every JNI entry point and clientlib event, summed
+     * over all threads since the last ts3client_resetProfile. PROFILE_REPORT_TABLE is for reading,
+     * PROFILE_REPORT_CSV has ns values and the log2 histogram for tracking across releases. The native
+     * library must be built with -DPROFILE_BUILD=ON, otherwise the table only says so and the csv is empty.
+     * null for an unknown format
+     */
+    external fun ts3client_getProfileReport(format: Int): String?
+    external fun ts3client_resetProfile()
+
+    /**
+     * Stress test without a server: raises synthetic clientlib callbacks for the EventBatch.TYPE_* in
+     * eventTypes at the matching eventsPerSecond, each from threadsPerType threads of their own
+     * (at most 16), for durationMs or until ts3client_stopLoadGenerator if 0. The events take turns over
+     * connections (1 to 16) consecutive server connection handler IDs from serverConnectionHandlerID
+     * on, so scaling across dispatcher threads can be measured without servers. The events travel the
+     * same path as real ones: event mask, queue, coalescing, listeners. They leave the server tree,
+     * the native log and the startup times untouched. Integer arguments are synthetic,
+     * strings are a fixed text. For audio load run a pump with AUDIO_PUMP_BACKEND_NULL alongside.
+     * Only registered if the native library is built with -DLOAD_GENERATOR=ON, otherwise this and
+     * the two functions below throw UnsatisfiedLinkError.
+     */
+    external fun ts3client_startLoadGenerator(serverConnectionHandlerID: Long, eventTypes: IntArray, eventsPerSecond: IntArray, threadsPerType: Int, connections: Int, durationMs: Int): Int
+    external fun ts3client_stopLoadGenerator(): Int
+    /**
+     * generated events, late events (the rate could not be kept), elapsed ns of the run, then the
+     * duration of the callbacks as AUDIO_LATENCY_SNAPSHOT_SIZE histogram values. null for an unknown type
+     */
+    external fun ts3client_getLoadGeneratorCounters(eventType: Int): LongArray?
+    /**
+     * Histogram of the time events of an EventBatch.TYPE_* spent from the clientlib callback to their
+     * delivery to the listeners or the batch, laid out like one AUDIO_LATENCY_SNAPSHOT_SIZE entry of
+     * ts3client_getAudioLatencySnapshot. Only events that went through the queue are counted.
+     * null for an unknown type
+     */
+    external fun ts3client_getEventLatencySnapshot(eventType: Int, reset: Boolean): LongArray?
+
+    /**
+     * Delivers queued events in batches through the buffer of batch to listeners registered with
+     * Callbacks.registerBatchCallbacks. Other listeners still receive event objects, decoded on demand.
+     * Pass null to return to one native call per event.
+     */
+    external fun ts3client_setEventBatchDelivery(batch: EventBatch?): Int
+
+    /**
+     * Collapses redundant events of eventType (EventBatch.TYPE_TALK_STATUS_CHANGE or
+     * EventBatch.TYPE_CLIENT_MOVE_SUBSCRIPTION) per connection and client within windowMs before they
+     * reach Java. 0 disables coalescing for that type.
+     */
+    external fun ts3client_setEventCoalescingWindow(eventType: Int, windowMs: Int): Int
+
     companion object {
 
         private val TAG = Native::class.java.simpleName
 
+        /** System.nanoTime when loadLibrary started, 0 before */
+        var loadLibraryStartNs = 0L
+            private set
+
         /**
          * The native libraries needed to be loaded before they can be used
          */
         fun loadLibrary() {
+            loadLibraryStartNs = System.nanoTime()
             if (Build.VERSION.SDK_INT <= Build.VERSION_CODES.JELLY_BEAN_MR1) {
                 System.loadLibrary("c++_shared");
             }
             System.loadLibrary("ts3client")
             System.loadLibrary("ts3client-wrapper-lib")
         }
+
+        const val STARTUP_ON_LOAD = 0
+        const val STARTUP_ON_LOAD_DONE = 1
+        const val STARTUP_INIT_DONE = 2
+        const val STARTUP_CONNECT = 3
+        const val STARTUP_CONNECTED = 4
+
+        /**
+         * System.nanoTime of the STARTUP_* milestones: JNI_OnLoad entered and done, first successful
+         * ts3client_startInit, first ts3client_startConnection, first connection established. 0 if not reached.
+         */
+        @JvmStatic
+        external fun ts3client_getStartupTimes(): LongArray
+
+        /** ns from loadLibrary to each STARTUP_* milestone, -1 if not reached yet */
+        fun startupTimings(): LongArray =
+            ts3client_getStartupTimes().map { if (it == 0L) -1L else it - loadLibraryStartNs }.toLongArray()
+
+        const val RESAMPLER_QUALITY_FAST = 0
+        const val RESAMPLER_QUALITY_MEDIUM = 1
+        const val RESAMPLER_QUALITY_HIGH = 2
+
+        /** Per-frame capture call from Java, interval between those calls, wait in the capture ring, clientlib call */
+        const val AUDIO_LATENCY_CAPTURE_CALL = 0
+        const val AUDIO_LATENCY_CAPTURE_INTERVAL = 1
+        const val AUDIO_LATENCY_CAPTURE_QUEUEING = 2
+        const val AUDIO_LATENCY_CAPTURE_CLIENTLIB = 3
+        const val AUDIO_LATENCY_PLAYBACK_CALL = 4
+        const val AUDIO_LATENCY_PLAYBACK_INTERVAL = 5
+        const val AUDIO_LATENCY_PLAYBACK_QUEUEING = 6
+        const val AUDIO_LATENCY_PLAYBACK_CLIENTLIB = 7
+        const val AUDIO_LATENCY_BUCKETS = 32
+        const val AUDIO_LATENCY_SNAPSHOT_SIZE = 6 + AUDIO_LATENCY_BUCKETS
+
+        const val AUDIO_PUMP_BACKEND_NULL = 0
+        const val AUDIO_PUMP_BACKEND_FILE = 1
+        const val AUDIO_PUMP_BACKEND_JAVA = 2
+
+        /** Value of ts3client_getClientVariablesAsInt where a client has no such property */
+        const val CLIENT_VARIABLE_UNAVAILABLE = Int.MIN_VALUE
+
+        const val PROFILE_REPORT_TABLE = 0
+        const val PROFILE_REPORT_CSV = 1
+
+        const val EVENT_QUEUE_OVERFLOW_BLOCK = 0
+        const val EVENT_QUEUE_OVERFLOW_DROP_OLDEST = 1
+        /** Keeps the latest overflowing event per type, connection and client, up to 32 of them, then drops the oldest */
+        const val EVENT_QUEUE_OVERFLOW_COALESCE = 2
+
+        /**
+         * Events are delivered to the listeners from a native dispatcher thread through a queue of
+         * capacity entries. The capacity is used by the next Native instance, the overflow policy
+         * (one of EVENT_QUEUE_OVERFLOW_*) applies immediately.
+         */
+        @JvmStatic
+        external fun ts3client_configureEventQueue(capacity: Int, overflowPolicy: Int): Int
+
+        /**
+         * Spreads the connections over threads (1 to 8) dispatcher threads, each with a queue of the
+         * configured capacity. Events of one connection keep their order, listeners are never called
+         * concurrently but may be called from different threads. Used by the next Native instance.
+         */
+        @JvmStatic
+        external fun ts3client_setEventDispatchThreads(threads: Int): Int
+
+        const val EVENT_MASK_ALL = (1 shl (EventBatch.TYPE_USER_LOGGING_MESSAGE + 1)) - 1
+        const val EVENT_MASK_INHERIT = -1
+
+        /** Mask bit of an EventBatch.TYPE_ constant */
+        fun eventMaskOf(vararg eventTypes: Int): Int = eventTypes.fold(0) { mask, type -> mask or (1 shl type) }
+
+        /**
+         * Selects the events forwarded to Java, see eventMaskOf. Masked events are dropped in native code
+         * before any JNI work. connectionID 0 sets the default for all connections, EVENT_MASK_INHERIT removes
+         * the override of a connection. Takes effect immediately.
+         */
+        @JvmStatic
+        external fun ts3client_setEventMask(connectionID: Long, mask: Int): Int
+
+        /**
+         * Per-frame custom device calls on a handle from ts3client_registerCustomDeviceHandle, without
+         * string conversion. samples must fit the buffers passed at registration.
+         */
+        @JvmStatic
+        external fun ts3client_acquireCustomPlaybackDataByHandle(deviceHandle: Int, samples: Int): Int
+        @JvmStatic
+        external fun ts3client_processCustomCaptureDataByHandle(deviceHandle: Int, samples: Int): Int
+
+        /**
+         * Queues samples frames from the capture buffer for an AUDIO_PUMP_BACKEND_JAVA pump. Any chunk size
+         * is fine, the pump hands the frames to the clientlib at its own period. Returns the frames
+         * accepted, fewer than samples if the ring is full, or the negated error code.
+         */
+        @JvmStatic
+        external fun ts3client_writeCustomCaptureDataByHandle(deviceHandle: Int, samples: Int): Int
+
+        /**
+         * Fills samples frames of the playback buffer for an AUDIO_PUMP_BACKEND_JAVA pump, which prefetches
+         * from the clientlib up to an adaptive depth. Frames the buffer could not provide are silence.
+         * Returns the frames that were buffered or the negated error code.
+         */
+        @JvmStatic
+        external fun ts3client_readCustomPlaybackDataByHandle(deviceHandle: Int, samples: Int): Int
     }
 
     override fun unregisterCustomDevice(deviceID: String): Int {
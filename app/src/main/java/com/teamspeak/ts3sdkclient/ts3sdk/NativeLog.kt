@@ -0,0 +1,42 @@
+package com.teamspeak.ts3sdkclient.ts3sdk
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.charset.StandardCharsets
+
+/**
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Clientlib log records as returned by ts3client_drainLog and ts3client_readLogFile (layout documented
+ * in native_log.h). Draining every few seconds replaces the UserLoggingMessage event per line, which can
+ * then be switched off with ts3client_setEventMask.
+ */
+class NativeLog(val records: List<Record>, val lost: Long) {
+
+    class Record(val sequence: Long, val timeNs: Long, val logID: Long, val level: Int, val channel: String, val message: String)
+
+    companion object {
+        fun decode(data: ByteArray): NativeLog {
+            val buffer = ByteBuffer.wrap(data).order(ByteOrder.nativeOrder())
+            val count = buffer.int
+            buffer.int
+            val lost = buffer.long
+            val records = List(count) {
+                val sequence = buffer.long
+                val timeNs = buffer.long
+                val logID = buffer.long
+                val level = buffer.int
+                val channelLength = buffer.short.toInt() and 0xFFFF
+                val messageLength = buffer.short.toInt() and 0xFFFF
+                Record(sequence, timeNs, logID, level, buffer.text(channelLength), buffer.text(messageLength))
+            }
+            return NativeLog(records, lost)
+        }
+
+        private fun ByteBuffer.text(length: Int): String {
+            val bytes = ByteArray(length)
+            get(bytes)
+            return String(bytes, StandardCharsets.UTF_8)
+        }
+    }
+}
@@ -0,0 +1,81 @@
+package com.teamspeak.ts3sdkclient.ts3sdk
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.charset.StandardCharsets
+
+/**
+ * Copyright (c) 2007-2020 TeamSpeak-Systems
+ *
+ * Java copy of the channel tree and client placement ts3client-wrapper-lib keeps for one server connection.
+ * update fetches only what changed since the last update (layout documented in server_tree.h), so the
+ * structure does not have to be requeried from the clientlib after every channel or move event.
+ */
+class ServerTree(val connectionID: Long) {
+
+    class Channel(val id: Long, var parentID: Long, var name: String)
+
+    class Client(val id: Int, var channelID: Long, var nickname: String)
+
+    val channels = HashMap<Long, Channel>()
+    val clients = HashMap<Int, Client>()
+
+    /** Generation of the newest change applied, 0 before the first update */
+    var generation = 0L
+        private set
+
+    /** Fetches and applies the changes since the last update. Returns false if nothing changed. */
+    fun update(native: Native): Boolean {
+        val data = native.ts3client_getServerTree(connectionID, generation) ?: return false
+        return apply(data)
+    }
+
+    fun apply(data: ByteArray): Boolean {
+        val buffer = ByteBuffer.wrap(data).order(ByteOrder.nativeOrder())
+        val newGeneration = buffer.long
+        val flags = buffer.int
+        val channelCount = buffer.int
+        val clientCount = buffer.int
+        val removedChannelCount = buffer.int
+        val removedClientCount = buffer.int
+
+        // Removals come last in the data but apply first, an entry removed and added again is in both
+        val changed = Array(channelCount) { Channel(buffer.long, buffer.long, buffer.text()) }
+        val moved = Array(clientCount) {
+            val id = buffer.short.toInt() and 0xFFFF
+            buffer.short
+            Client(id, buffer.long, buffer.text())
+        }
+        if (flags and FLAG_FULL != 0) {
+            channels.clear()
+            clients.clear()
+        }
+        repeat(removedChannelCount) { channels.remove(buffer.long) }
+        repeat(removedClientCount) { clients.remove(buffer.short.toInt() and 0xFFFF) }
+        for (channel in changed)
+            channels[channel.id] = channel
+        for (client in moved)
+            clients[client.id] = client
+
+        val updated = newGeneration != generation
+        generation = newGeneration
+        return updated
+    }
+
+    /** Clients in the channel */
+    fun clientsIn(channelID: Long): List<Client> = clients.values.filter { it.channelID == channelID }
+
+    /** Direct subchannels, 0 for the top level */
+    fun subchannels(parentID: Long): List<Channel> = channels.values.filter { it.parentID == parentID }
+
+    private fun ByteBuffer.text(): String {
+        val bytes = ByteArray(int)
+        get(bytes)
+        return String(bytes, StandardCharsets.UTF_8)
+    }
+
+    companion object {
+        // Must match ServerTree::flag_full in server_tree.h
+        const val FLAG_FULL = 1
+    }
+}